@@ -0,0 +1,102 @@
+#include <furi.h>
+#include <storage/storage.h>
+#include <toolbox/stream/file_stream.h>
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC   0x504B464D // "MFKP"
+#define CHECKPOINT_VERSION 3
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t key_count;
+    uint32_t log_hash;
+    uint32_t log_index;
+    uint32_t msb_done;
+    int32_t num_candidates;
+    int32_t nonce_candidates;
+    uint8_t standalone;
+    uint8_t attack;
+    uint8_t reserved[2];
+} CheckpointHeader;
+
+bool checkpoint_save(const Checkpoint* checkpoint, const char* path) {
+    CheckpointHeader header = {
+        .magic = CHECKPOINT_MAGIC,
+        .version = CHECKPOINT_VERSION,
+        .key_count = checkpoint->key_count,
+        .log_hash = checkpoint->log_hash,
+        .log_index = checkpoint->log_index,
+        .msb_done = checkpoint->msb_done,
+        .num_candidates = checkpoint->num_candidates,
+        .nonce_candidates = checkpoint->nonce_candidates,
+        .standalone = checkpoint->standalone,
+        .attack = checkpoint->attack,
+    };
+    size_t keys_size = sizeof(MfClassicKey) * checkpoint->key_count;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* stream = file_stream_alloc(storage);
+    bool saved = false;
+    if(file_stream_open(stream, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        saved = (stream_write(stream, (uint8_t*)&header, sizeof(header)) == sizeof(header)) &&
+                (stream_write(stream, (uint8_t*)checkpoint->keys, keys_size) == keys_size);
+    }
+    file_stream_close(stream);
+    stream_free(stream);
+    furi_record_close(RECORD_STORAGE);
+    return saved;
+}
+
+bool checkpoint_load(
+    Checkpoint* checkpoint,
+    uint32_t log_hash,
+    MfClassicKey** keys,
+    size_t* key_count,
+    const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* stream = file_stream_alloc(storage);
+    bool loaded = false;
+    *keys = NULL;
+    *key_count = 0;
+
+    do {
+        if(!file_stream_open(stream, path, FSAM_READ, FSOM_OPEN_EXISTING)) break;
+        CheckpointHeader header;
+        if(stream_read(stream, (uint8_t*)&header, sizeof(header)) != sizeof(header)) break;
+        if((header.magic != CHECKPOINT_MAGIC) || (header.version != CHECKPOINT_VERSION) ||
+           (header.log_hash != log_hash) || (header.msb_done > 256)) {
+            break;
+        }
+        if(header.key_count > 0) {
+            size_t keys_size = sizeof(MfClassicKey) * header.key_count;
+            *keys = malloc(keys_size);
+            if(stream_read(stream, (uint8_t*)*keys, keys_size) != keys_size) {
+                // Cut short while it was written
+                free(*keys);
+                *keys = NULL;
+                break;
+            }
+            *key_count = header.key_count;
+        }
+        checkpoint->log_hash = header.log_hash;
+        checkpoint->attack = header.attack;
+        checkpoint->log_index = header.log_index;
+        checkpoint->msb_done = header.msb_done;
+        checkpoint->num_candidates = header.num_candidates;
+        checkpoint->nonce_candidates = header.nonce_candidates;
+        checkpoint->standalone = header.standalone;
+        loaded = true;
+    } while(false);
+
+    file_stream_close(stream);
+    stream_free(stream);
+    furi_record_close(RECORD_STORAGE);
+    return loaded;
+}
+
+void checkpoint_remove(const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_remove(storage, path);
+    furi_record_close(RECORD_STORAGE);
+}
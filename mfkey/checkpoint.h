@@ -0,0 +1,16 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "mfkey.h"
+
+bool checkpoint_save(const Checkpoint* checkpoint, const char* path);
+// Only succeeds for a checkpoint of the same nonce logs, the keys are allocated for the caller
+bool checkpoint_load(
+    Checkpoint* checkpoint,
+    uint32_t log_hash,
+    MfClassicKey** keys,
+    size_t* key_count,
+    const char* path);
+void checkpoint_remove(const char* path);
+
+#endif // CHECKPOINT_H
@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include "mfkey.h"
 #include <nfc/helpers/nfc_util.h>
+#include <bit_lib/bit_lib.h>
 #include <nfc/protocols/mf_classic/mf_classic.h>
 
 #define LF_POLY_ODD  (0x29CE5C)
@@ -13,6 +14,22 @@
 #define SWAPENDIAN(x) \
     ((x) = ((x) >> 8 & 0xff00ff) | ((x) & 0xff00ff) << 8, (x) = (x) >> 16 | (x) << 16)
 
+// Bitsliced Crypto1: bit j of every plane belongs to lane j, so each bitwise
+// operation steps 32 states at once. The 48 bit LFSR is kept in interleaved
+// order (odd bit i in plane 2i, even bit i in plane 2i + 1) inside a window
+// that slides by one plane per clocked bit, 32 rollbacks followed by at most
+// 32 forward clocks fit in the buffer.
+#define CRYPTO1_BS_LANES  32
+#define CRYPTO1_BS_PLANES (48 + 32)
+
+struct Crypto1BsState {
+    uint32_t odd[CRYPTO1_BS_LANES]; // Lane states, filled by the caller
+    uint32_t even[CRYPTO1_BS_LANES];
+    uint32_t planes[CRYPTO1_BS_PLANES];
+    uint32_t scratch[CRYPTO1_BS_LANES];
+    int base; // planes[base] is LFSR bit 0
+};
+
 static inline uint32_t prng_successor(uint32_t x, uint32_t n);
 static inline int filter(uint32_t const x);
 static inline uint8_t evenparity32(uint32_t x);
@@ -27,9 +44,23 @@ static uint32_t crypt_word_par(
     int is_encrypted,
     uint32_t nt_plain,
     uint8_t* parity_keystream_bits);
+static inline uint8_t crypt_reader_par(struct Crypto1State* s, uint32_t nr_enc, uint32_t ar_plain);
 static inline void rollback_word_noret(struct Crypto1State* s, uint32_t in, int x);
 static inline uint8_t napi_lfsr_rollback_bit(struct Crypto1State* s, uint32_t in, int fb);
 static inline uint32_t napi_lfsr_rollback_word(struct Crypto1State* s, uint32_t in, int fb);
+static inline bool key_matches_nonce(const MfClassicKey* key, const MfClassicNonce* nonce);
+static inline void crypto1_bs_load(struct Crypto1BsState* bs, int count);
+static inline uint32_t crypto1_bs_rollback_word_match(
+    struct Crypto1BsState* bs,
+    uint32_t in,
+    uint32_t ks,
+    uint32_t lanes);
+static inline void crypto1_bs_rollback_word(struct Crypto1BsState* bs, uint32_t in);
+static inline uint32_t crypto1_bs_crypt_word_match(
+    struct Crypto1BsState* bs,
+    uint32_t in,
+    uint32_t ks,
+    uint32_t lanes);
 
 static const uint8_t lookup1[256] = {
     0, 0,  16, 16, 0,  16, 0,  0,  0, 16, 0,  0,  16, 16, 16, 16, 0, 0,  16, 16, 0,  16, 0,  0,
@@ -180,6 +211,30 @@ static inline uint32_t crypt_word_par(
     return ret;
 }
 
+// Encrypted parity bits of a reader {nr}{ar} answer as sent on air, s is the state before nr.
+// The nr bytes end up in bits 7-4 and the ar bytes in bits 3-0, first byte first.
+static inline uint8_t
+    crypt_reader_par(struct Crypto1State* s, uint32_t nr_enc, uint32_t ar_plain) {
+    uint8_t par = 0;
+    uint32_t nr_plain = 0;
+    for(int i = 0; i < 32; i++) {
+        uint8_t bit = BEBIT(nr_enc, i);
+        nr_plain |= (uint32_t)(bit ^ crypt_bit(s, bit, 1)) << (24 ^ i);
+        if((i + 1) % 8 == 0) {
+            par = par << 1 |
+                  (filter(s->odd) ^ nfc_util_odd_parity8(get_nth_byte(nr_plain, i / 8)));
+        }
+    }
+    for(int i = 0; i < 32; i++) {
+        crypt_bit(s, 0, 0);
+        if((i + 1) % 8 == 0) {
+            par = par << 1 |
+                  (filter(s->odd) ^ nfc_util_odd_parity8(get_nth_byte(ar_plain, i / 8)));
+        }
+    }
+    return par;
+}
+
 static inline void rollback_word_noret(struct Crypto1State* s, uint32_t in, int x) {
     uint8_t ret;
     uint32_t feedin, t, next_in;
@@ -246,6 +301,127 @@ uint32_t napi_lfsr_rollback_word(struct Crypto1State* s, uint32_t in, int fb) {
     return ret;
 }
 
+// Hacker's Delight transpose, row k holds lane 31 - k on input
+static inline void crypto1_bs_transpose32(uint32_t a[32]) {
+    uint32_t m = 0x0000FFFF;
+    for(int j = 16; j != 0; j >>= 1, m ^= (m << j)) {
+        for(int k = 0; k < 32; k = ((k | j) + 1) & ~j) {
+            uint32_t t = (a[k] ^ (a[k | j] >> j)) & m;
+            a[k] ^= t;
+            a[k | j] ^= (t << j);
+        }
+    }
+}
+
+static inline void crypto1_bs_load(struct Crypto1BsState* bs, int count) {
+    int i;
+    memset(bs->scratch, 0, sizeof(bs->scratch));
+    for(i = 0; i < count; i++) {
+        bs->scratch[31 - i] = bs->odd[i];
+    }
+    crypto1_bs_transpose32(bs->scratch);
+    for(i = 0; i < 24; i++) {
+        bs->planes[2 * i] = bs->scratch[31 - i];
+    }
+    memset(bs->scratch, 0, sizeof(bs->scratch));
+    for(i = 0; i < count; i++) {
+        bs->scratch[31 - i] = bs->even[i];
+    }
+    crypto1_bs_transpose32(bs->scratch);
+    for(i = 0; i < 24; i++) {
+        bs->planes[2 * i + 1] = bs->scratch[31 - i];
+    }
+    bs->base = 0;
+}
+
+// Gate forms of the nibble tables used by filter(): 0xf22c and 0xd938
+static inline uint32_t crypto1_bs_filter_a(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    return c ^ ((b | (a ^ c)) & (d ^ (b | c)));
+}
+
+static inline uint32_t crypto1_bs_filter_b(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    return a ^ (b ^ ((a ^ (c ^ d)) | (c ^ (a | b))));
+}
+
+static inline uint32_t crypto1_bs_filter(const uint32_t* x) {
+    uint32_t f0 = crypto1_bs_filter_a(x[0], x[2], x[4], x[6]);
+    uint32_t f1 = crypto1_bs_filter_b(x[8], x[10], x[12], x[14]);
+    uint32_t f2 = crypto1_bs_filter_a(x[16], x[18], x[20], x[22]);
+    uint32_t f3 = crypto1_bs_filter_a(x[24], x[26], x[28], x[30]);
+    uint32_t f4 = crypto1_bs_filter_b(x[32], x[34], x[36], x[38]);
+    // 0xEC57E80A split on f1
+    uint32_t without_f1 = (f4 | f0) ^ (f4 & (f2 | (f3 & f0)));
+    uint32_t f1_delta = f4 ^ ((f3 ^ f0) & (f4 ^ (f2 | f0)));
+    return without_f1 ^ (f1 & f1_delta);
+}
+
+// Taps of LF_POLY_ODD (planes 2i) and LF_POLY_EVEN (planes 2i + 1)
+static inline uint32_t crypto1_bs_feedback(const uint32_t* x) {
+    return x[4] ^ x[6] ^ x[8] ^ x[12] ^ x[18] ^ x[20] ^ x[22] ^ x[28] ^ x[30] ^ x[32] ^ x[38] ^
+           x[42] ^ x[5] ^ x[23] ^ x[33] ^ x[35] ^ x[37] ^ x[47];
+}
+
+static inline uint32_t crypto1_bs_rollback_bit(struct Crypto1BsState* bs, uint32_t in) {
+    uint32_t out = bs->planes[bs->base] ^ in;
+    uint32_t* x = &bs->planes[++bs->base];
+    x[47] = 0;
+    x[47] = out ^ crypto1_bs_feedback(x);
+    return crypto1_bs_filter(x);
+}
+
+// napi_lfsr_rollback_word(s, in, 0) on every lane, returns the lanes whose
+// keystream equals ks. Stops as soon as no lane is left.
+static inline uint32_t crypto1_bs_rollback_word_match(
+    struct Crypto1BsState* bs,
+    uint32_t in,
+    uint32_t ks,
+    uint32_t lanes) {
+    for(int i = 31; (i >= 0) && lanes; i--) {
+        uint32_t ret = crypto1_bs_rollback_bit(bs, 0 - BEBIT(in, i));
+        lanes &= ~(ret ^ (0 - BIT(ks, i ^ 24)));
+    }
+    return lanes;
+}
+
+// rollback_word_noret(s, in, 0) on every lane
+static inline void crypto1_bs_rollback_word(struct Crypto1BsState* bs, uint32_t in) {
+    for(int i = 31; i >= 0; i--) {
+        crypto1_bs_rollback_bit(bs, 0 - BEBIT(in, i));
+    }
+}
+
+// crypt_word_ret(s, in, 0) on every lane, returns the lanes whose keystream
+// equals ks. Needs a preceding rollback to have room in the plane window.
+static inline uint32_t crypto1_bs_crypt_word_match(
+    struct Crypto1BsState* bs,
+    uint32_t in,
+    uint32_t ks,
+    uint32_t lanes) {
+    for(int i = 0; (i <= 31) && lanes; i++) {
+        uint32_t* x = &bs->planes[bs->base];
+        lanes &= ~(crypto1_bs_filter(x) ^ (0 - BIT(ks, i ^ 24)));
+        bs->planes[--bs->base] = crypto1_bs_feedback(x) ^ (0 - BEBIT(in, i));
+    }
+    return lanes;
+}
+
+// Tests a known key against the nonce, used to skip nonces that are already solved
+static inline bool key_matches_nonce(const MfClassicKey* key, const MfClassicNonce* nonce) {
+    uint64_t key_as_int = bit_lib_bytes_to_num_be(key->data, sizeof(MfClassicKey));
+    struct Crypto1State temp = {0, 0};
+    for(int i = 0; i < 24; i++) {
+        (&temp)->odd |= (BIT(key_as_int, 2 * i + 1) << (i ^ 3));
+        (&temp)->even |= (BIT(key_as_int, 2 * i) << (i ^ 3));
+    }
+    if(nonce->attack == mfkey32) {
+        crypt_word_noret(&temp, nonce->uid_xor_nt1, 0);
+        crypt_word_noret(&temp, nonce->nr1_enc, 1);
+        return nonce->ar1_enc == (crypt_word(&temp) ^ nonce->p64b);
+    }
+    // Static nested and static encrypted
+    return nonce->ks1_1_enc == crypt_word_ret(&temp, nonce->uid_xor_nt0, 0);
+}
+
 static inline uint32_t prng_successor(uint32_t x, uint32_t n) {
     SWAPENDIAN(x);
     while(n--)
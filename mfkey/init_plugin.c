@@ -3,6 +3,7 @@
 #include <toolbox/keys_dict.h>
 #include <bit_lib/bit_lib.h>
 #include <toolbox/stream/buffered_file_stream.h>
+#include <toolbox/stream/file_stream.h>
 #include <nfc/protocols/mf_classic/mf_classic.h>
 #include "mfkey.h"
 #include "crypto1.h"
@@ -14,6 +15,8 @@
 // TODO: Remove defines that are not needed
 #define MF_CLASSIC_NONCE_PATH        EXT_PATH("nfc/.mfkey32.log")
 #define MF_CLASSIC_NESTED_NONCE_PATH EXT_PATH("nfc/.nested.log")
+#define MF_CLASSIC_NONCE_CACHE_PATH        EXT_PATH("nfc/.mfkey32.cache")
+#define MF_CLASSIC_NESTED_NONCE_CACHE_PATH EXT_PATH("nfc/.nested.cache")
 #define MAX_NAME_LEN                 32
 #define MAX_PATH_LEN                 64
 
@@ -28,34 +31,104 @@
 #define SWAPENDIAN(x) \
     ((x) = ((x) >> 8 & 0xff00ff) | ((x) & 0xff00ff) << 8, (x) = (x) >> 16 | (x) << 16)
 
+// Every nonce is checked against every dictionary key, so the dictionaries are
+// read from the SD card once and kept in RAM when they fit
+#define DICT_KEY_CACHE_MAX_SIZE (24 * 1024)
+
+typedef struct {
+    bool loaded; // Dictionaries are streamed from the SD card otherwise
+    MfClassicKey* keys; // Sorted, without duplicates
+    size_t count;
+} DictKeyCache;
+
+static int dict_key_compare(const void* a, const void* b) {
+    return memcmp(a, b, sizeof(MfClassicKey));
+}
+
+void dict_key_cache_load(
+    DictKeyCache* cache,
+    KeysDict* system_dict,
+    bool system_dict_exists,
+    KeysDict* user_dict) {
+    cache->loaded = false;
+    cache->keys = NULL;
+    cache->count = 0;
+
+    size_t capacity = keys_dict_get_total_keys(user_dict);
+    if(system_dict_exists) {
+        capacity += keys_dict_get_total_keys(system_dict);
+    }
+    size_t cache_size = capacity * sizeof(MfClassicKey);
+    if((cache_size > DICT_KEY_CACHE_MAX_SIZE) ||
+       (cache_size >= memmgr_heap_get_max_free_block())) {
+        //FURI_LOG_I(TAG, "Dictionaries too large to cache: %zub", cache_size);
+        return;
+    }
+    if(capacity > 0) {
+        cache->keys = malloc(cache_size);
+    }
+
+    KeysDict* dicts[] = {system_dict_exists ? system_dict : NULL, user_dict};
+    for(size_t i = 0; i < COUNT_OF(dicts); i++) {
+        if(!dicts[i]) continue;
+        keys_dict_rewind(dicts[i]);
+        while((cache->count < capacity) &&
+              keys_dict_get_next_key(
+                  dicts[i], cache->keys[cache->count].data, sizeof(MfClassicKey))) {
+            cache->count++;
+        }
+    }
+
+    if(cache->count > 1) {
+        qsort(cache->keys, cache->count, sizeof(MfClassicKey), dict_key_compare);
+        size_t unique = 1;
+        for(size_t i = 1; i < cache->count; i++) {
+            if(dict_key_compare(&cache->keys[i], &cache->keys[unique - 1]) != 0) {
+                cache->keys[unique++] = cache->keys[i];
+            }
+        }
+        cache->count = unique;
+    }
+    cache->loaded = true;
+}
+
+void dict_key_cache_free(DictKeyCache* cache) {
+    free(cache->keys);
+    cache->keys = NULL;
+    cache->count = 0;
+    cache->loaded = false;
+}
+
 bool key_already_found_for_nonce_in_dict(KeysDict* dict, MfClassicNonce* nonce) {
     // This function must not be passed the CUID dictionary
     bool found = false;
-    uint8_t key_bytes[sizeof(MfClassicKey)];
+    MfClassicKey key;
     keys_dict_rewind(dict);
-    while(keys_dict_get_next_key(dict, key_bytes, sizeof(MfClassicKey))) {
-        uint64_t k = bit_lib_bytes_to_num_be(key_bytes, sizeof(MfClassicKey));
-        struct Crypto1State temp = {0, 0};
-        for(int i = 0; i < 24; i++) {
-            (&temp)->odd |= (BIT(k, 2 * i + 1) << (i ^ 3));
-            (&temp)->even |= (BIT(k, 2 * i) << (i ^ 3));
+    while(keys_dict_get_next_key(dict, key.data, sizeof(MfClassicKey))) {
+        if(key_matches_nonce(&key, nonce)) {
+            found = true;
+            break;
         }
-        if(nonce->attack == mfkey32) {
-            crypt_word_noret(&temp, nonce->uid_xor_nt1, 0);
-            crypt_word_noret(&temp, nonce->nr1_enc, 1);
-            if(nonce->ar1_enc == (crypt_word(&temp) ^ nonce->p64b)) {
-                found = true;
-                break;
-            }
-        } else if(nonce->attack == static_nested || nonce->attack == static_encrypted) {
-            uint32_t expected_ks1 = crypt_word_ret(&temp, nonce->uid_xor_nt0, 0);
-            if(nonce->ks1_1_enc == expected_ks1) {
-                found = true;
-                break;
+    }
+    return found;
+}
+
+bool key_already_found_for_nonce(
+    DictKeyCache* dict_cache,
+    KeysDict* system_dict,
+    bool system_dict_exists,
+    KeysDict* user_dict,
+    MfClassicNonce* nonce) {
+    if(dict_cache->loaded) {
+        for(size_t i = 0; i < dict_cache->count; i++) {
+            if(key_matches_nonce(&dict_cache->keys[i], nonce)) {
+                return true;
             }
         }
+        return false;
     }
-    return found;
+    return (system_dict_exists && key_already_found_for_nonce_in_dict(system_dict, nonce)) ||
+           key_already_found_for_nonce_in_dict(user_dict, nonce);
 }
 
 bool napi_mf_classic_mfkey32_nonces_check_presence() {
@@ -68,30 +141,239 @@ bool napi_mf_classic_mfkey32_nonces_check_presence() {
     return nonces_present;
 }
 
-bool napi_mf_classic_nested_nonces_check_presence() {
+// Parsed nonce logs are kept as raw MfClassicNonce records, the text log is only
+// parsed again when its size or timestamp no longer match the cache header
+#define NONCE_CACHE_MAGIC   0x4E4B464D // "MFKN"
+#define NONCE_CACHE_VERSION 3
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size; // sizeof(MfClassicNonce), a layout change drops the cache
+    uint32_t count;
+    uint32_t log_timestamp;
+    uint64_t log_size;
+} NonceCacheHeader;
+
+static bool nonce_cache_log_info(
+    Storage* storage,
+    const char* log_path,
+    uint64_t* log_size,
+    uint32_t* log_timestamp) {
+    FileInfo file_info;
+    if(storage_common_stat(storage, log_path, &file_info) != FSE_OK) return false;
+    if(storage_common_timestamp(storage, log_path, log_timestamp) != FSE_OK) return false;
+    *log_size = file_info.size;
+    return true;
+}
+
+#define NONCE_LOG_HASH_SEED  2166136261UL
+#define NONCE_LOG_HASH_PRIME 16777619UL
+
+// Numbers the nonce in log order and hashes the fields read from the log (FNV-1a),
+// so a checkpoint can tell whether it belongs to these logs
+static void nonce_array_log(MfClassicNonceArray* nonce_array, MfClassicNonce* nonce) {
+    uint32_t fields[] = {
+        nonce->attack,
+        nonce->sector,
+        nonce->key_type,
+        nonce->uid,
+        nonce->nt0,
+        nonce->nt1,
+        (nonce->attack == mfkey32) ? nonce->nr0_enc : nonce->ks1_1_enc,
+        (nonce->attack == mfkey32) ? nonce->ar0_enc : nonce->ks1_2_enc,
+        (nonce->attack == mfkey32) ? nonce->nr1_enc : nonce->par_1,
+        (nonce->attack == mfkey32) ? nonce->ar1_enc : nonce->par_2,
+    };
+    const uint8_t* data = (const uint8_t*)fields;
+    for(size_t i = 0; i < sizeof(fields); i++) {
+        nonce_array->log_hash = (nonce_array->log_hash ^ data[i]) * NONCE_LOG_HASH_PRIME;
+    }
+    nonce->log_index = nonce_array->log_nonces++;
+}
+
+static bool nonce_array_add(
+    MfClassicNonceArray* nonce_array,
+    ProgramState* program_state,
+    DictKeyCache* dict_cache,
+    KeysDict* system_dict,
+    bool system_dict_exists,
+    KeysDict* user_dict,
+    MfClassicNonce* nonce) {
+    nonce_array_log(nonce_array, nonce);
+    (program_state->total)++;
+    if(key_already_found_for_nonce(
+           dict_cache, system_dict, system_dict_exists, user_dict, nonce)) {
+        (program_state->cracked)++;
+        (program_state->num_completed)++;
+        return false;
+    }
+    // TODO: Refactor
+    nonce_array->remaining_nonce_array = realloc( //-V701
+        nonce_array->remaining_nonce_array,
+        sizeof(MfClassicNonce) * ((nonce_array->remaining_nonces) + 1));
+    nonce_array->remaining_nonce_array[nonce_array->remaining_nonces] = *nonce;
+    nonce_array->remaining_nonces++;
+    nonce_array->total_nonces++;
+    return true;
+}
+
+// Opens the cache of a log and reads its header, false if the cache is missing or stale
+static bool nonce_cache_open(
+    Storage* storage,
+    Stream* stream,
+    const char* cache_path,
+    const char* log_path,
+    NonceCacheHeader* header) {
+    uint64_t log_size;
+    uint32_t log_timestamp;
+    if(!nonce_cache_log_info(storage, log_path, &log_size, &log_timestamp)) return false;
+    if(!file_stream_open(stream, cache_path, FSAM_READ, FSOM_OPEN_EXISTING)) return false;
+    if(stream_read(stream, (uint8_t*)header, sizeof(NonceCacheHeader)) !=
+       sizeof(NonceCacheHeader)) {
+        return false;
+    }
+    return (header->magic == NONCE_CACHE_MAGIC) && (header->version == NONCE_CACHE_VERSION) &&
+           (header->record_size == sizeof(MfClassicNonce)) && (header->log_size == log_size) &&
+           (header->log_timestamp == log_timestamp);
+}
+
+// Loads every nonce of a valid cache with a single read, returns false if the log must be parsed
+static bool nonce_cache_load(
+    const char* cache_path,
+    const char* log_path,
+    MfClassicNonceArray* nonce_array,
+    ProgramState* program_state,
+    DictKeyCache* dict_cache,
+    KeysDict* system_dict,
+    bool system_dict_exists,
+    KeysDict* user_dict) {
     Storage* storage = furi_record_open(RECORD_STORAGE);
-    Stream* stream = buffered_file_stream_alloc(storage);
-    bool nonces_present = false;
-    FuriString* line = furi_string_alloc();
+    Stream* stream = file_stream_alloc(storage);
+    bool loaded = false;
 
     do {
-        if(!buffered_file_stream_open(
-               stream, MF_CLASSIC_NESTED_NONCE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        NonceCacheHeader header;
+        if(!nonce_cache_open(storage, stream, cache_path, log_path, &header)) break;
+        if(header.count == 0) {
+            loaded = true;
             break;
         }
 
-        while(stream_read_line(stream, line)) {
-            if(furi_string_search_str(line, "dist 0") != FURI_STRING_FAILURE) {
-                nonces_present = true;
-                break;
+        // Read straight behind the nonces already loaded, then keep the ones without a known key
+        size_t base = nonce_array->remaining_nonces;
+        size_t records_size = sizeof(MfClassicNonce) * header.count;
+        nonce_array->remaining_nonce_array = realloc( //-V701
+            nonce_array->remaining_nonce_array,
+            sizeof(MfClassicNonce) * (base + header.count));
+        MfClassicNonce* records = &nonce_array->remaining_nonce_array[base];
+        if(stream_read(stream, (uint8_t*)records, records_size) != records_size) break;
+
+        for(uint32_t i = 0; i < header.count; i++) {
+            MfClassicNonce nonce = records[i];
+            nonce_array_log(nonce_array, &nonce);
+            (program_state->total)++;
+            if(key_already_found_for_nonce(
+                   dict_cache, system_dict, system_dict_exists, user_dict, &nonce)) {
+                (program_state->cracked)++;
+                (program_state->num_completed)++;
+                continue;
             }
+            nonce_array->remaining_nonce_array[nonce_array->remaining_nonces] = nonce;
+            nonce_array->remaining_nonces++;
+            nonce_array->total_nonces++;
         }
-
+        loaded = true;
     } while(false);
 
-    furi_string_free(line);
-    buffered_file_stream_close(stream);
+    file_stream_close(stream);
     stream_free(stream);
+    furi_record_close(RECORD_STORAGE);
+    return loaded;
+}
+
+// Starts a cache with an invalid header, nonce_cache_finish() validates it once the log is parsed
+static Stream* nonce_cache_create(const char* cache_path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* stream = file_stream_alloc(storage);
+    furi_record_close(RECORD_STORAGE);
+    NonceCacheHeader header = {0};
+    if(!file_stream_open(stream, cache_path, FSAM_WRITE, FSOM_CREATE_ALWAYS) ||
+       (stream_write(stream, (uint8_t*)&header, sizeof(header)) != sizeof(header))) {
+        file_stream_close(stream);
+        stream_free(stream);
+        return NULL;
+    }
+    return stream;
+}
+
+static void nonce_cache_add(Stream* stream, NonceCacheHeader* header, MfClassicNonce* nonce) {
+    if(!stream) return;
+    if(stream_write(stream, (uint8_t*)nonce, sizeof(MfClassicNonce)) == sizeof(MfClassicNonce)) {
+        header->count++;
+    } else {
+        header->magic = 0; // Never validate a cache with missing records
+    }
+}
+
+static void nonce_cache_finish(
+    Stream* stream,
+    NonceCacheHeader* header,
+    const char* cache_path,
+    const char* log_path,
+    bool complete) {
+    if(!stream) return;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    bool saved = false;
+    if(complete && (header->magic == NONCE_CACHE_MAGIC) &&
+       nonce_cache_log_info(storage, log_path, &header->log_size, &header->log_timestamp)) {
+        header->version = NONCE_CACHE_VERSION;
+        header->record_size = sizeof(MfClassicNonce);
+        saved = stream_rewind(stream) &&
+                (stream_write(stream, (uint8_t*)header, sizeof(NonceCacheHeader)) ==
+                 sizeof(NonceCacheHeader));
+    }
+    file_stream_close(stream);
+    stream_free(stream);
+    if(!saved) {
+        storage_simply_remove(storage, cache_path);
+    }
+    furi_record_close(RECORD_STORAGE);
+}
+
+bool napi_mf_classic_nested_nonces_check_presence() {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    bool nonces_present = false;
+
+    // A valid cache holds every "dist 0" nonce of the log, the log is only read without one
+    Stream* cache = file_stream_alloc(storage);
+    NonceCacheHeader header;
+    bool cached = nonce_cache_open(
+        storage, cache, MF_CLASSIC_NESTED_NONCE_CACHE_PATH, MF_CLASSIC_NESTED_NONCE_PATH, &header);
+    file_stream_close(cache);
+    stream_free(cache);
+
+    if(cached) {
+        nonces_present = (header.count > 0);
+    } else {
+        Stream* stream = buffered_file_stream_alloc(storage);
+        FuriString* line = furi_string_alloc();
+
+        if(buffered_file_stream_open(
+               stream, MF_CLASSIC_NESTED_NONCE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+            while(stream_read_line(stream, line)) {
+                if(furi_string_search_str(line, "dist 0") != FURI_STRING_FAILURE) {
+                    nonces_present = true;
+                    break;
+                }
+            }
+        }
+
+        furi_string_free(line);
+        buffered_file_stream_close(stream);
+        stream_free(stream);
+    }
+
     furi_record_close(RECORD_STORAGE);
 
     return nonces_present;
@@ -112,11 +394,24 @@ int binaryStringToInt(const char* binStr) {
 bool load_mfkey32_nonces(
     MfClassicNonceArray* nonce_array,
     ProgramState* program_state,
+    DictKeyCache* dict_cache,
     KeysDict* system_dict,
     bool system_dict_exists,
     KeysDict* user_dict) {
     bool array_loaded = false;
 
+    if(nonce_cache_load(
+           MF_CLASSIC_NONCE_CACHE_PATH,
+           MF_CLASSIC_NONCE_PATH,
+           nonce_array,
+           program_state,
+           dict_cache,
+           system_dict,
+           system_dict_exists,
+           user_dict)) {
+        return true;
+    }
+
     do {
         // https://github.com/flipperdevices/flipperzero-firmware/blob/5134f44c09d39344a8747655c0d59864bb574b96/applications/services/storage/filesystem_api_defines.h#L8-L22
         if(!buffered_file_stream_open(
@@ -140,9 +435,13 @@ bool load_mfkey32_nonces(
         // Read total amount of nonces
         FuriString* next_line;
         next_line = furi_string_alloc();
+        NonceCacheHeader cache_header = {.magic = NONCE_CACHE_MAGIC};
+        Stream* cache = nonce_cache_create(MF_CLASSIC_NONCE_CACHE_PATH);
+        bool log_complete = false;
         while(!(program_state->close_thread_please)) {
             if(!stream_read_line(nonce_array->stream, next_line)) {
                 //FURI_LOG_T(TAG, "No nonces left");
+                log_complete = stream_eof(nonce_array->stream);
                 break;
             }
             /*
@@ -169,6 +468,13 @@ bool load_mfkey32_nonces(
                 }
                 unsigned long value = strtoul(next_line_cstr, &endptr, 16);
                 switch(i) {
+                case 1:
+                    res.sector = strtoul(next_line_cstr, &endptr, 10);
+                    break;
+                case 3:
+                    res.key_type = (*next_line_cstr == 'B') ? MfClassicKeyTypeB :
+                                                              MfClassicKeyTypeA;
+                    break;
                 case 5:
                     res.uid = value;
                     break;
@@ -195,29 +501,34 @@ bool load_mfkey32_nonces(
                 }
                 next_line_cstr = endptr;
             }
+            // Logs may append the encrypted parity bits of the reader answers, only the first
+            // answer's are used, a trailing par1 field is ignored
+            const char* par_str = strstr(furi_string_get_cstr(next_line), " par0 ");
+            char par0_str[9];
+            if(par_str && sscanf(par_str, " par0 %8[01]", par0_str) == 1 &&
+               strlen(par0_str) == 8) {
+                res.par0 = binaryStringToInt(par0_str);
+                res.par_present = true;
+            }
             res.p64 = prng_successor(res.nt0, 64);
             res.p64b = prng_successor(res.nt1, 64);
             res.uid_xor_nt0 = res.uid ^ res.nt0;
             res.uid_xor_nt1 = res.uid ^ res.nt1;
 
-            (program_state->total)++;
-            if((system_dict_exists && key_already_found_for_nonce_in_dict(system_dict, &res)) ||
-               (key_already_found_for_nonce_in_dict(user_dict, &res))) {
-                (program_state->cracked)++;
-                (program_state->num_completed)++;
-                continue;
-            }
-            //FURI_LOG_I(TAG, "No key found for %8lx %8lx", res.uid, res.ar1_enc);
-            // TODO: Refactor
-            nonce_array->remaining_nonce_array = realloc( //-V701
-                nonce_array->remaining_nonce_array,
-                sizeof(MfClassicNonce) * ((nonce_array->remaining_nonces) + 1));
-            nonce_array->remaining_nonces++;
-            nonce_array->remaining_nonce_array[(nonce_array->remaining_nonces) - 1] = res;
-            nonce_array->total_nonces++;
+            nonce_cache_add(cache, &cache_header, &res);
+            nonce_array_add(
+                nonce_array,
+                program_state,
+                dict_cache,
+                system_dict,
+                system_dict_exists,
+                user_dict,
+                &res);
         }
         furi_string_free(next_line);
         buffered_file_stream_close(nonce_array->stream);
+        nonce_cache_finish(
+            cache, &cache_header, MF_CLASSIC_NONCE_CACHE_PATH, MF_CLASSIC_NONCE_PATH, log_complete);
 
         array_loaded = true;
         //FURI_LOG_I(TAG, "Loaded %lu Mfkey32 nonces", nonce_array->total_nonces);
@@ -229,9 +540,23 @@ bool load_mfkey32_nonces(
 bool load_nested_nonces(
     MfClassicNonceArray* nonce_array,
     ProgramState* program_state,
+    DictKeyCache* dict_cache,
     KeysDict* system_dict,
     bool system_dict_exists,
     KeysDict* user_dict) {
+    size_t loaded_nonces = nonce_array->total_nonces;
+    if(nonce_cache_load(
+           MF_CLASSIC_NESTED_NONCE_CACHE_PATH,
+           MF_CLASSIC_NESTED_NONCE_PATH,
+           nonce_array,
+           program_state,
+           dict_cache,
+           system_dict,
+           system_dict_exists,
+           user_dict)) {
+        return nonce_array->total_nonces > loaded_nonces;
+    }
+
     if(!buffered_file_stream_open(
            nonce_array->stream, MF_CLASSIC_NESTED_NONCE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
         return false;
@@ -239,8 +564,16 @@ bool load_nested_nonces(
 
     FuriString* next_line = furi_string_alloc();
     bool array_loaded = false;
-
-    while(stream_read_line(nonce_array->stream, next_line)) {
+    NonceCacheHeader cache_header = {.magic = NONCE_CACHE_MAGIC};
+    Stream* cache = nonce_cache_create(MF_CLASSIC_NESTED_NONCE_CACHE_PATH);
+    bool log_complete = false;
+
+    while(!(program_state->close_thread_please)) {
+        if(!stream_read_line(nonce_array->stream, next_line)) {
+            // Only a log read to its end is cached
+            log_complete = stream_eof(nonce_array->stream);
+            break;
+        }
         const char* line = furi_string_get_cstr(next_line);
 
         // Only process lines ending with "dist 0"
@@ -250,11 +583,15 @@ bool load_nested_nonces(
 
         MfClassicNonce res = {0};
         res.attack = static_encrypted;
+        int sector = 0;
+        char key_type = 'A';
 
         int parsed = sscanf(
             line,
-            "Sec %*d key %*c cuid %" PRIx32 " nt0 %" PRIx32 " ks0 %" PRIx32
+            "Sec %d key %c cuid %" PRIx32 " nt0 %" PRIx32 " ks0 %" PRIx32
             " par0 %4[01] nt1 %" PRIx32 " ks1 %" PRIx32 " par1 %4[01]",
+            &sector,
+            &key_type,
             &res.uid,
             &res.nt0,
             &res.ks1_1_enc,
@@ -263,36 +600,40 @@ bool load_nested_nonces(
             &res.ks1_2_enc,
             res.par_2_str);
 
-        if(parsed >= 4) { // At least one nonce is present
+        if(parsed >= 6) { // At least one nonce is present
+            res.sector = sector;
+            res.key_type = (key_type == 'B') ? MfClassicKeyTypeB : MfClassicKeyTypeA;
             res.par_1 = binaryStringToInt(res.par_1_str);
             res.uid_xor_nt0 = res.uid ^ res.nt0;
 
-            if(parsed == 7) { // Both nonces are present
+            if(parsed == 9) { // Both nonces are present
                 res.attack = static_nested;
                 res.par_2 = binaryStringToInt(res.par_2_str);
                 res.uid_xor_nt1 = res.uid ^ res.nt1;
             }
 
-            (program_state->total)++;
-            if((system_dict_exists && key_already_found_for_nonce_in_dict(system_dict, &res)) ||
-               (key_already_found_for_nonce_in_dict(user_dict, &res))) {
-                (program_state->cracked)++;
-                (program_state->num_completed)++;
-                continue;
+            nonce_cache_add(cache, &cache_header, &res);
+            if(nonce_array_add(
+                   nonce_array,
+                   program_state,
+                   dict_cache,
+                   system_dict,
+                   system_dict_exists,
+                   user_dict,
+                   &res)) {
+                array_loaded = true;
             }
-
-            nonce_array->remaining_nonce_array = realloc(
-                nonce_array->remaining_nonce_array,
-                sizeof(MfClassicNonce) * (nonce_array->remaining_nonces + 1));
-            nonce_array->remaining_nonce_array[nonce_array->remaining_nonces] = res;
-            nonce_array->remaining_nonces++;
-            nonce_array->total_nonces++;
-            array_loaded = true;
         }
     }
 
     furi_string_free(next_line);
     buffered_file_stream_close(nonce_array->stream);
+    nonce_cache_finish(
+        cache,
+        &cache_header,
+        MF_CLASSIC_NESTED_NONCE_CACHE_PATH,
+        MF_CLASSIC_NESTED_NONCE_PATH,
+        log_complete);
 
     //FURI_LOG_I(TAG, "Loaded %lu Static Nested nonces", nonce_array->total_nonces);
     return array_loaded;
@@ -306,19 +647,24 @@ MfClassicNonceArray* napi_mf_classic_nonce_array_alloc(
     MfClassicNonceArray* nonce_array = malloc(sizeof(MfClassicNonceArray));
     MfClassicNonce* remaining_nonce_array_init = malloc(sizeof(MfClassicNonce) * 1);
     nonce_array->remaining_nonce_array = remaining_nonce_array_init;
+    nonce_array->log_hash = NONCE_LOG_HASH_SEED;
     Storage* storage = furi_record_open(RECORD_STORAGE);
     nonce_array->stream = buffered_file_stream_alloc(storage);
     furi_record_close(RECORD_STORAGE);
+    DictKeyCache dict_cache;
+    dict_key_cache_load(&dict_cache, system_dict, system_dict_exists, user_dict);
 
     if(program_state->mfkey32_present) {
         load_mfkey32_nonces(
-            nonce_array, program_state, system_dict, system_dict_exists, user_dict);
+            nonce_array, program_state, &dict_cache, system_dict, system_dict_exists, user_dict);
     }
 
     if(program_state->nested_present) {
-        load_nested_nonces(nonce_array, program_state, system_dict, system_dict_exists, user_dict);
+        load_nested_nonces(
+            nonce_array, program_state, &dict_cache, system_dict, system_dict_exists, user_dict);
     }
 
+    dict_key_cache_free(&dict_cache);
     return nonce_array;
 }
 
@@ -330,6 +676,7 @@ void napi_mf_classic_nonce_array_free(MfClassicNonceArray* nonce_array) {
     // TODO: Already closed?
     buffered_file_stream_close(nonce_array->stream);
     stream_free(nonce_array->stream);
+    free(nonce_array->remaining_nonce_array);
     free(nonce_array);
 }
 
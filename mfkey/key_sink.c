@@ -0,0 +1,80 @@
+#include <furi.h>
+#include <storage/storage.h>
+#include <toolbox/stream/file_stream.h>
+#include "key_sink.h"
+
+#define TAG "MFKey"
+
+// Same line format as keys_dict_add_key(): uppercase hex and a newline
+#define KEY_SINK_LINE_LEN (sizeof(MfClassicKey) * 2 + 1)
+
+KeySink* key_sink_alloc(const char* path) {
+    furi_assert(path);
+    KeySink* sink = malloc(sizeof(KeySink));
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    sink->stream = file_stream_alloc(storage);
+    if(!file_stream_open(sink->stream, path, FSAM_WRITE, FSOM_OPEN_APPEND)) {
+        FURI_LOG_E(TAG, "Failed to open %s", path);
+        file_stream_close(sink->stream);
+    }
+    return sink;
+}
+
+void key_sink_free(KeySink* sink) {
+    furi_assert(sink);
+    key_sink_flush(sink);
+    FURI_LOG_D(
+        TAG,
+        "Key sink: %zu keys, %zu bytes in %zu writes",
+        sink->total_keys,
+        sink->bytes_written,
+        sink->writes);
+    file_stream_close(sink->stream);
+    stream_free(sink->stream);
+    furi_record_close(RECORD_STORAGE);
+    free(sink);
+}
+
+bool key_sink_add(KeySink* sink, const MfClassicKey* key) {
+    furi_assert(sink);
+    for(size_t i = 0; i < sink->count; i++) {
+        if(memcmp(sink->keys[i].data, key->data, sizeof(MfClassicKey)) == 0) {
+            return false;
+        }
+    }
+    sink->keys[sink->count++] = *key;
+    sink->total_keys++;
+    if(sink->count == KEY_SINK_CHUNK_SIZE) {
+        key_sink_flush(sink);
+    }
+    return true;
+}
+
+bool key_sink_flush(KeySink* sink) {
+    furi_assert(sink);
+    if(sink->count == 0) return true;
+
+    static const char hex[] = "0123456789ABCDEF";
+    size_t text_size = sink->count * KEY_SINK_LINE_LEN;
+    uint8_t* text = malloc(text_size);
+    uint8_t* line = text;
+    for(size_t i = 0; i < sink->count; i++) {
+        for(size_t j = 0; j < sizeof(MfClassicKey); j++) {
+            *line++ = hex[sink->keys[i].data[j] >> 4];
+            *line++ = hex[sink->keys[i].data[j] & 0x0F];
+        }
+        *line++ = '\n';
+    }
+
+    bool flushed = false;
+    do {
+        if(stream_write(sink->stream, text, text_size) != text_size) break;
+        sink->bytes_written += text_size;
+        sink->writes++;
+        flushed = true;
+    } while(false);
+
+    free(text);
+    sink->count = 0;
+    return flushed;
+}
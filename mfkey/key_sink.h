@@ -0,0 +1,16 @@
+#ifndef KEY_SINK_H
+#define KEY_SINK_H
+
+#include "mfkey.h"
+
+// Opens its own stream on the dictionary, so the file must not be open as a KeysDict
+KeySink* key_sink_alloc(const char* path);
+// Flushes the pending chunk and closes the file
+void key_sink_free(KeySink* sink);
+// Returns false if the key is already waiting in the current chunk. Keys in earlier
+// chunks or already in the file are not checked, callers that care use
+// keys_dict_is_key_present() before adding.
+bool key_sink_add(KeySink* sink, const MfClassicKey* key);
+bool key_sink_flush(KeySink* sink);
+
+#endif // KEY_SINK_H
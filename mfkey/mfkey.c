@@ -4,15 +4,13 @@
 // TODO: More efficient dictionary bruteforce by scanning through hardcoded very common keys and previously found dictionary keys first?
 //       (a cache for key_already_found_for_nonce_in_dict)
 // TODO: Selectively unroll loops to reduce binary size
-// TODO: Collect parity during Mfkey32 attacks to further optimize the attack
 // TODO: Why different sscanf between Mfkey32 and Nested?
 // TODO: "Read tag again with NFC app" message upon completion, "Complete. Keys added: <n>"
 // TODO: Separate Mfkey32 and Nested functions where possible to reduce branch statements
-// TODO: Find ~1 KB memory leak
 // TODO: Use seednt16 to reduce static encrypted key candidates: https://gist.github.com/noproto/8102f8f32546564cd674256e62ff76ea
 //       https://eprint.iacr.org/2024/1275.pdf section X
+//       (needs the encrypted nt in the log, candidates are only cross-checked against other nonces for the same key so far)
 // TODO: Static Encrypted: Minimum RAM for adding to keys dict (avoid crashes)
-// TODO: Static Encrypted: Optimize KeysDict or buffer keys to write in chunks
 
 #include <furi.h>
 #include <furi_hal.h>
@@ -28,6 +26,9 @@
 #include <nfc/protocols/mf_classic/mf_classic.h>
 #include "mfkey.h"
 #include "crypto1.h"
+#include "key_sink.h"
+#include "profile.h"
+#include "checkpoint.h"
 #include "plugin_interface.h"
 #include <flipper_application/flipper_application.h>
 #include <loader/firmware_api/firmware_api.h>
@@ -38,6 +39,8 @@
 // TODO: Remove defines that are not needed
 #define KEYS_DICT_SYSTEM_PATH EXT_PATH("nfc/assets/mf_classic_dict.nfc")
 #define KEYS_DICT_USER_PATH   EXT_PATH("nfc/assets/mf_classic_dict_user.nfc")
+#define MFKEY_PROFILE_PATH    EXT_PATH("nfc/.mfkey_profile.log")
+#define MFKEY_CHECKPOINT_PATH EXT_PATH("nfc/.mfkey_checkpoint")
 #define MAX_NAME_LEN          32
 #define MAX_PATH_LEN          64
 
@@ -53,13 +56,37 @@
     ((x) = ((x) >> 8 & 0xff00ff) | ((x) & 0xff00ff) << 8, (x) = (x) >> 16 | (x) << 16)
 //#define SIZEOF(arr) sizeof(arr) / sizeof(*arr)
 
-static int eta_round_time = 44;
-static int eta_total_time = 705;
-// MSB_LIMIT: Chunk size (out of 256)
-static int MSB_LIMIT = 16;
+// MSB_LIMIT: Chunk size (out of 256), set by the memory planner for every nonce
+#define MSB_LIMIT_MAX 16
+static int MSB_LIMIT = MSB_LIMIT_MAX;
 
-static inline int
-    check_state(struct Crypto1State* t, MfClassicNonce* n, ProgramState* program_state) {
+static inline bool
+    key_matches_static_encrypted_siblings(MfClassicKey* key, MsbPartition* partition) {
+    for(int i = 0; i < partition->sen_sibling_count; i++) {
+        if(!key_matches_nonce(key, &partition->sen_siblings[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A candidate key that reproduces both keystream words of another capture for the
+// same key is the key, even if the nonce being searched was logged wrong
+static inline bool key_state_matches_static_nested_siblings(
+    struct Crypto1State* key_state,
+    MsbPartition* partition) {
+    for(int i = 0; i < partition->sn_sibling_count; i++) {
+        const MfClassicNonce* sibling = &partition->sn_siblings[i];
+        struct Crypto1State temp = {key_state->odd, key_state->even};
+        if(crypt_word_ret(&temp, sibling->uid_xor_nt0, 0) != sibling->ks1_1_enc) continue;
+        temp = *key_state;
+        if(crypt_word_ret(&temp, sibling->uid_xor_nt1, 0) == sibling->ks1_2_enc) return true;
+    }
+    return false;
+}
+
+static inline int check_state(struct Crypto1State* t, MsbPartition* partition) {
+    MfClassicNonce* n = &partition->nonce;
     if(!(t->odd | t->even)) return 0;
     if(n->attack == mfkey32) {
         uint32_t rb = (napi_lfsr_rollback_word(t, 0, 0) ^ n->p64);
@@ -67,6 +94,13 @@ static inline int
             return 0;
         }
         rollback_word_noret(t, n->nr0_enc, 1);
+        if(n->par_present) {
+            // Reduce with parity before running the second authentication
+            struct Crypto1State par_state = {t->odd, t->even};
+            if(crypt_reader_par(&par_state, n->nr0_enc, n->p64) != n->par0) {
+                return 0;
+            }
+        }
         rollback_word_noret(t, n->uid_xor_nt0, 0);
         struct Crypto1State temp = {t->odd, t->even};
         crypt_word_noret(t, n->uid_xor_nt1, 0);
@@ -76,10 +110,10 @@ static inline int
             return 1;
         }
     } else if(n->attack == static_nested) {
-        struct Crypto1State temp = {t->odd, t->even};
         rollback_word_noret(t, n->uid_xor_nt1, 0);
-        if(n->ks1_1_enc == crypt_word_ret(t, n->uid_xor_nt0, 0)) {
-            rollback_word_noret(&temp, n->uid_xor_nt1, 0);
+        struct Crypto1State temp = {t->odd, t->even};
+        if((n->ks1_1_enc == crypt_word_ret(t, n->uid_xor_nt0, 0)) ||
+           key_state_matches_static_nested_siblings(&temp, partition)) {
             crypto1_get_lfsr(&temp, &(n->key));
             return 1;
         }
@@ -94,14 +128,50 @@ static inline int
                (local_parity_keystream_bits == n->par_1)) {
                 // Found key candidate
                 crypto1_get_lfsr(t, &(n->key));
-                program_state->num_candidates++;
-                keys_dict_add_key(program_state->cuid_dict, n->key.data, sizeof(MfClassicKey));
+                if(key_matches_static_encrypted_siblings(&(n->key), partition)) {
+                    partition->num_candidates++;
+                    key_sink_add(partition->cuid_sink, &(n->key));
+                }
             }
         }
     }
     return 0;
 }
 
+static inline int
+    check_state_batch(struct Crypto1BsState* bs, int count, MsbPartition* partition) {
+    MfClassicNonce* n = &partition->nonce;
+    // Bitsliced prefilter on the first keystream word, only the surviving lanes get the full check
+    uint32_t lanes = (count == CRYPTO1_BS_LANES) ? 0xFFFFFFFF : ((1U << count) - 1);
+    crypto1_bs_load(bs, count);
+    if(n->attack == mfkey32) {
+        lanes = crypto1_bs_rollback_word_match(bs, 0, n->ar0_enc ^ n->p64, lanes);
+    } else if(n->attack == static_nested) {
+        // The rollback to the key state is shared, each sibling only adds a forward word
+        crypto1_bs_rollback_word(bs, n->uid_xor_nt1);
+        int key_base = bs->base;
+        uint32_t matched = crypto1_bs_crypt_word_match(bs, n->uid_xor_nt0, n->ks1_1_enc, lanes);
+        for(int i = 0; i < partition->sn_sibling_count; i++) {
+            const MfClassicNonce* sibling = &partition->sn_siblings[i];
+            bs->base = key_base;
+            matched |=
+                crypto1_bs_crypt_word_match(bs, sibling->uid_xor_nt0, sibling->ks1_1_enc, lanes);
+        }
+        lanes = matched;
+    } else if(n->attack == static_encrypted) {
+        lanes = crypto1_bs_rollback_word_match(bs, n->uid_xor_nt0, n->ks1_1_enc, lanes);
+    }
+    while(lanes) {
+        int lane = __builtin_ctz(lanes);
+        lanes &= lanes - 1;
+        struct Crypto1State temp = {bs->odd[lane], bs->even[lane]};
+        if(check_state(&temp, partition)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 static inline int state_loop(
     unsigned int* states_buffer,
     int xks,
@@ -160,35 +230,120 @@ int binsearch(unsigned int data[], int start, int stop) {
     }
     return start;
 }
-void quicksort(unsigned int array[], int low, int high) {
-    //if (SIZEOF(array) == 0)
-    //    return;
-    if(low >= high) return;
-    int middle = low + (high - low) / 2;
-    unsigned int pivot = array[middle];
-    int i = low, j = high;
-    while(i <= j) {
-        while(array[i] < pivot) {
-            i++;
-        }
-        while(array[j] > pivot) {
-            j--;
-        }
-        if(i <= j) { // swap
-            int temp = array[i];
-            array[i] = array[j];
-            array[j] = temp;
-            i++;
+// Ranges at most this long are finished with an insertion sort
+#define SORT_INSERTION_SIZE 16
+// The larger partition is deferred and the smaller one sorted first, so the
+// stack never holds more than log2(n) ranges
+#define SORT_STACK_SIZE 32
+
+static void insertion_sort(unsigned int array[], int low, int high) {
+    for(int i = low + 1; i <= high; i++) {
+        unsigned int value = array[i];
+        int j = i - 1;
+        while(j >= low && array[j] > value) {
+            array[j + 1] = array[j];
             j--;
         }
+        array[j + 1] = value;
+    }
+}
+
+static void heap_sift_down(unsigned int heap[], int root, int count) {
+    unsigned int value = heap[root];
+    for(int child = 2 * root + 1; child < count; child = 2 * root + 1) {
+        if(child + 1 < count && heap[child + 1] > heap[child]) child++;
+        if(heap[child] <= value) break;
+        heap[root] = heap[child];
+        root = child;
+    }
+    heap[root] = value;
+}
+
+static void heap_sort(unsigned int array[], int low, int high) {
+    unsigned int* heap = &array[low];
+    int count = high - low + 1;
+    for(int i = count / 2 - 1; i >= 0; i--) {
+        heap_sift_down(heap, i, count);
     }
-    if(low < j) {
-        quicksort(array, low, j);
+    for(int i = count - 1; i > 0; i--) {
+        unsigned int temp = heap[0];
+        heap[0] = heap[i];
+        heap[i] = temp;
+        heap_sift_down(heap, 0, i);
     }
-    if(high > i) {
-        quicksort(array, i, high);
+}
+
+static inline unsigned int median_of_three(unsigned int a, unsigned int b, unsigned int c) {
+    if(a > b) {
+        unsigned int temp = a;
+        a = b;
+        b = temp;
+    }
+    return (c <= a) ? a : ((c >= b) ? b : c);
+}
+
+// Introsort without recursion: quicksort on an explicit stack, heapsort once a range
+// has been partitioned depth times, insertion sort for short ranges
+static void introsort_depth(unsigned int array[], int low, int high, int depth) {
+    struct {
+        int low;
+        int high;
+        int depth;
+    } stack[SORT_STACK_SIZE];
+    int top = 0;
+    if(low >= high) return;
+
+    for(;;) {
+        if(high - low < SORT_INSERTION_SIZE) {
+            insertion_sort(array, low, high);
+        } else if(depth == 0) {
+            heap_sort(array, low, high);
+        } else {
+            depth--;
+            unsigned int pivot = median_of_three(
+                array[low], array[low + (high - low) / 2], array[high]);
+            int i = low, j = high;
+            while(i <= j) {
+                while(array[i] < pivot) {
+                    i++;
+                }
+                while(array[j] > pivot) {
+                    j--;
+                }
+                if(i <= j) { // swap
+                    unsigned int temp = array[i];
+                    array[i] = array[j];
+                    array[j] = temp;
+                    i++;
+                    j--;
+                }
+            }
+            // Defer the larger side, keep going on the smaller one
+            stack[top].depth = depth;
+            if(j - low < high - i) {
+                stack[top].low = i;
+                stack[top].high = high;
+                high = j;
+            } else {
+                stack[top].low = low;
+                stack[top].high = j;
+                low = i;
+            }
+            top++;
+            continue;
+        }
+        if(top == 0) break;
+        top--;
+        low = stack[top].low;
+        high = stack[top].high;
+        depth = stack[top].depth;
     }
 }
+
+void introsort(unsigned int array[], int low, int high) {
+    if(low >= high) return;
+    introsort_depth(array, low, high, 2 * (32 - __builtin_clz(high - low + 1)));
+}
 int extend_table(unsigned int data[], int tbl, int end, int bit, int m1, int m2, unsigned int in) {
     in <<= 24;
     for(data[tbl] <<= 1; tbl <= end; data[++tbl] <<= 1) {
@@ -221,23 +376,49 @@ int old_recover(
     int eks,
     int rem,
     int s,
-    MfClassicNonce* n,
     unsigned int in,
     int first_run,
-    ProgramState* program_state) {
+    struct Crypto1BsState* bs,
+    MsbPartition* partition) {
+    MfClassicNonce* n = &partition->nonce;
     int o, e, i;
     if(rem == -1) {
+        int lane = 0;
+        // The parity bit of the last ar0 byte is encrypted with the first keystream bit after
+        // ar0, which is the filter output of the candidate state itself
+        int par_ks = -1;
+        if((n->attack == mfkey32) && n->par_present) {
+            par_ks = (n->par0 & 1) ^ nfc_util_odd_parity8(n->p64 & 0xFF);
+        }
         for(e = e_head; e <= e_tail; ++e) {
             even[e] = (even[e] << 1) ^ evenparity32(even[e] & LF_POLY_EVEN) ^ (!!(in & 4));
+            // Candidate odd halves are even[e] with bit 0 flipped by the odd feedback parity,
+            // bit p of par_keep is set when feedback parity p gives the expected keystream bit
+            int par_keep = 3;
+            if(par_ks >= 0) {
+                par_keep = (filter(even[e]) == par_ks) | (filter(even[e] ^ 1) == par_ks) << 1;
+                if(!par_keep) {
+                    s += o_tail - o_head + 1;
+                    continue;
+                }
+            }
             for(o = o_head; o <= o_tail; ++o, ++s) {
-                struct Crypto1State temp = {0, 0};
-                temp.even = odd[o];
-                temp.odd = even[e] ^ evenparity32(odd[o] & LF_POLY_ODD);
-                if(check_state(&temp, n, program_state)) {
-                    return -1;
+                if(par_keep != 3 && !((par_keep >> evenparity32(odd[o] & LF_POLY_ODD)) & 1)) {
+                    continue;
+                }
+                bs->even[lane] = odd[o];
+                bs->odd[lane] = even[e] ^ evenparity32(odd[o] & LF_POLY_ODD);
+                if(++lane == CRYPTO1_BS_LANES) {
+                    if(check_state_batch(bs, lane, partition)) {
+                        return -1;
+                    }
+                    lane = 0;
                 }
             }
         }
+        if((lane > 0) && check_state_batch(bs, lane, partition)) {
+            return -1;
+        }
         return s;
     }
     if(first_run == 0) {
@@ -245,17 +426,23 @@ int old_recover(
             oks >>= 1;
             eks >>= 1;
             in >>= 2;
+            uint32_t start = profile_cycles();
             o_tail = extend_table(
                 odd, o_head, o_tail, oks & 1, LF_POLY_EVEN << 1 | 1, LF_POLY_ODD << 1, 0);
+            profile_add(partition->profile, ProfilePhaseExtend, start);
             if(o_head > o_tail) return s;
+            start = profile_cycles();
             e_tail = extend_table(
                 even, e_head, e_tail, eks & 1, LF_POLY_ODD, LF_POLY_EVEN << 1 | 1, in & 3);
+            profile_add(partition->profile, ProfilePhaseExtend, start);
             if(e_head > e_tail) return s;
         }
     }
     first_run = 0;
-    quicksort(odd, o_head, o_tail);
-    quicksort(even, e_head, e_tail);
+    uint32_t start = profile_cycles();
+    introsort(odd, o_head, o_tail);
+    introsort(even, e_head, e_tail);
+    profile_add(partition->profile, ProfilePhaseSort, start);
     while(o_tail >= o_head && e_tail >= e_head) {
         if(((odd[o_tail] ^ even[e_tail]) >> 24) == 0) {
             o_tail = binsearch(odd, o_head, o = o_tail);
@@ -271,10 +458,10 @@ int old_recover(
                 eks,
                 rem,
                 s,
-                n,
                 in,
                 first_run,
-                program_state);
+                bs,
+                partition);
             if(s == -1) {
                 break;
             }
@@ -287,52 +474,100 @@ int old_recover(
     return s;
 }
 
-static inline int sync_state(ProgramState* program_state) {
-    int ts = furi_hal_rtc_get_timestamp();
-    int elapsed_time = ts - program_state->eta_timestamp;
-    if(elapsed_time < program_state->eta_round) {
-        program_state->eta_round -= elapsed_time;
-    } else {
-        program_state->eta_round = 0;
+// MSB buckets are open-addressed hash sets while states are being collected.
+// Every state in a bucket shares the same top byte (its MSB), so any slot whose
+// top byte differs from the bucket MSB is empty.
+static inline void msb_bucket_init(struct Msb* bucket, unsigned int msb) {
+    uint32_t empty_slot = ~(msb << 24);
+    bucket->tail = 0;
+    for(int i = 0; i < MSB_BUCKET_CAPACITY; i++) {
+        bucket->states[i] = empty_slot;
     }
-    if(elapsed_time < program_state->eta_total) {
-        program_state->eta_total -= elapsed_time;
-    } else {
-        program_state->eta_total = 0;
+}
+
+static inline void msb_bucket_insert(struct Msb* bucket, unsigned int msb, uint32_t state) {
+    // Fibonacci hash, mapped onto [0, MSB_BUCKET_CAPACITY) without a division
+    uint32_t slot = ((uint64_t)(state * 2654435761U) * MSB_BUCKET_CAPACITY) >> 32;
+    while((bucket->states[slot] >> 24) == msb) {
+        if(bucket->states[slot] == state) {
+            // Duplicate
+            return;
+        }
+        if(++slot == MSB_BUCKET_CAPACITY) {
+            slot = 0;
+        }
+    }
+    // Always leave one empty slot so probing terminates
+    if(bucket->tail >= MSB_BUCKET_CAPACITY - 1) {
+        return;
+    }
+    bucket->states[slot] = state;
+    bucket->tail++;
+}
+
+static inline void msb_bucket_compact(struct Msb* bucket, unsigned int msb) {
+    // Move the occupied slots to the front, states[0..tail) is a plain list afterwards
+    int tail = 0;
+    for(int i = 0; i < MSB_BUCKET_CAPACITY; i++) {
+        if((bucket->states[i] >> 24) == msb) {
+            bucket->states[tail++] = bucket->states[i];
+        }
     }
-    program_state->eta_timestamp = ts;
+}
+
+static inline int sync_state(ProgramState* program_state) {
+    uint32_t elapsed_ms = furi_get_tick() - program_state->eta_timestamp;
+    program_state->eta_round = (elapsed_ms < program_state->eta_round_ms) ?
+                                   (program_state->eta_round_ms - elapsed_ms) / 1000 :
+                                   0;
+    program_state->eta_total = (elapsed_ms < program_state->eta_total_ms) ?
+                                   (program_state->eta_total_ms - elapsed_ms) / 1000 :
+                                   0;
     if(program_state->close_thread_please) {
         return 1;
     }
     return 0;
 }
 
+static inline bool msb_partition_sync(MsbPartition* partition, MsbPartitionEvent event) {
+    if(partition->callback(partition, event, partition->context)) {
+        partition->stopped = true;
+    }
+    return partition->stopped;
+}
+
 int calculate_msb_tables(
     int oks,
     int eks,
     int msb_round,
-    MfClassicNonce* n,
-    unsigned int* states_buffer,
-    struct Msb* odd_msbs,
-    struct Msb* even_msbs,
-    unsigned int* temp_states_odd,
-    unsigned int* temp_states_even,
     unsigned int in,
-    ProgramState* program_state) {
+    MsbPartition* partition) {
     //FURI_LOG_I(TAG, "MSB GO %i", msb_iter); // DEBUG
-    unsigned int msb_head = (MSB_LIMIT * msb_round); // msb_iter ranges from 0 to (256/MSB_LIMIT)-1
-    unsigned int msb_tail = (MSB_LIMIT * (msb_round + 1));
-    int states_tail = 0, tail = 0;
-    int i = 0, j = 0, semi_state = 0, found = 0;
+    MsbTables* tables = &partition->tables;
+    struct Msb* odd_msbs = tables->odd_msbs;
+    struct Msb* even_msbs = tables->even_msbs;
+    unsigned int* temp_states_odd = tables->temp_states_odd;
+    unsigned int* temp_states_even = tables->temp_states_even;
+    unsigned int* states_buffer = tables->states_buffer;
+    // states_buffer is idle while old_recover() runs, it holds the bitsliced candidate batch
+    struct Crypto1BsState* bs = (struct Crypto1BsState*)states_buffer;
+    // msb_round ranges from 0 to msb_rounds(msb_limit)-1, the last round may be shorter
+    unsigned int msb_head = (tables->msb_limit * msb_round);
+    unsigned int msb_tail = MIN(msb_head + tables->msb_limit, 256u);
+    int msb_count = msb_tail - msb_head;
+    int states_tail = 0;
+    int i = 0, semi_state = 0;
     unsigned int msb = 0;
     in = ((in >> 16 & 0xff) | (in << 16) | (in & 0xff00)) << 1;
-    // TODO: Why is this necessary?
-    memset(odd_msbs, 0, MSB_LIMIT * sizeof(struct Msb));
-    memset(even_msbs, 0, MSB_LIMIT * sizeof(struct Msb));
+    uint32_t start = profile_cycles();
+    for(i = 0; i < msb_count; i++) {
+        msb_bucket_init(&odd_msbs[i], msb_head + i);
+        msb_bucket_init(&even_msbs[i], msb_head + i);
+    }
 
     for(semi_state = 1 << 20; semi_state >= 0; semi_state--) {
         if(semi_state % 32768 == 0) {
-            if(sync_state(program_state) == 1) {
+            if(msb_partition_sync(partition, MsbPartitionPoll)) {
                 return 0;
             }
         }
@@ -344,18 +579,7 @@ int calculate_msb_tables(
             for(i = states_tail; i >= 0; i--) {
                 msb = states_buffer[i] >> 24;
                 if((msb >= msb_head) && (msb < msb_tail)) {
-                    found = 0;
-                    for(j = 0; j < odd_msbs[msb - msb_head].tail - 1; j++) {
-                        if(odd_msbs[msb - msb_head].states[j] == states_buffer[i]) {
-                            found = 1;
-                            break;
-                        }
-                    }
-
-                    if(!found) {
-                        tail = odd_msbs[msb - msb_head].tail++;
-                        odd_msbs[msb - msb_head].states[tail] = states_buffer[i];
-                    }
+                    msb_bucket_insert(&odd_msbs[msb - msb_head], msb, states_buffer[i]);
                 }
             }
         }
@@ -367,29 +591,23 @@ int calculate_msb_tables(
             for(i = 0; i <= states_tail; i++) {
                 msb = states_buffer[i] >> 24;
                 if((msb >= msb_head) && (msb < msb_tail)) {
-                    found = 0;
-
-                    for(j = 0; j < even_msbs[msb - msb_head].tail; j++) {
-                        if(even_msbs[msb - msb_head].states[j] == states_buffer[i]) {
-                            found = 1;
-                            break;
-                        }
-                    }
-
-                    if(!found) {
-                        tail = even_msbs[msb - msb_head].tail++;
-                        even_msbs[msb - msb_head].states[tail] = states_buffer[i];
-                    }
+                    msb_bucket_insert(&even_msbs[msb - msb_head], msb, states_buffer[i]);
                 }
             }
         }
     }
 
+    for(i = 0; i < msb_count; i++) {
+        msb_bucket_compact(&odd_msbs[i], msb_head + i);
+        msb_bucket_compact(&even_msbs[i], msb_head + i);
+    }
+    profile_add(partition->profile, ProfilePhaseTables, start);
+
     oks >>= 12;
     eks >>= 12;
 
-    for(i = 0; i < MSB_LIMIT; i++) {
-        if(sync_state(program_state) == 1) {
+    for(i = 0; i < msb_count; i++) {
+        if(msb_partition_sync(partition, MsbPartitionPoll)) {
             return 0;
         }
         // TODO: Why is this necessary?
@@ -397,6 +615,7 @@ int calculate_msb_tables(
         memset(temp_states_odd, 0, sizeof(unsigned int) * (1280));
         memcpy(temp_states_odd, odd_msbs[i].states, odd_msbs[i].tail * sizeof(unsigned int));
         memcpy(temp_states_even, even_msbs[i].states, even_msbs[i].tail * sizeof(unsigned int));
+        start = profile_cycles();
         int res = old_recover(
             temp_states_odd,
             0,
@@ -408,10 +627,11 @@ int calculate_msb_tables(
             eks,
             3,
             0,
-            n,
             in >> 16,
             1,
-            program_state);
+            bs,
+            partition);
+        profile_add(partition->profile, ProfilePhaseRecover, start);
         if(res == -1) {
             return 1;
         }
@@ -441,81 +661,156 @@ void** allocate_blocks(const size_t* block_sizes, int num_blocks) {
     return block_pointers;
 }
 
-bool is_full_speed() {
-    return MSB_LIMIT == 16;
+static inline int msb_rounds(int msb_limit) {
+    return (256 + msb_limit - 1) / msb_limit;
 }
 
-bool recover(MfClassicNonce* n, int ks2, unsigned int in, ProgramState* program_state) {
-    bool found = false;
-    const size_t block_sizes[] = {49216, 49216, 5120, 5120, 4096};
-    const size_t reduced_block_sizes[] = {24608, 24608, 5120, 5120, 4096};
-    const int num_blocks = sizeof(block_sizes) / sizeof(block_sizes[0]);
-    void** block_pointers = allocate_blocks(block_sizes, num_blocks);
-    if(block_pointers == NULL) {
-        // System has less than the guaranteed amount of RAM (140 KB) - adjust some parameters to run anyway at half speed
-        if(is_full_speed()) {
-            //eta_round_time *= 2;
-            eta_total_time *= 2;
-            MSB_LIMIT /= 2;
-        }
-        block_pointers = allocate_blocks(reduced_block_sizes, num_blocks);
-        if(block_pointers == NULL) {
-            // System has less than 70 KB of RAM - should never happen so we don't reduce speed further
-            program_state->err = InsufficientRAM;
-            program_state->mfkey_state = Error;
-            return false;
+// Memory planner: every round scans all 2^20 semi-states, so the crack time follows the
+// round count. Tries bucket counts from the largest that fits the biggest free block down,
+// each one trimmed to the fewest buckets giving the same round count.
+void** allocate_msb_tables(int* msb_limit) {
+    const size_t fixed_size = 5120 + 5120 + 4096;
+    int limit = MIN(MSB_LIMIT_MAX, (int)(memmgr_heap_get_max_free_block() / sizeof(struct Msb)));
+    for(; limit > 0; limit--) {
+        limit = (256 + msb_rounds(limit) - 1) / msb_rounds(limit);
+        size_t table_size = sizeof(struct Msb) * limit;
+        if(memmgr_get_free_heap() < (2 * table_size + fixed_size)) continue;
+        const size_t block_sizes[] = {table_size, table_size, 5120, 5120, 4096};
+        void** block_pointers = allocate_blocks(block_sizes, COUNT_OF(block_sizes));
+        if(block_pointers != NULL) {
+            *msb_limit = limit;
+            return block_pointers;
         }
     }
-    // Adjust estimates for static encrypted attacks
-    if(n->attack == static_encrypted) {
-        eta_round_time *= 4;
-        eta_total_time *= 4;
-        if(is_full_speed()) {
-            eta_round_time *= 4;
-            eta_total_time *= 4;
-        }
-    }
-    struct Msb* odd_msbs = block_pointers[0];
-    struct Msb* even_msbs = block_pointers[1];
-    unsigned int* temp_states_odd = block_pointers[2];
-    unsigned int* temp_states_even = block_pointers[3];
-    unsigned int* states_buffer = block_pointers[4];
-    int oks = 0, eks = 0;
-    int i = 0, msb = 0;
-    for(i = 31; i >= 0; i -= 2) {
-        oks = oks << 1 | BEBIT(ks2, i);
-    }
-    for(i = 30; i >= 0; i -= 2) {
-        eks = eks << 1 | BEBIT(ks2, i);
-    }
-    int bench_start = furi_hal_rtc_get_timestamp();
-    program_state->eta_total = eta_total_time;
-    program_state->eta_timestamp = bench_start;
-    for(msb = 0; msb <= ((256 / MSB_LIMIT) - 1); msb++) {
-        program_state->search = msb;
-        program_state->eta_round = eta_round_time;
-        program_state->eta_total = eta_total_time - (eta_round_time * msb);
-        if(calculate_msb_tables(
-               oks,
-               eks,
-               msb,
-               n,
-               states_buffer,
-               odd_msbs,
-               even_msbs,
-               temp_states_odd,
-               temp_states_even,
-               in,
-               program_state)) {
-            //int bench_stop = furi_hal_rtc_get_timestamp();
-            //FURI_LOG_I(TAG, "Cracked in %i seconds", bench_stop - bench_start);
-            found = true;
+    return NULL;
+}
+
+static void checkpoint_update(ProgramState* program_state, int nonce_candidates) {
+    // Candidates from the finished rounds must be on the SD card before the checkpoint skips them
+    if(program_state->cuid_sink) {
+        key_sink_flush(program_state->cuid_sink);
+    }
+    program_state->checkpoint.num_candidates = program_state->num_candidates;
+    program_state->checkpoint.nonce_candidates = nonce_candidates;
+    checkpoint_save(&program_state->checkpoint, MFKEY_CHECKPOINT_PATH);
+}
+
+static inline void msb_keystream_split(int ks2, int* oks, int* eks) {
+    *oks = 0;
+    *eks = 0;
+    for(int i = 31; i >= 0; i -= 2) {
+        *oks = *oks << 1 | BEBIT(ks2, i);
+    }
+    for(int i = 30; i >= 0; i -= 2) {
+        *eks = *eks << 1 | BEBIT(ks2, i);
+    }
+}
+
+bool recover_msb_range(
+    MsbPartition* partition,
+    int oks,
+    int eks,
+    unsigned int in,
+    int msb_first,
+    int msb_last) {
+    partition->start_tick = furi_get_tick();
+    for(int msb = msb_first; msb <= msb_last; msb++) {
+        partition->msb_round = msb;
+        partition->round_tick = furi_get_tick();
+        if(msb_partition_sync(partition, MsbPartitionRoundStart)) {
             break;
         }
-        if(program_state->close_thread_please) {
+        if(calculate_msb_tables(oks, eks, msb, in, partition)) {
+            return true;
+        }
+        if(partition->stopped || msb_partition_sync(partition, MsbPartitionRoundDone)) {
             break;
         }
     }
+    return false;
+}
+
+// The worker's partition reports to the UI, the profile and the checkpoint
+static bool recover_partition_callback(
+    MsbPartition* partition,
+    MsbPartitionEvent event,
+    void* context) {
+    ProgramState* program_state = context;
+    AttackType attack = partition->nonce.attack;
+    int msb = partition->msb_round;
+    if(event == MsbPartitionRoundStart) {
+        uint32_t round_ms = profile_round_estimate(&program_state->profile, attack);
+        program_state->search = msb;
+        program_state->eta_timestamp = partition->round_tick;
+        program_state->eta_round_ms = round_ms;
+        program_state->eta_total_ms = round_ms * (msb_rounds(partition->tables.msb_limit) - msb);
+        program_state->eta_span_ms = (partition->round_tick - partition->start_tick) +
+                                     program_state->eta_total_ms;
+    } else if(event == MsbPartitionRoundDone) {
+        profile_round_done(
+            &program_state->profile, attack, furi_get_tick() - partition->round_tick);
+        program_state->checkpoint.msb_done = MIN((msb + 1) * partition->tables.msb_limit, 256);
+        checkpoint_update(program_state, partition->num_candidates);
+    }
+    return sync_state(program_state) == 1;
+}
+
+bool recover(
+    MfClassicNonce* n,
+    int ks2,
+    unsigned int in,
+    uint32_t msb_done,
+    ProgramState* program_state) {
+    bool found = false;
+    const int num_blocks = 5;
+    void** block_pointers = allocate_msb_tables(&MSB_LIMIT);
+    if(block_pointers == NULL) {
+        // Not even a single MSB bucket per table fits
+        program_state->err = InsufficientRAM;
+        program_state->mfkey_state = Error;
+        return false;
+    }
+    profile_set_msb_limit(&program_state->profile, MSB_LIMIT);
+    MsbPartition partition = {
+        .nonce = *n,
+        .sen_siblings = program_state->sen_siblings,
+        .sen_sibling_count = program_state->sen_sibling_count,
+        .sn_siblings = program_state->sn_siblings,
+        .sn_sibling_count = program_state->sn_sibling_count,
+        .cuid_sink = program_state->cuid_sink,
+        .profile = &program_state->profile,
+        .tables =
+            {
+                .odd_msbs = block_pointers[0],
+                .even_msbs = block_pointers[1],
+                .temp_states_odd = block_pointers[2],
+                .temp_states_even = block_pointers[3],
+                .states_buffer = block_pointers[4],
+                .msb_limit = MSB_LIMIT,
+            },
+        .callback = recover_partition_callback,
+        .context = program_state,
+    };
+    int oks, eks;
+    msb_keystream_split(ks2, &oks, &eks);
+    // A resumed nonce restarts at the first round not completed before, the MSB limit
+    // may differ from the interrupted run. The candidates of the skipped rounds still
+    // count for the sibling cross-check.
+    int msb_first = msb_done / MSB_LIMIT;
+    if(msb_first > 0) {
+        partition.num_candidates = program_state->checkpoint.nonce_candidates;
+    }
+    uint32_t bench_start = furi_get_tick();
+    // The device has a single core, one partition covers every remaining round
+    found = recover_msb_range(&partition, oks, eks, in, msb_first, msb_rounds(MSB_LIMIT) - 1);
+    if(found) {
+        n->key = partition.nonce.key;
+    }
+    program_state->num_candidates += partition.num_candidates;
+    // Only full searches are comparable, a hit can end the search in any round
+    if(!found && !program_state->close_thread_please && (msb_first == 0)) {
+        profile_nonce_done(&program_state->profile, n->attack, furi_get_tick() - bench_start);
+    }
     // Free the allocated blocks
     for(int i = 0; i < num_blocks; i++) {
         free(block_pointers[i]);
@@ -523,34 +818,139 @@ bool recover(MfClassicNonce* n, int ks2, unsigned int in, ProgramState* program_
     free(block_pointers);
     return found;
 }
+// Static encrypted nonces for the same UID, sector and key type share one key, so a
+// single recover() run cross-checked against the others covers all of them
+static bool is_static_encrypted_sibling(MfClassicNonce* target, MfClassicNonce* other) {
+    return (other->attack == static_encrypted) && (other->uid == target->uid) &&
+           (other->sector == target->sector) && (other->key_type == target->key_type);
+}
+
+static bool is_duplicate_nonce(MfClassicNonce* target, MfClassicNonce* other) {
+    return (other->nt0 == target->nt0) && (other->ks1_1_enc == target->ks1_1_enc) &&
+           (other->par_1 == target->par_1);
+}
+
+void static_encrypted_siblings_collect(
+    MfClassicNonceArray* nonce_arr,
+    uint32_t index,
+    ProgramState* program_state) {
+    MfClassicNonce* target = &nonce_arr->remaining_nonce_array[index];
+    program_state->sen_siblings = NULL;
+    program_state->sen_sibling_count = 0;
+    for(uint32_t j = index + 1; j < nonce_arr->total_nonces; j++) {
+        MfClassicNonce* other = &nonce_arr->remaining_nonce_array[j];
+        if(!is_static_encrypted_sibling(target, other) || other->covered) continue;
+        other->covered = true;
+        if(is_duplicate_nonce(target, other)) continue;
+        program_state->sen_siblings = realloc( //-V701
+            program_state->sen_siblings,
+            sizeof(MfClassicNonce) * (program_state->sen_sibling_count + 1));
+        program_state->sen_siblings[program_state->sen_sibling_count++] = *other;
+    }
+}
+
+void static_encrypted_siblings_release(MfClassicNonceArray* nonce_arr, uint32_t index) {
+    MfClassicNonce* target = &nonce_arr->remaining_nonce_array[index];
+    for(uint32_t j = index + 1; j < nonce_arr->total_nonces; j++) {
+        MfClassicNonce* other = &nonce_arr->remaining_nonce_array[j];
+        if(is_static_encrypted_sibling(target, other) && !is_duplicate_nonce(target, other)) {
+            other->covered = false;
+        }
+    }
+}
 
 bool key_already_found_for_nonce_in_solved(
     MfClassicKey* keyarray,
     int keyarray_size,
     MfClassicNonce* nonce) {
     for(int k = 0; k < keyarray_size; k++) {
-        uint64_t key_as_int = bit_lib_bytes_to_num_be(keyarray[k].data, sizeof(MfClassicKey));
-        struct Crypto1State temp = {0, 0};
-        for(int i = 0; i < 24; i++) {
-            (&temp)->odd |= (BIT(key_as_int, 2 * i + 1) << (i ^ 3));
-            (&temp)->even |= (BIT(key_as_int, 2 * i) << (i ^ 3));
-        }
-        if(nonce->attack == mfkey32) {
-            crypt_word_noret(&temp, nonce->uid_xor_nt1, 0);
-            crypt_word_noret(&temp, nonce->nr1_enc, 1);
-            if(nonce->ar1_enc == (crypt_word(&temp) ^ nonce->p64b)) {
-                return true;
-            }
-        } else if(nonce->attack == static_nested) {
-            uint32_t expected_ks1 = crypt_word_ret(&temp, nonce->uid_xor_nt0, 0);
-            if(nonce->ks1_1_enc == expected_ks1) {
-                return true;
-            }
+        if(key_matches_nonce(&keyarray[k], nonce)) {
+            return true;
         }
     }
     return false;
 }
 
+// Cheapest attack first (the AttackType order), log order within an attack. A target
+// with both an mfkey32 and a nested capture is then cracked through the mfkey32 one.
+static int nonce_schedule_compare(
+    AttackType attack_a,
+    uint32_t index_a,
+    AttackType attack_b,
+    uint32_t index_b) {
+    if(attack_a != attack_b) return (attack_a < attack_b) ? -1 : 1;
+    if(index_a != index_b) return (index_a < index_b) ? -1 : 1;
+    return 0;
+}
+
+static int nonce_schedule_sort_compare(const void* a, const void* b) {
+    const MfClassicNonce* nonce_a = a;
+    const MfClassicNonce* nonce_b = b;
+    return nonce_schedule_compare(
+        nonce_a->attack, nonce_a->log_index, nonce_b->attack, nonce_b->log_index);
+}
+
+// The same capture logged twice, it fails the same way
+static bool is_repeated_capture(MfClassicNonce* target, MfClassicNonce* other) {
+    if(other->attack != target->attack) return false;
+    if(target->attack == mfkey32) {
+        return (other->uid == target->uid) && (other->nt0 == target->nt0) &&
+               (other->nr0_enc == target->nr0_enc) && (other->ar0_enc == target->ar0_enc) &&
+               (other->nt1 == target->nt1) && (other->nr1_enc == target->nr1_enc) &&
+               (other->ar1_enc == target->ar1_enc);
+    }
+    return (other->uid == target->uid) && is_duplicate_nonce(target, other) &&
+           (other->ks1_2_enc == target->ks1_2_enc) && (other->par_2 == target->par_2);
+}
+
+// Once a nonce is done, the later nonces for the same UID, sector and key type that
+// the found key checks out against are solved, and without a key the repeats of the
+// same capture are left out. None of them reaches recover().
+// The card has a single key per sector and key type, so the nested captures of that
+// sector the key from a nested capture fails on were logged wrong, they are left out
+// without being counted as cracked.
+static void
+    nonce_group_cancel(MfClassicNonceArray* nonce_arr, uint32_t index, MfClassicKey* key) {
+    MfClassicNonce* target = &nonce_arr->remaining_nonce_array[index];
+    for(uint32_t j = index + 1; j < nonce_arr->total_nonces; j++) {
+        MfClassicNonce* other = &nonce_arr->remaining_nonce_array[j];
+        if(other->solved || other->covered || (other->sector != target->sector) ||
+           (other->key_type != target->key_type)) {
+            continue;
+        }
+        if(key == NULL) {
+            other->covered = is_repeated_capture(target, other);
+        } else if(other->uid == target->uid) {
+            other->solved = key_matches_nonce(key, other);
+            other->covered = !other->solved && (target->attack != mfkey32) &&
+                             (other->attack != mfkey32);
+        }
+    }
+}
+
+// Pending static nested nonces for the same UID, sector and key type are verified in
+// the same pass, they stay pending and are solved by nonce_group_cancel() on a hit
+static void static_nested_siblings_collect(
+    MfClassicNonceArray* nonce_arr,
+    uint32_t index,
+    ProgramState* program_state) {
+    MfClassicNonce* target = &nonce_arr->remaining_nonce_array[index];
+    program_state->sn_siblings = NULL;
+    program_state->sn_sibling_count = 0;
+    for(uint32_t j = index + 1; j < nonce_arr->total_nonces; j++) {
+        MfClassicNonce* other = &nonce_arr->remaining_nonce_array[j];
+        if((other->attack != static_nested) || other->solved || other->covered ||
+           (other->uid != target->uid) || (other->sector != target->sector) ||
+           (other->key_type != target->key_type) || is_repeated_capture(target, other)) {
+            continue;
+        }
+        program_state->sn_siblings = realloc( //-V701
+            program_state->sn_siblings,
+            sizeof(MfClassicNonce) * (program_state->sn_sibling_count + 1));
+        program_state->sn_siblings[program_state->sn_sibling_count++] = *other;
+    }
+}
+
 #pragma GCC push_options
 #pragma GCC optimize("Os")
 static void finished_beep() {
@@ -565,7 +965,8 @@ void mfkey(ProgramState* program_state) {
     uint32_t ks_enc = 0, nt_xor_uid = 0;
     MfClassicKey found_key; // Recovered key
     size_t keyarray_size = 0;
-    MfClassicKey* keyarray = malloc(sizeof(MfClassicKey) * 1);
+    size_t keyarray_capacity = 8;
+    MfClassicKey* keyarray = malloc(sizeof(MfClassicKey) * keyarray_capacity);
     uint32_t i = 0, j = 0;
     //FURI_LOG_I(TAG, "Free heap before alloc(): %zub", memmgr_get_free_heap());
     Storage* storage = furi_record_open(RECORD_STORAGE);
@@ -606,8 +1007,10 @@ void mfkey(ProgramState* program_state) {
     program_state->mfkey_state = DictionaryAttack;
     // Read nonces
     MfClassicNonceArray* nonce_arr;
+    uint32_t dict_start = profile_cycles();
     nonce_arr = init_plugin->napi_mf_classic_nonce_array_alloc(
         system_dict, system_dict_exists, user_dict, program_state);
+    profile_add(&program_state->profile, ProfilePhaseDictIo, dict_start);
     if(system_dict_exists) {
         keys_dict_free(system_dict);
     }
@@ -632,53 +1035,150 @@ void mfkey(ProgramState* program_state) {
     stream_free(nonce_arr->stream);
     //FURI_LOG_I(TAG, "Free heap after free(): %zub", memmgr_get_free_heap());
     program_state->mfkey_state = MFKeyAttack;
+    uint32_t sen_standalone = UINT32_MAX;
+    // Pick up an interrupted run on the same nonce logs
+    Checkpoint* checkpoint = &program_state->checkpoint;
+    MfClassicKey* resumed_keys;
+    size_t resumed_key_count;
+    memset(checkpoint, 0, sizeof(Checkpoint));
+    if(checkpoint_load(
+           checkpoint,
+           nonce_arr->log_hash,
+           &resumed_keys,
+           &resumed_key_count,
+           MFKEY_CHECKPOINT_PATH)) {
+        for(j = 0; j < resumed_key_count; j++) {
+            if(keyarray_size == keyarray_capacity) {
+                keyarray_capacity *= 2;
+                keyarray = realloc(keyarray, sizeof(MfClassicKey) * keyarray_capacity); //-V701
+            }
+            keyarray[keyarray_size++] = resumed_keys[j];
+        }
+        free(resumed_keys);
+        program_state->unique_cracked = keyarray_size;
+        program_state->num_candidates = checkpoint->num_candidates;
+    }
+    checkpoint->log_hash = nonce_arr->log_hash;
+    checkpoint->keys = keyarray;
+    checkpoint->key_count = keyarray_size;
+    qsort(
+        nonce_arr->remaining_nonce_array,
+        nonce_arr->total_nonces,
+        sizeof(MfClassicNonce),
+        nonce_schedule_sort_compare);
     // TODO: Work backwards on this array and free memory
     for(i = 0; i < nonce_arr->total_nonces; i++) {
         MfClassicNonce next_nonce = nonce_arr->remaining_nonce_array[i];
+        if(next_nonce.solved) {
+            nonce_arr->remaining_nonces--;
+            (program_state->cracked)++;
+            (program_state->num_completed)++;
+            continue;
+        }
+        if(next_nonce.covered) {
+            nonce_arr->remaining_nonces--;
+            (program_state->num_completed)++;
+            continue;
+        }
         if(key_already_found_for_nonce_in_solved(keyarray, keyarray_size, &next_nonce)) {
             nonce_arr->remaining_nonces--;
             (program_state->cracked)++;
             (program_state->num_completed)++;
             continue;
         }
-        //FURI_LOG_I(TAG, "Beginning recovery for %8lx", next_nonce.uid);
-        FuriString* cuid_dict_path;
-        switch(next_nonce.attack) {
-        case mfkey32:
-            ks_enc = next_nonce.ar0_enc ^ next_nonce.p64;
-            nt_xor_uid = 0;
-            break;
-        case static_nested:
-            ks_enc = next_nonce.ks1_2_enc;
-            nt_xor_uid = next_nonce.uid_xor_nt1;
-            break;
-        case static_encrypted:
-            ks_enc = next_nonce.ks1_1_enc;
-            nt_xor_uid = next_nonce.uid_xor_nt0;
-            cuid_dict_path = furi_string_alloc_printf(
-                "%s/mf_classic_dict_%08lx.nfc", EXT_PATH("nfc/assets"), next_nonce.uid);
-            // May need RECORD_STORAGE?
-            program_state->cuid_dict = keys_dict_alloc(
-                furi_string_get_cstr(cuid_dict_path),
-                KeysDictModeOpenAlways,
-                sizeof(MfClassicKey));
-            break;
+        if(nonce_schedule_compare(
+               next_nonce.attack,
+               next_nonce.log_index,
+               checkpoint->attack,
+               checkpoint->log_index) < 0) {
+            // Searched without a hit before the run was interrupted
+            nonce_arr->remaining_nonces--;
+            (program_state->num_completed)++;
+            continue;
+        }
+        if(next_nonce.log_index == checkpoint->log_index) {
+            if(checkpoint->standalone) {
+                sen_standalone = i;
+            }
+        } else {
+            checkpoint->attack = next_nonce.attack;
+            checkpoint->log_index = next_nonce.log_index;
+            checkpoint->msb_done = 0;
+            checkpoint->standalone = false;
         }
+        bool recovered = false;
+        bool sen_retry;
+        do {
+            sen_retry = false;
+            checkpoint->standalone = (i == sen_standalone);
+            //FURI_LOG_I(TAG, "Beginning recovery for %8lx", next_nonce.uid);
+            FuriString* cuid_dict_path;
+            switch(next_nonce.attack) {
+            case mfkey32:
+                ks_enc = next_nonce.ar0_enc ^ next_nonce.p64;
+                nt_xor_uid = 0;
+                break;
+            case static_nested:
+                ks_enc = next_nonce.ks1_2_enc;
+                nt_xor_uid = next_nonce.uid_xor_nt1;
+                static_nested_siblings_collect(nonce_arr, i, program_state);
+                break;
+            case static_encrypted:
+                ks_enc = next_nonce.ks1_1_enc;
+                nt_xor_uid = next_nonce.uid_xor_nt0;
+                cuid_dict_path = furi_string_alloc_printf(
+                    "%s/mf_classic_dict_%08lx.nfc", EXT_PATH("nfc/assets"), next_nonce.uid);
+                program_state->cuid_sink = key_sink_alloc(furi_string_get_cstr(cuid_dict_path));
+                furi_string_free(cuid_dict_path);
+                if(i != sen_standalone) {
+                    static_encrypted_siblings_collect(nonce_arr, i, program_state);
+                }
+                break;
+            }
 
-        if(!recover(&next_nonce, ks_enc, nt_xor_uid, program_state)) {
-            if((next_nonce.attack == static_encrypted) && (program_state->cuid_dict)) {
-                keys_dict_free(program_state->cuid_dict);
+            int candidates_before = program_state->num_candidates;
+            recovered =
+                recover(&next_nonce, ks_enc, nt_xor_uid, checkpoint->msb_done, program_state);
+            free(program_state->sn_siblings);
+            program_state->sn_siblings = NULL;
+            program_state->sn_sibling_count = 0;
+            if((next_nonce.attack == static_encrypted) && (program_state->cuid_sink)) {
+                dict_start = profile_cycles();
+                key_sink_free(program_state->cuid_sink);
+                program_state->cuid_sink = NULL;
+                profile_add(&program_state->profile, ProfilePhaseDictIo, dict_start);
+                bool inconsistent = (program_state->sen_sibling_count > 0) &&
+                                    (program_state->num_candidates == candidates_before) &&
+                                    !program_state->close_thread_please;
+                free(program_state->sen_siblings);
+                program_state->sen_siblings = NULL;
+                program_state->sen_sibling_count = 0;
+                if(inconsistent) {
+                    // No candidate satisfies every capture, crack each nonce on its own
+                    static_encrypted_siblings_release(nonce_arr, i);
+                    sen_standalone = i;
+                    checkpoint->msb_done = 0;
+                    sen_retry = true;
+                }
             }
+        } while(sen_retry);
+        if(!recovered) {
             if(program_state->close_thread_please) {
                 break;
             }
             // No key found in recover() or static encrypted
             (program_state->num_completed)++;
+            nonce_group_cancel(nonce_arr, i, NULL);
+            checkpoint->log_index = next_nonce.log_index + 1;
+            checkpoint->msb_done = 0;
+            checkpoint->standalone = false;
+            checkpoint_update(program_state, 0);
             continue;
         }
         (program_state->cracked)++;
         (program_state->num_completed)++;
         found_key = next_nonce.key;
+        nonce_group_cancel(nonce_arr, i, &found_key);
         bool already_found = false;
         for(j = 0; j < keyarray_size; j++) {
             if(memcmp(keyarray[j].data, found_key.data, MF_CLASSIC_KEY_SIZE) == 0) {
@@ -688,24 +1188,54 @@ void mfkey(ProgramState* program_state) {
         }
         if(already_found == false) {
             // New key
-            keyarray = realloc(keyarray, sizeof(MfClassicKey) * (keyarray_size + 1)); //-V701
-            keyarray_size += 1;
-            keyarray[keyarray_size - 1] = found_key;
+            if(keyarray_size == keyarray_capacity) {
+                keyarray_capacity *= 2;
+                keyarray = realloc(keyarray, sizeof(MfClassicKey) * keyarray_capacity); //-V701
+            }
+            keyarray[keyarray_size++] = found_key;
             (program_state->unique_cracked)++;
         }
+        checkpoint->log_index = next_nonce.log_index + 1;
+        checkpoint->msb_done = 0;
+        checkpoint->standalone = false;
+        checkpoint->keys = keyarray;
+        checkpoint->key_count = keyarray_size;
+        checkpoint_update(program_state, 0);
+    }
+    // A run that went through every nonce has nothing left to resume
+    if(!program_state->close_thread_please) {
+        checkpoint_remove(MFKEY_CHECKPOINT_PATH);
     }
     // TODO: Update display to show all keys were found
     // TODO: Prepend found key(s) to user dictionary file
     //FURI_LOG_I(TAG, "Unique keys found:");
+    dict_start = profile_cycles();
+    // Resumed keys may have been added when the interrupted run was closed
+    size_t new_key_count = 0;
     for(i = 0; i < keyarray_size; i++) {
         //FURI_LOG_I(TAG, "%012" PRIx64, keyarray[i]);
-        keys_dict_add_key(user_dict, keyarray[i].data, sizeof(MfClassicKey));
+        if((i < resumed_key_count) &&
+           keys_dict_is_key_present(user_dict, keyarray[i].data, sizeof(MfClassicKey))) {
+            continue;
+        }
+        keyarray[new_key_count++] = keyarray[i];
     }
+    // The sink opens the user dictionary itself
+    keys_dict_free(user_dict);
+    KeySink* user_sink = key_sink_alloc(KEYS_DICT_USER_PATH);
+    for(i = 0; i < new_key_count; i++) {
+        key_sink_add(user_sink, &keyarray[i]);
+    }
+    key_sink_free(user_sink);
+    profile_add(&program_state->profile, ProfilePhaseDictIo, dict_start);
+#ifdef MFKEY_PROFILE
+    profile_dump(&program_state->profile, MFKEY_PROFILE_PATH);
+#endif
     if(keyarray_size > 0) {
         dolphin_deed(DolphinDeedNfcMfcAdd);
     }
+    free(nonce_arr->remaining_nonce_array);
     free(nonce_arr);
-    keys_dict_free(user_dict);
     free(keyarray);
     if(program_state->mfkey_state == Error) {
         return;
@@ -734,15 +1264,17 @@ static void render_callback(Canvas* const canvas, void* ctx) {
     canvas_draw_str_aligned(canvas, 48, 5, AlignLeft, AlignTop, draw_str);
     canvas_draw_icon(canvas, 114, 4, &I_mfkey);
     if(program_state->mfkey_state == MFKeyAttack) {
-        float eta_round = (float)1 - ((float)program_state->eta_round / (float)eta_round_time);
-        float eta_total = (float)1 - ((float)program_state->eta_total / (float)eta_total_time);
+        float eta_round = (float)1 - ((float)program_state->eta_round * 1000 /
+                                      (float)MAX(program_state->eta_round_ms, 1u));
+        float eta_total = (float)1 - ((float)program_state->eta_total * 1000 /
+                                      (float)MAX(program_state->eta_span_ms, 1u));
         float progress = (float)program_state->num_completed / (float)program_state->total;
         if(eta_round < 0 || eta_round > 1) {
             // Round ETA miscalculated
             eta_round = 1;
             program_state->eta_round = 0;
         }
-        if(eta_total < 0 || eta_round > 1) {
+        if(eta_total < 0 || eta_total > 1) {
             // Total ETA miscalculated
             eta_total = 1;
             program_state->eta_total = 0;
@@ -759,7 +1291,7 @@ static void render_callback(Canvas* const canvas, void* ctx) {
             sizeof(draw_str),
             "Round: %d/%d - ETA %02d Sec",
             (program_state->search) + 1, // Zero indexed
-            256 / MSB_LIMIT,
+            msb_rounds(MSB_LIMIT),
             program_state->eta_round);
         elements_progress_bar_with_text(canvas, 5, 31, 118, eta_round, draw_str);
         snprintf(draw_str, sizeof(draw_str), "Total ETA %03d Sec", program_state->eta_total);
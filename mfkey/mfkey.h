@@ -12,11 +12,23 @@
 struct Crypto1State {
     uint32_t odd, even;
 };
+#define MSB_BUCKET_CAPACITY 768
+
 struct Msb {
     int tail;
-    uint32_t states[768];
+    uint32_t states[MSB_BUCKET_CAPACITY];
 };
 
+// Working memory for one MSB partition
+typedef struct {
+    struct Msb* odd_msbs;
+    struct Msb* even_msbs;
+    unsigned int* temp_states_odd;
+    unsigned int* temp_states_even;
+    unsigned int* states_buffer;
+    int msb_limit; // MSB values covered per round (out of 256)
+} MsbTables;
+
 typedef enum {
     MissingNonces,
     ZeroNonces,
@@ -33,27 +45,17 @@ typedef enum {
     Help,
 } MFKeyState;
 
-// TODO: Can we eliminate any of the members of this struct?
+#define KEY_SINK_CHUNK_SIZE 64
+
+// Buffers keys headed for a dictionary file and appends them one chunk at a time
 typedef struct {
-    FuriMutex* mutex;
-    MFKeyError err;
-    MFKeyState mfkey_state;
-    int cracked;
-    int unique_cracked;
-    int num_completed;
-    int num_candidates;
-    int total;
-    int dict_count;
-    int search;
-    int eta_timestamp;
-    int eta_total;
-    int eta_round;
-    bool mfkey32_present;
-    bool nested_present;
-    bool close_thread_please;
-    FuriThread* mfkeythread;
-    KeysDict* cuid_dict;
-} ProgramState;
+    Stream* stream;
+    MfClassicKey keys[KEY_SINK_CHUNK_SIZE];
+    size_t count; // Keys waiting in the current chunk
+    size_t total_keys; // Keys accepted since alloc
+    size_t bytes_written;
+    size_t writes;
+} KeySink;
 
 typedef enum {
     mfkey32,
@@ -63,6 +65,11 @@ typedef enum {
 
 typedef struct {
     AttackType attack;
+    uint8_t sector; // target sector
+    MfClassicKeyType key_type; // target key
+    bool covered; // handled through another nonce for the same key
+    bool solved; // key confirmed by another nonce for the same target
+    uint32_t log_index; // position in the nonce logs, before dictionary filtering
     MfClassicKey key; // key
     uint32_t uid; // serial number
     uint32_t nt0; // tag challenge first
@@ -78,6 +85,8 @@ typedef struct {
             uint32_t ar0_enc; // first encrypted reader response
             uint32_t nr1_enc; // second encrypted reader challenge
             uint32_t ar1_enc; // second encrypted reader response
+            uint8_t par0; // first encrypted nr and ar parity bits, nr bytes in bits 7-4
+            bool par_present; // parity bits were logged
         };
         // Nested
         struct {
@@ -96,13 +105,107 @@ typedef struct {
     uint32_t total_nonces;
     MfClassicNonce* remaining_nonce_array;
     size_t remaining_nonces;
+    uint32_t log_nonces; // Nonces read from the logs, including those with a known key
+    uint32_t log_hash; // FNV-1a over every nonce read from the logs
 } MfClassicNonceArray;
 
-struct KeysDict {
-    Stream* stream;
-    size_t key_size;
-    size_t key_size_symbols;
-    size_t total_keys;
+typedef enum {
+    ProfilePhaseTables, // MSB bucket fill
+    ProfilePhaseSort,
+    ProfilePhaseExtend,
+    ProfilePhaseRecover, // old_recover(), includes sort and extend
+    ProfilePhaseDictIo, // Dictionary checks and key writes
+    ProfilePhaseCount,
+} ProfilePhase;
+
+#define PROFILE_ATTACK_TYPES (static_encrypted + 1)
+
+typedef struct {
+    uint64_t phase_cycles[ProfilePhaseCount];
+    uint32_t phase_calls[ProfilePhaseCount];
+    // Moving averages in ms, indexed by AttackType, 0 until measured
+    uint32_t round_ms[PROFILE_ATTACK_TYPES];
+    uint32_t nonce_ms[PROFILE_ATTACK_TYPES];
+    uint32_t rounds[PROFILE_ATTACK_TYPES];
+    uint32_t nonces[PROFILE_ATTACK_TYPES];
+    int msb_limit; // Averages only hold for one MSB_LIMIT
+} Profile;
+
+typedef struct MsbPartition MsbPartition;
+
+typedef enum {
+    MsbPartitionRoundStart,
+    MsbPartitionRoundDone,
+    MsbPartitionPoll, // Every 32768 semi-states
+} MsbPartitionEvent;
+
+// Returns true to stop the partition
+typedef bool (
+    *MsbPartitionCallback)(MsbPartition* partition, MsbPartitionEvent event, void* context);
+
+// Everything a search over a range of MSB rounds writes to. The sibling arrays are only
+// read while it runs, so partitions with their own tables, sink and profile can be
+// searched on separate threads.
+struct MsbPartition {
+    MfClassicNonce nonce; // Own copy, check_state() stores the key in it
+    const MfClassicNonce* sen_siblings;
+    int sen_sibling_count;
+    const MfClassicNonce* sn_siblings;
+    int sn_sibling_count;
+    KeySink* cuid_sink; // Static encrypted candidates
+    int num_candidates; // Static encrypted candidates found in this partition
+    Profile* profile;
+    MsbTables tables;
+    int msb_round; // Round in progress
+    uint32_t start_tick; // Tick the range started at
+    uint32_t round_tick; // Tick the current round started at
+    bool stopped; // The callback asked to stop
+    MsbPartitionCallback callback;
+    void* context;
 };
 
+// Progress of the current run, saved after every MSB round and every finished nonce
+typedef struct {
+    uint32_t log_hash; // Nonce logs the run was started on
+    AttackType attack; // Nonce in progress, every nonce scheduled before it is done
+    uint32_t log_index;
+    uint32_t msb_done; // MSBs of that nonce already searched
+    int num_candidates; // Static encrypted candidates of the finished nonces
+    int nonce_candidates; // Candidates the searched MSBs of the nonce in progress gave
+    bool standalone; // Static encrypted nonce re-run without its siblings
+    const MfClassicKey* keys; // Keys found so far
+    size_t key_count;
+} Checkpoint;
+
+// TODO: Can we eliminate any of the members of this struct?
+typedef struct {
+    FuriMutex* mutex;
+    MFKeyError err;
+    MFKeyState mfkey_state;
+    int cracked;
+    int unique_cracked;
+    int num_completed;
+    int num_candidates;
+    int total;
+    int dict_count;
+    int search;
+    uint32_t eta_timestamp; // Tick the current round started at
+    uint32_t eta_round_ms; // Estimated length of the current round
+    uint32_t eta_total_ms; // Estimated time left in this nonce when the round started
+    uint32_t eta_span_ms; // Estimated length of the whole nonce
+    int eta_total;
+    int eta_round;
+    bool mfkey32_present;
+    bool nested_present;
+    bool close_thread_please;
+    FuriThread* mfkeythread;
+    KeySink* cuid_sink;
+    MfClassicNonce* sen_siblings; // Other static encrypted nonces for the current key
+    int sen_sibling_count;
+    MfClassicNonce* sn_siblings; // Other static nested nonces for the current key
+    int sn_sibling_count;
+    Profile profile;
+    Checkpoint checkpoint;
+} ProgramState;
+
 #endif // MFKEY_H
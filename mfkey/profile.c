@@ -0,0 +1,98 @@
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <toolbox/stream/file_stream.h>
+#include "profile.h"
+
+#define TAG "MFKey"
+
+// Full speed round length measured on a stock Flipper, used until a round completes
+#define PROFILE_SEED_ROUND_MS 44000
+
+// Exponential moving average, weight 1/4 on the newest sample
+static uint32_t profile_average(uint32_t average, uint32_t sample) {
+    if(average == 0) return sample;
+    return (uint32_t)(((uint64_t)average * 3 + sample) / 4);
+}
+
+void profile_set_msb_limit(Profile* profile, int msb_limit) {
+    if(profile->msb_limit == msb_limit) return;
+    memset(profile->round_ms, 0, sizeof(profile->round_ms));
+    memset(profile->nonce_ms, 0, sizeof(profile->nonce_ms));
+    profile->msb_limit = msb_limit;
+}
+
+uint32_t profile_round_estimate(Profile* profile, AttackType attack) {
+    if(profile->round_ms[attack] > 0) {
+        return profile->round_ms[attack];
+    }
+    uint32_t estimate = PROFILE_SEED_ROUND_MS;
+    if(attack == static_encrypted) {
+        // Every candidate is checked against parity and written out
+        estimate *= (profile->msb_limit == 16) ? 16 : 4;
+    }
+    return estimate;
+}
+
+void profile_round_done(Profile* profile, AttackType attack, uint32_t ms) {
+    profile->round_ms[attack] = profile_average(profile->round_ms[attack], ms);
+    profile->rounds[attack]++;
+}
+
+void profile_nonce_done(Profile* profile, AttackType attack, uint32_t ms) {
+    profile->nonce_ms[attack] = profile_average(profile->nonce_ms[attack], ms);
+    profile->nonces[attack]++;
+}
+
+#ifdef MFKEY_PROFILE
+static const char* const profile_phase_names[ProfilePhaseCount] = {
+    "tables",
+    "sort",
+    "extend",
+    "recover",
+    "dict_io",
+};
+
+static const char* const profile_attack_names[PROFILE_ATTACK_TYPES] = {
+    "mfkey32",
+    "static_nested",
+    "static_encrypted",
+};
+
+bool profile_dump(Profile* profile, const char* path) {
+    uint32_t cycles_per_ms = furi_hal_cortex_instructions_per_microsecond() * 1000;
+    FuriString* text = furi_string_alloc_printf("msb_limit %d\n", profile->msb_limit);
+    for(int i = 0; i < ProfilePhaseCount; i++) {
+        furi_string_cat_printf(
+            text,
+            "phase %s %lu ms %lu calls\n",
+            profile_phase_names[i],
+            (uint32_t)(profile->phase_cycles[i] / cycles_per_ms),
+            profile->phase_calls[i]);
+    }
+    for(int i = 0; i < PROFILE_ATTACK_TYPES; i++) {
+        if(profile->nonces[i] == 0) continue;
+        furi_string_cat_printf(
+            text,
+            "attack %s round %lu ms (%lu rounds) nonce %lu ms (%lu nonces)\n",
+            profile_attack_names[i],
+            profile->round_ms[i],
+            profile->rounds[i],
+            profile->nonce_ms[i],
+            profile->nonces[i]);
+    }
+    FURI_LOG_D(TAG, "Profile:\n%s", furi_string_get_cstr(text));
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* stream = file_stream_alloc(storage);
+    bool saved = false;
+    if(file_stream_open(stream, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        saved = stream_write_string(stream, text) == furi_string_size(text);
+    }
+    file_stream_close(stream);
+    stream_free(stream);
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(text);
+    return saved;
+}
+#endif
@@ -0,0 +1,43 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <furi_hal.h>
+#include "mfkey.h"
+
+// Phase timing and the profile log are debug only, build with
+// cdefines=["MFKEY_PROFILE"] in application.fam to get them
+#ifdef MFKEY_PROFILE
+#include <stm32wbxx.h>
+
+// Core cycle counter, furi_hal_cortex_init() has already enabled it
+static inline uint32_t profile_cycles(void) {
+    return DWT->CYCCNT;
+}
+
+static inline void profile_add(Profile* profile, ProfilePhase phase, uint32_t start) {
+    profile->phase_cycles[phase] += (uint32_t)(profile_cycles() - start);
+    profile->phase_calls[phase]++;
+}
+#else
+static inline uint32_t profile_cycles(void) {
+    return 0;
+}
+
+static inline void profile_add(Profile* profile, ProfilePhase phase, uint32_t start) {
+    UNUSED(profile);
+    UNUSED(phase);
+    UNUSED(start);
+}
+#endif
+
+// Drops the averages if the MSB round size changed
+void profile_set_msb_limit(Profile* profile, int msb_limit);
+// Measured average round length, or the built-in estimate until one round has completed
+uint32_t profile_round_estimate(Profile* profile, AttackType attack);
+void profile_round_done(Profile* profile, AttackType attack, uint32_t ms);
+void profile_nonce_done(Profile* profile, AttackType attack, uint32_t ms);
+#ifdef MFKEY_PROFILE
+bool profile_dump(Profile* profile, const char* path);
+#endif
+
+#endif // PROFILE_H
@@ -0,0 +1,221 @@
+// Writes the nonce logs in vectors/ from known keys, run by "make vectors"
+//
+// Every case is a directory laid out like the nfc folder of the SD card. The keys
+// below are the ones mfkey_test.c expects to recover.
+
+#include <furi.h>
+#include <sys/stat.h>
+
+#include "../mfkey.h"
+#include "../crypto1.h"
+
+#define VECTORS_DIR "vectors/"
+
+typedef enum {
+    VectorMfkey32,
+    VectorMfkey32Parity, // Mfkey32 with the par0 field of the reader nonce and answer
+    VectorStaticNested,
+    VectorStaticEncrypted,
+    VectorDictKey, // Key only written to the system dictionary
+} VectorType;
+
+typedef struct {
+    VectorType type;
+    uint8_t sector;
+    uint64_t key;
+} VectorNonce;
+
+typedef struct {
+    const char* name;
+    VectorNonce nonces[4];
+    size_t count;
+} VectorCase;
+
+static const VectorCase vector_cases[] = {
+    {"mfkey32",
+     {{VectorMfkey32, 1, 0xA0A1A2A3A4A5}, {VectorMfkey32, 2, 0x123456789ABC}},
+     2},
+    {"mfkey32_parity", {{VectorMfkey32Parity, 3, 0xFFEEDDCCBBAA}}, 1},
+    {"static_nested", {{VectorStaticNested, 4, 0x4D3A99C351DD}}, 1},
+    {"static_encrypted", {{VectorStaticEncrypted, 5, 0x1A982C7E459A}}, 1},
+    // Two captures of the same key, only candidates that check out against both are kept
+    {"static_encrypted_siblings",
+     {{VectorStaticEncrypted, 8, 0x5E7A11C0FFEE}, {VectorStaticEncrypted, 8, 0x5E7A11C0FFEE}},
+     2},
+    // The first nonce is solved by the dictionary before the attack
+    {"dictionary",
+     {{VectorDictKey, 6, 0xB0B1B2B3B4B5},
+      {VectorMfkey32, 6, 0xB0B1B2B3B4B5},
+      {VectorMfkey32, 7, 0xC0C1C2C3C4C5}},
+     3},
+    // Two captures of the same key and one that doesn't check out against it
+    {"nested_siblings",
+     {{VectorStaticNested, 7, 0x0123456789AB},
+      {VectorStaticNested, 7, 0x0123456789AB},
+      {VectorStaticNested, 7, 0xABCDEF012345}},
+     3},
+};
+
+#define VECTOR_UID 0x11223344
+
+static struct Crypto1State key_to_state(uint64_t key) {
+    struct Crypto1State state = {0, 0};
+    for(int i = 0; i < 24; i++) {
+        state.odd |= (BIT(key, 2 * i + 1) << (i ^ 3));
+        state.even |= (BIT(key, 2 * i) << (i ^ 3));
+    }
+    return state;
+}
+
+// Encrypted reader nonce and answer of one authentication
+static void gen_reader_auth(
+    uint64_t key,
+    uint32_t nt,
+    uint32_t nr,
+    uint32_t* nr_enc,
+    uint32_t* ar_enc) {
+    struct Crypto1State state = key_to_state(key);
+    crypt_word_noret(&state, VECTOR_UID ^ nt, 0);
+    *nr_enc = nr ^ crypt_word_ret(&state, nr, 0);
+    *ar_enc = prng_successor(nt, 64) ^ crypt_word(&state);
+}
+
+// Parity bits sent with the encrypted reader nonce and answer, nr bytes in bits 7-4
+static uint8_t gen_reader_par(uint64_t key, uint32_t nt, uint32_t nr) {
+    struct Crypto1State state = key_to_state(key);
+    crypt_word_noret(&state, VECTOR_UID ^ nt, 0);
+    uint32_t words[2] = {nr, prng_successor(nt, 64)};
+    uint8_t par = 0;
+    for(int w = 0; w < 2; w++) {
+        for(int i = 0; i < 32; i++) {
+            crypt_bit(&state, (w == 0) ? BEBIT(nr, i) : 0, 0);
+            if(i % 8 == 7) {
+                uint8_t byte = words[w] >> (8 * (3 - i / 8));
+                par = (par << 1) | (filter(state.odd) ^ !__builtin_parity(byte));
+            }
+        }
+    }
+    return par;
+}
+
+// Encrypted tag nonce of a nested authentication and its parity bits
+static uint32_t gen_nested_auth(uint64_t key, uint32_t nt, uint8_t* par) {
+    struct Crypto1State state = key_to_state(key);
+    return crypt_word_par(&state, VECTOR_UID ^ nt, 0, nt, par);
+}
+
+static void gen_bits(char* str, uint8_t bits, int count) {
+    for(int i = 0; i < count; i++) {
+        str[i] = ((bits >> (count - 1 - i)) & 1) ? '1' : '0';
+    }
+    str[count] = '\0';
+}
+
+static FILE* gen_open(const char* name, const char* file, FILE** handle) {
+    if(!*handle) {
+        char path[128];
+        snprintf(path, sizeof(path), VECTORS_DIR "%s/nfc/%s", name, file);
+        *handle = fopen(path, "w");
+        if(!*handle) {
+            perror(path);
+            exit(1);
+        }
+    }
+    return *handle;
+}
+
+static void gen_case(const VectorCase* vector) {
+    char path[128];
+    snprintf(path, sizeof(path), VECTORS_DIR "%s", vector->name);
+    mkdir(path, 0777);
+    snprintf(path, sizeof(path), VECTORS_DIR "%s/nfc", vector->name);
+    mkdir(path, 0777);
+    snprintf(path, sizeof(path), VECTORS_DIR "%s/nfc/assets", vector->name);
+    mkdir(path, 0777);
+
+    FILE* mfkey32_log = NULL;
+    FILE* nested_log = NULL;
+    FILE* system_dict = NULL;
+    for(size_t i = 0; i < vector->count; i++) {
+        const VectorNonce* nonce = &vector->nonces[i];
+        uint32_t nt0 = 0x01200145 + (i + 1) * 7919;
+        uint32_t nt1 = 0xCAFEBABE ^ ((i + 1) * 104729);
+        uint32_t nr0 = 0x12345678 + i;
+        uint32_t nr1 = 0x87654321 - i;
+        uint32_t nr0_enc, ar0_enc, nr1_enc, ar1_enc, ks0, ks1;
+        uint8_t par0, par1;
+        char par0_str[9], par1_str[9];
+
+        switch(nonce->type) {
+        case VectorMfkey32:
+        case VectorMfkey32Parity:
+            gen_reader_auth(nonce->key, nt0, nr0, &nr0_enc, &ar0_enc);
+            gen_reader_auth(nonce->key, nt1, nr1, &nr1_enc, &ar1_enc);
+            fprintf(
+                gen_open(vector->name, ".mfkey32.log", &mfkey32_log),
+                "Sec %d key A cuid %08x nt0 %08x nr0 %08x ar0 %08x nt1 %08x nr1 %08x ar1 %08x",
+                nonce->sector,
+                VECTOR_UID,
+                nt0,
+                nr0_enc,
+                ar0_enc,
+                nt1,
+                nr1_enc,
+                ar1_enc);
+            if(nonce->type == VectorMfkey32Parity) {
+                gen_bits(par0_str, gen_reader_par(nonce->key, nt0, nr0), 8);
+                fprintf(mfkey32_log, " par0 %s", par0_str);
+            }
+            fprintf(mfkey32_log, "\n");
+            break;
+        case VectorStaticNested:
+            ks0 = gen_nested_auth(nonce->key, nt0, &par0);
+            ks1 = gen_nested_auth(nonce->key, nt1, &par1);
+            gen_bits(par0_str, par0, 4);
+            gen_bits(par1_str, par1, 4);
+            fprintf(
+                gen_open(vector->name, ".nested.log", &nested_log),
+                "Sec %d key A cuid %08x nt0 %08x ks0 %08x par0 %s nt1 %08x ks1 %08x par1 %s "
+                "dist 0\n",
+                nonce->sector,
+                VECTOR_UID,
+                nt0,
+                ks0,
+                par0_str,
+                nt1,
+                ks1,
+                par1_str);
+            break;
+        case VectorStaticEncrypted:
+            ks0 = gen_nested_auth(nonce->key, nt0, &par0);
+            gen_bits(par0_str, par0, 4);
+            fprintf(
+                gen_open(vector->name, ".nested.log", &nested_log),
+                "Sec %d key A cuid %08x nt0 %08x ks0 %08x par0 %s dist 0\n",
+                nonce->sector,
+                VECTOR_UID,
+                nt0,
+                ks0,
+                par0_str);
+            break;
+        case VectorDictKey:
+            fprintf(
+                gen_open(vector->name, "assets/mf_classic_dict.nfc", &system_dict),
+                "%012" PRIX64 "\n",
+                nonce->key);
+            break;
+        }
+    }
+
+    if(mfkey32_log) fclose(mfkey32_log);
+    if(nested_log) fclose(nested_log);
+    if(system_dict) fclose(system_dict);
+}
+
+int main(void) {
+    mkdir(VECTORS_DIR, 0777);
+    for(size_t i = 0; i < COUNT_OF(vector_cases); i++) {
+        gen_case(&vector_cases[i]);
+    }
+    return 0;
+}
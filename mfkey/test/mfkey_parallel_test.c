@@ -0,0 +1,314 @@
+// Host cracker that spreads the MSB rounds of every nonce in vectors/ over a pool of
+// threads, one MsbPartition each, and checks it against recover() on a single partition
+//
+//   ./mfkey_parallel_test [threads]
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <time.h>
+
+#include "../mfkey.c"
+
+#define PARALLEL_THREADS_DEFAULT 4
+#define PARALLEL_THREADS_MAX     32
+
+static const char* const parallel_vectors[] = {
+    "mfkey32",
+    "mfkey32_parity",
+    "static_nested",
+    "static_encrypted",
+    "static_encrypted_siblings",
+    "nested_siblings",
+};
+
+// Shared by the workers of one nonce, only the round counter and the lowest round with
+// a key are written while they run
+typedef struct {
+    int oks;
+    int eks;
+    unsigned int in;
+    int rounds;
+    atomic_int next_round;
+    atomic_int found_round;
+    pthread_mutex_t lock;
+    MfClassicKey key;
+} ParallelRun;
+
+typedef struct {
+    ParallelRun* run;
+    MsbPartition partition;
+    Profile profile;
+    void** blocks;
+    char sink_path[300];
+} ParallelWorker;
+
+const FlipperAppPluginDescriptor* init_plugin_ep(void);
+
+static uint32_t parallel_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// Rounds after the lowest one that found the key can't change the result
+static bool parallel_callback(MsbPartition* partition, MsbPartitionEvent event, void* context) {
+    UNUSED(event);
+    ParallelRun* run = context;
+    return partition->msb_round > atomic_load(&run->found_round);
+}
+
+static void* parallel_worker(void* context) {
+    ParallelWorker* worker = context;
+    ParallelRun* run = worker->run;
+    for(;;) {
+        int msb = atomic_fetch_add(&run->next_round, 1);
+        if((msb >= run->rounds) || (msb > atomic_load(&run->found_round))) break;
+        if(recover_msb_range(&worker->partition, run->oks, run->eks, run->in, msb, msb)) {
+            pthread_mutex_lock(&run->lock);
+            if(msb < atomic_load(&run->found_round)) {
+                run->key = worker->partition.nonce.key;
+                atomic_store(&run->found_round, msb);
+            }
+            pthread_mutex_unlock(&run->lock);
+            break;
+        }
+        if(worker->partition.stopped) break;
+    }
+    return NULL;
+}
+
+// Static encrypted candidates of a sink file, sorted, returns the count
+static size_t parallel_read_keys(const char* path, uint64_t** keys, size_t count) {
+    FILE* file = fopen(path, "r");
+    if(!file) return count;
+    char line[64];
+    while(fgets(line, sizeof(line), file)) {
+        *keys = realloc(*keys, sizeof(uint64_t) * (count + 1));
+        (*keys)[count++] = strtoull(line, NULL, 16);
+    }
+    fclose(file);
+    return count;
+}
+
+static int parallel_key_compare(const void* a, const void* b) {
+    uint64_t key_a = *(const uint64_t*)a;
+    uint64_t key_b = *(const uint64_t*)b;
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+static bool parallel_crack(
+    MfClassicNonce* nonce,
+    int ks_enc,
+    unsigned int nt_xor_uid,
+    ProgramState* program_state,
+    int threads,
+    MfClassicKey* key,
+    const char* sink_prefix) {
+    ParallelRun run = {.in = nt_xor_uid};
+    msb_keystream_split(ks_enc, &run.oks, &run.eks);
+    atomic_init(&run.next_round, 0);
+    atomic_init(&run.found_round, INT_MAX);
+    pthread_mutex_init(&run.lock, NULL);
+
+    ParallelWorker* workers = calloc(threads, sizeof(ParallelWorker));
+    pthread_t handles[PARALLEL_THREADS_MAX];
+    for(int i = 0; i < threads; i++) {
+        ParallelWorker* worker = &workers[i];
+        int msb_limit;
+        worker->blocks = allocate_msb_tables(&msb_limit);
+        furi_check(worker->blocks);
+        run.rounds = msb_rounds(msb_limit);
+        snprintf(worker->sink_path, sizeof(worker->sink_path), "%s_%d.nfc", sink_prefix, i);
+        worker->run = &run;
+        worker->partition = (MsbPartition){
+            .nonce = *nonce,
+            .sen_siblings = program_state->sen_siblings,
+            .sen_sibling_count = program_state->sen_sibling_count,
+            .sn_siblings = program_state->sn_siblings,
+            .sn_sibling_count = program_state->sn_sibling_count,
+            .cuid_sink = key_sink_alloc(worker->sink_path),
+            .profile = &worker->profile,
+            .tables =
+                {
+                    .odd_msbs = worker->blocks[0],
+                    .even_msbs = worker->blocks[1],
+                    .temp_states_odd = worker->blocks[2],
+                    .temp_states_even = worker->blocks[3],
+                    .states_buffer = worker->blocks[4],
+                    .msb_limit = msb_limit,
+                },
+            .callback = parallel_callback,
+            .context = &run,
+        };
+    }
+    for(int i = 0; i < threads; i++) {
+        pthread_create(&handles[i], NULL, parallel_worker, &workers[i]);
+    }
+    for(int i = 0; i < threads; i++) {
+        pthread_join(handles[i], NULL);
+        key_sink_free(workers[i].partition.cuid_sink);
+        for(int j = 0; j < 5; j++) {
+            free(workers[i].blocks[j]);
+        }
+        free(workers[i].blocks);
+    }
+    free(workers);
+    pthread_mutex_destroy(&run.lock);
+
+    *key = run.key;
+    return atomic_load(&run.found_round) != INT_MAX;
+}
+
+static bool parallel_test_vector(const char* name, int threads) {
+    char command[512];
+    snprintf(
+        command,
+        sizeof(command),
+        "rm -rf %s && mkdir -p %snfc/assets && cp -r vectors/%s/. %s",
+        MFKEY_TEST_EXT,
+        MFKEY_TEST_EXT,
+        name,
+        MFKEY_TEST_EXT);
+    if(system(command) != 0) {
+        printf("FAIL %s: can't set up %s\n", name, MFKEY_TEST_EXT);
+        return false;
+    }
+
+    ProgramState* program_state = malloc(sizeof(ProgramState));
+    const MfkeyPlugin* plugin = init_plugin_ep()->entry_point;
+    program_state->mfkey32_present = plugin->napi_mf_classic_mfkey32_nonces_check_presence();
+    program_state->nested_present = plugin->napi_mf_classic_nested_nonces_check_presence();
+    KeysDict* user_dict =
+        keys_dict_alloc(KEYS_DICT_USER_PATH, KeysDictModeOpenAlways, sizeof(MfClassicKey));
+    MfClassicNonceArray* nonce_arr =
+        plugin->napi_mf_classic_nonce_array_alloc(NULL, false, user_dict, program_state);
+    keys_dict_free(user_dict);
+
+    bool passed = true;
+    uint32_t serial_ms = 0, parallel_ms_total = 0;
+    int cracked = 0, candidates = 0;
+    for(uint32_t i = 0; passed && (i < nonce_arr->total_nonces); i++) {
+        MfClassicNonce nonce = nonce_arr->remaining_nonce_array[i];
+        if(nonce.covered) continue;
+        int ks_enc = 0;
+        unsigned int nt_xor_uid = 0;
+        switch(nonce.attack) {
+        case mfkey32:
+            ks_enc = nonce.ar0_enc ^ nonce.p64;
+            break;
+        case static_nested:
+            ks_enc = nonce.ks1_2_enc;
+            nt_xor_uid = nonce.uid_xor_nt1;
+            static_nested_siblings_collect(nonce_arr, i, program_state);
+            break;
+        case static_encrypted:
+            ks_enc = nonce.ks1_1_enc;
+            nt_xor_uid = nonce.uid_xor_nt0;
+            static_encrypted_siblings_collect(nonce_arr, i, program_state);
+            break;
+        }
+
+        // The device path, every round on one partition
+        char serial_sink[256];
+        snprintf(
+            serial_sink, sizeof(serial_sink), "%sserial_%" PRIu32 ".nfc", MFKEY_TEST_EXT, i);
+        program_state->cuid_sink = key_sink_alloc(serial_sink);
+        program_state->num_candidates = 0;
+        MfClassicNonce serial_nonce = nonce;
+        uint32_t start = parallel_ms();
+        bool serial_found = recover(&serial_nonce, ks_enc, nt_xor_uid, 0, program_state);
+        serial_ms += parallel_ms() - start;
+        key_sink_free(program_state->cuid_sink);
+        program_state->cuid_sink = NULL;
+
+        char parallel_prefix[256];
+        snprintf(
+            parallel_prefix, sizeof(parallel_prefix), "%sparallel_%" PRIu32, MFKEY_TEST_EXT, i);
+        MfClassicKey parallel_key = {0};
+        start = parallel_ms();
+        bool parallel_found = parallel_crack(
+            &nonce, ks_enc, nt_xor_uid, program_state, threads, &parallel_key, parallel_prefix);
+        parallel_ms_total += parallel_ms() - start;
+
+        uint64_t* serial_keys = NULL;
+        uint64_t* parallel_keys = NULL;
+        size_t serial_count = parallel_read_keys(serial_sink, &serial_keys, 0);
+        size_t parallel_count = 0;
+        for(int t = 0; t < threads; t++) {
+            char path[300];
+            snprintf(path, sizeof(path), "%s_%d.nfc", parallel_prefix, t);
+            parallel_count = parallel_read_keys(path, &parallel_keys, parallel_count);
+        }
+        qsort(serial_keys, serial_count, sizeof(uint64_t), parallel_key_compare);
+        qsort(parallel_keys, parallel_count, sizeof(uint64_t), parallel_key_compare);
+
+        if(serial_found != parallel_found) {
+            printf(
+                "FAIL %s: nonce %" PRIu32 " found %d serial, %d parallel\n",
+                name,
+                i,
+                serial_found,
+                parallel_found);
+            passed = false;
+        } else if(
+            serial_found &&
+            memcmp(serial_nonce.key.data, parallel_key.data, sizeof(MfClassicKey)) != 0) {
+            printf("FAIL %s: nonce %" PRIu32 " cracked to different keys\n", name, i);
+            passed = false;
+        } else if(
+            (serial_count != parallel_count) ||
+            (serial_count &&
+             memcmp(serial_keys, parallel_keys, serial_count * sizeof(uint64_t)) != 0)) {
+            printf(
+                "FAIL %s: nonce %" PRIu32 " %zu candidates serial, %zu parallel\n",
+                name,
+                i,
+                serial_count,
+                parallel_count);
+            passed = false;
+        }
+        cracked += serial_found;
+        candidates += serial_count;
+        free(serial_keys);
+        free(parallel_keys);
+        free(program_state->sn_siblings);
+        program_state->sn_siblings = NULL;
+        program_state->sn_sibling_count = 0;
+        free(program_state->sen_siblings);
+        program_state->sen_siblings = NULL;
+        program_state->sen_sibling_count = 0;
+    }
+
+    if(passed) {
+        printf(
+            "ok   %s: %d cracked, %d candidates, %" PRIu32 " ms serial, %" PRIu32
+            " ms on %d threads\n",
+            name,
+            cracked,
+            candidates,
+            serial_ms,
+            parallel_ms_total,
+            threads);
+    }
+    plugin->napi_mf_classic_nonce_array_free(nonce_arr);
+    free(program_state);
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    int threads = (argc > 1) ? atoi(argv[1]) : PARALLEL_THREADS_DEFAULT;
+    if((threads < 1) || (threads > PARALLEL_THREADS_MAX)) {
+        printf("threads must be 1 to %d\n", PARALLEL_THREADS_MAX);
+        return 2;
+    }
+
+    size_t failed = 0;
+    for(size_t i = 0; i < COUNT_OF(parallel_vectors); i++) {
+        if(!parallel_test_vector(parallel_vectors[i], threads)) failed++;
+    }
+
+    size_t count = COUNT_OF(parallel_vectors);
+    printf("%zu of %zu vectors matched\n", count - failed, count);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,305 @@
+// Runs mfkey() on every case of vectors/ and checks the recovered keys and the time taken
+
+#include <furi.h>
+#include <time.h>
+
+#include "../mfkey.h"
+#include "stub/sdk_stub.h"
+
+#define MFKEY_TEST_DICT_USER "mf_classic_dict_user.nfc"
+#define MFKEY_TEST_DICT_CUID "mf_classic_dict_11223344.nfc"
+
+typedef struct {
+    const char* name; // Directory in vectors/
+    int total;
+    int cracked;
+    int completed;
+    const char* dict; // Dictionary the keys are written to
+    uint64_t keys[2];
+    size_t key_count;
+    uint32_t budget_ms; // About three times a run on a desktop machine
+} MfkeyTestCase;
+
+// The run is stopped like with the Back button right after a write to a file, then
+// resumed from its checkpoint, and has to end like a run that was never stopped
+typedef struct {
+    const char* name; // Directory in vectors/
+    const char* interrupt_file;
+    int interrupt_write; // 1 for the first write to the file, -1 for the last one
+} MfkeyResumeCase;
+
+// mfkey.c has no header of its own
+void mfkey(ProgramState* program_state);
+
+static const MfkeyTestCase mfkey_test_cases[] = {
+    {"mfkey32", 2, 2, 2, MFKEY_TEST_DICT_USER, {0xA0A1A2A3A4A5, 0x123456789ABC}, 2, 9000},
+    {"mfkey32_parity", 1, 1, 1, MFKEY_TEST_DICT_USER, {0xFFEEDDCCBBAA}, 1, 4500},
+    {"static_nested", 1, 1, 1, MFKEY_TEST_DICT_USER, {0x4D3A99C351DD}, 1, 3500},
+    // Only the candidates are known, the key has to be among them
+    {"static_encrypted", 1, 0, 1, MFKEY_TEST_DICT_CUID, {0x1A982C7E459A}, 1, 7000},
+    // The sibling is covered by the same search
+    {"static_encrypted_siblings", 2, 0, 2, MFKEY_TEST_DICT_CUID, {0x5E7A11C0FFEE}, 1, 7000},
+    // The nonce with a dictionary key is counted as cracked without an attack
+    {"dictionary", 2, 2, 2, MFKEY_TEST_DICT_USER, {0xC0C1C2C3C4C5}, 1, 4500},
+    {"nested_siblings", 3, 2, 3, MFKEY_TEST_DICT_USER, {0x0123456789AB}, 1, 1500},
+};
+
+static const MfkeyResumeCase mfkey_resume_cases[] = {
+    // Mid-nonce, right after the first finished round
+    {"mfkey32", ".mfkey_checkpoint", 1},
+    // Right after the round with the last candidate of a sibling group, the resumed
+    // rounds find nothing new
+    {"static_encrypted_siblings", MFKEY_TEST_DICT_CUID, -1},
+};
+
+static uint32_t mfkey_test_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static bool mfkey_test_dict_has_key(const char* dict, uint64_t key) {
+    char path[256];
+    snprintf(path, sizeof(path), "%snfc/assets/%s", MFKEY_TEST_EXT, dict);
+    FILE* file = fopen(path, "r");
+    if(!file) return false;
+
+    bool found = false;
+    char line[64];
+    while(!found && fgets(line, sizeof(line), file)) {
+        found = (line[0] != '#') && (strtoull(line, NULL, 16) == key);
+    }
+    fclose(file);
+    return found;
+}
+
+static bool mfkey_test_setup(const char* name) {
+    char command[512];
+    snprintf(
+        command,
+        sizeof(command),
+        "rm -rf %s && mkdir -p %snfc/assets && cp -r vectors/%s/. %s",
+        MFKEY_TEST_EXT,
+        MFKEY_TEST_EXT,
+        name,
+        MFKEY_TEST_EXT);
+    if(system(command) != 0) {
+        printf("FAIL %s: can't set up %s\n", name, MFKEY_TEST_EXT);
+        return false;
+    }
+    return true;
+}
+
+static bool mfkey_test_run(const MfkeyTestCase* test_case) {
+    if(!mfkey_test_setup(test_case->name)) return false;
+
+    ProgramState* program_state = malloc(sizeof(ProgramState));
+    uint32_t start = mfkey_test_ms();
+    mfkey(program_state);
+    uint32_t elapsed = mfkey_test_ms() - start;
+
+    bool passed = true;
+    if(program_state->mfkey_state != Complete) {
+        printf(
+            "FAIL %s: state %d, error %d\n",
+            test_case->name,
+            program_state->mfkey_state,
+            program_state->err);
+        passed = false;
+    } else if(
+        (program_state->total != test_case->total) ||
+        (program_state->cracked != test_case->cracked) ||
+        (program_state->num_completed != test_case->completed)) {
+        printf(
+            "FAIL %s: total %d cracked %d completed %d, expected %d %d %d\n",
+            test_case->name,
+            program_state->total,
+            program_state->cracked,
+            program_state->num_completed,
+            test_case->total,
+            test_case->cracked,
+            test_case->completed);
+        passed = false;
+    }
+    for(size_t i = 0; passed && (i < test_case->key_count); i++) {
+        if(!mfkey_test_dict_has_key(test_case->dict, test_case->keys[i])) {
+            printf(
+                "FAIL %s: %012" PRIX64 " missing from %s\n",
+                test_case->name,
+                test_case->keys[i],
+                test_case->dict);
+            passed = false;
+        }
+    }
+    if(passed && (elapsed > test_case->budget_ms)) {
+        printf(
+            "FAIL %s: %" PRIu32 " ms, budget %" PRIu32 " ms\n",
+            test_case->name,
+            elapsed,
+            test_case->budget_ms);
+        passed = false;
+    }
+    if(passed) {
+        printf(
+            "ok   %s: %d/%d cracked, %d candidates, %" PRIu32 " ms\n",
+            test_case->name,
+            program_state->cracked,
+            program_state->total,
+            program_state->num_candidates,
+            elapsed);
+    }
+
+    free(program_state);
+    return passed;
+}
+
+// Counters and sorted dictionary contents at the end of a run
+typedef struct {
+    int total;
+    int cracked;
+    int completed;
+    int candidates;
+    char* dicts; // Both dictionaries, one sorted line list after the other
+} MfkeyTestOutcome;
+
+static int mfkey_test_line_compare(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static void mfkey_test_dict_lines(const char* dict, FuriString* out) {
+    char path[256];
+    snprintf(path, sizeof(path), "%snfc/assets/%s", MFKEY_TEST_EXT, dict);
+    FILE* file = fopen(path, "r");
+    char** lines = NULL;
+    size_t count = 0;
+    char line[64];
+    while(file && fgets(line, sizeof(line), file)) {
+        lines = realloc(lines, sizeof(char*) * (count + 1));
+        lines[count++] = strdup(line);
+    }
+    if(file) fclose(file);
+    qsort(lines, count, sizeof(char*), mfkey_test_line_compare);
+    furi_string_cat_printf(out, "%s:\n", dict);
+    for(size_t i = 0; i < count; i++) {
+        furi_string_cat_printf(out, "%s", lines[i]);
+        free(lines[i]);
+    }
+    free(lines);
+}
+
+static void mfkey_test_outcome(ProgramState* program_state, MfkeyTestOutcome* outcome) {
+    outcome->total = program_state->total;
+    outcome->cracked = program_state->cracked;
+    outcome->completed = program_state->num_completed;
+    outcome->candidates = program_state->num_candidates;
+    FuriString* dicts = furi_string_alloc();
+    mfkey_test_dict_lines(MFKEY_TEST_DICT_USER, dicts);
+    mfkey_test_dict_lines(MFKEY_TEST_DICT_CUID, dicts);
+    outcome->dicts = strdup(furi_string_get_cstr(dicts));
+    furi_string_free(dicts);
+}
+
+typedef struct {
+    const char* file;
+    int stop_at; // Write to stop after, 0 to only count them
+    int writes;
+    ProgramState* program_state;
+} MfkeyTestInterrupt;
+
+static void mfkey_test_interrupt(const char* path, void* context) {
+    MfkeyTestInterrupt* interrupt = context;
+    size_t path_len = strlen(path);
+    size_t file_len = strlen(interrupt->file);
+    if((path_len < file_len) || (strcmp(path + path_len - file_len, interrupt->file) != 0)) {
+        return;
+    }
+    if(++interrupt->writes == interrupt->stop_at) {
+        interrupt->program_state->close_thread_please = true;
+    }
+}
+
+static bool mfkey_test_resume(const MfkeyResumeCase* resume_case) {
+    MfkeyTestOutcome expected, resumed;
+    if(!mfkey_test_setup(resume_case->name)) return false;
+    ProgramState* program_state = malloc(sizeof(ProgramState));
+    MfkeyTestInterrupt counter = {.file = resume_case->interrupt_file};
+    sdk_stub_set_write_callback(mfkey_test_interrupt, &counter);
+    mfkey(program_state);
+    sdk_stub_set_write_callback(NULL, NULL);
+    mfkey_test_outcome(program_state, &expected);
+    free(program_state);
+
+    if(!mfkey_test_setup(resume_case->name)) return false;
+    program_state = malloc(sizeof(ProgramState));
+    MfkeyTestInterrupt interrupt = {
+        .file = resume_case->interrupt_file,
+        .stop_at = (resume_case->interrupt_write > 0) ?
+                       resume_case->interrupt_write :
+                       counter.writes + 1 + resume_case->interrupt_write,
+        .program_state = program_state,
+    };
+    sdk_stub_set_write_callback(mfkey_test_interrupt, &interrupt);
+    mfkey(program_state);
+    sdk_stub_set_write_callback(NULL, NULL);
+    int interrupted_completed = program_state->num_completed;
+    free(program_state);
+
+    program_state = malloc(sizeof(ProgramState));
+    mfkey(program_state);
+    mfkey_test_outcome(program_state, &resumed);
+    free(program_state);
+
+    bool passed = false;
+    if((interrupt.stop_at < 1) || (interrupt.writes < interrupt.stop_at)) {
+        printf(
+            "FAIL resume %s: %s written %d times, not stopped\n",
+            resume_case->name,
+            resume_case->interrupt_file,
+            interrupt.writes);
+    } else if(
+        (resumed.total != expected.total) || (resumed.cracked != expected.cracked) ||
+        (resumed.completed != expected.completed) || (resumed.candidates != expected.candidates)) {
+        printf(
+            "FAIL resume %s: total %d cracked %d completed %d candidates %d, "
+            "expected %d %d %d %d\n",
+            resume_case->name,
+            resumed.total,
+            resumed.cracked,
+            resumed.completed,
+            resumed.candidates,
+            expected.total,
+            expected.cracked,
+            expected.completed,
+            expected.candidates);
+    } else if(strcmp(resumed.dicts, expected.dicts) != 0) {
+        printf(
+            "FAIL resume %s: dictionaries differ from an uninterrupted run\n", resume_case->name);
+    } else {
+        printf(
+            "ok   resume %s: stopped at write %d of %s after %d/%d nonces, %d candidates\n",
+            resume_case->name,
+            interrupt.stop_at,
+            resume_case->interrupt_file,
+            interrupted_completed,
+            expected.total,
+            resumed.candidates);
+        passed = true;
+    }
+    free(expected.dicts);
+    free(resumed.dicts);
+    return passed;
+}
+
+int main(void) {
+    size_t failed = 0;
+    for(size_t i = 0; i < COUNT_OF(mfkey_test_cases); i++) {
+        if(!mfkey_test_run(&mfkey_test_cases[i])) failed++;
+    }
+    for(size_t i = 0; i < COUNT_OF(mfkey_resume_cases); i++) {
+        if(!mfkey_test_resume(&mfkey_resume_cases[i])) failed++;
+    }
+
+    size_t count = COUNT_OF(mfkey_test_cases) + COUNT_OF(mfkey_resume_cases);
+    printf("%zu of %zu cases passed\n", count - failed, count);
+    return failed ? 1 : 0;
+}
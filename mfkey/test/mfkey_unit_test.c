@@ -0,0 +1,1512 @@
+// Tests and benchmarks of the recovery internals. mfkey.c and init_plugin.c are included
+// to reach their static functions, the nonces come from the logs in vectors/.
+
+#include <time.h>
+#include <unistd.h>
+
+#include "../mfkey.c"
+#include "../init_plugin.c"
+#include "stub/sdk_stub.h"
+
+typedef bool (*MfkeyUnitTest)(void);
+
+typedef struct {
+    const char* name;
+    MfkeyUnitTest test;
+} MfkeyUnitCase;
+
+static uint64_t unit_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static bool unit_setup(const char* vector) {
+    char command[512];
+    snprintf(
+        command,
+        sizeof(command),
+        "rm -rf %s && mkdir -p %snfc/assets && cp -r vectors/%s/. %s",
+        MFKEY_TEST_EXT,
+        MFKEY_TEST_EXT,
+        vector,
+        MFKEY_TEST_EXT);
+    return system(command) == 0;
+}
+
+// Every nonce of a vector, through the init plugin like mfkey() loads them
+static MfClassicNonceArray* unit_load_nonces(const char* vector, ProgramState* program_state) {
+    if(!unit_setup(vector)) return NULL;
+    const MfkeyPlugin* plugin = init_plugin_ep()->entry_point;
+    program_state->mfkey32_present = plugin->napi_mf_classic_mfkey32_nonces_check_presence();
+    program_state->nested_present = plugin->napi_mf_classic_nested_nonces_check_presence();
+    KeysDict* user_dict =
+        keys_dict_alloc(KEYS_DICT_USER_PATH, KeysDictModeOpenAlways, sizeof(MfClassicKey));
+    MfClassicNonceArray* nonce_arr =
+        plugin->napi_mf_classic_nonce_array_alloc(NULL, false, user_dict, program_state);
+    keys_dict_free(user_dict);
+    return nonce_arr;
+}
+
+static void unit_free_nonces(MfClassicNonceArray* nonce_arr) {
+    const MfkeyPlugin* plugin = init_plugin_ep()->entry_point;
+    plugin->napi_mf_classic_nonce_array_free(nonce_arr);
+}
+
+// Keystream word and nonce recover() is called with for a nonce
+static void unit_nonce_keystream(MfClassicNonce* nonce, int* ks_enc, unsigned int* nt_xor_uid) {
+    *ks_enc = nonce->ks1_1_enc;
+    *nt_xor_uid = nonce->uid_xor_nt0;
+    if(nonce->attack == mfkey32) {
+        *ks_enc = nonce->ar0_enc ^ nonce->p64;
+        *nt_xor_uid = 0;
+    } else if(nonce->attack == static_nested) {
+        *ks_enc = nonce->ks1_2_enc;
+        *nt_xor_uid = nonce->uid_xor_nt1;
+    }
+}
+
+// MSB bucket dedup
+
+#define UNIT_DEDUP_BUCKETS MSB_LIMIT_MAX
+#define UNIT_DEDUP_VECTORS 2
+
+typedef struct {
+    uint32_t* states; // Bucket in the low byte of the MSB, in state_loop() output order
+    size_t count;
+} UnitDedupStream;
+
+// What calculate_msb_tables() did before the hash set, without the off-by-one
+static void unit_scan_insert(struct Msb* bucket, uint32_t state) {
+    for(int j = 0; j < bucket->tail; j++) {
+        if(bucket->states[j] == state) return;
+    }
+    if(bucket->tail < MSB_BUCKET_CAPACITY) {
+        bucket->states[bucket->tail++] = state;
+    }
+}
+
+static void unit_dedup_append(UnitDedupStream* stream, uint32_t state) {
+    if((state >> 24) >= UNIT_DEDUP_BUCKETS) return;
+    stream->states = realloc(stream->states, sizeof(uint32_t) * (stream->count + 1));
+    stream->states[stream->count++] = state;
+}
+
+// Records the states the first round of a nonce files into its buckets, in the order
+// calculate_msb_tables() inserts them
+static void
+    unit_dedup_collect(MfClassicNonce* nonce, UnitDedupStream* odd, UnitDedupStream* even) {
+    int ks_enc, oks, eks;
+    unsigned int in;
+    unit_nonce_keystream(nonce, &ks_enc, &in);
+    msb_keystream_split(ks_enc, &oks, &eks);
+    in = ((in >> 16 & 0xff) | (in << 16) | (in & 0xff00)) << 1;
+    unsigned int states_buffer[1024];
+    for(int semi_state = 1 << 20; semi_state >= 0; semi_state--) {
+        if(filter(semi_state) == (oks & 1)) {
+            states_buffer[0] = semi_state;
+            int tail = state_loop(states_buffer, oks, CONST_M1_1, CONST_M2_1, 0, 0);
+            for(int i = tail; i >= 0; i--) {
+                unit_dedup_append(odd, states_buffer[i]);
+            }
+        }
+        if(filter(semi_state) == (eks & 1)) {
+            states_buffer[0] = semi_state;
+            int tail = state_loop(states_buffer, eks, CONST_M1_2, CONST_M2_2, in, 3);
+            for(int i = 0; i <= tail; i++) {
+                unit_dedup_append(even, states_buffer[i]);
+            }
+        }
+    }
+}
+
+static int unit_state_compare(const void* a, const void* b) {
+    uint32_t state_a = *(const uint32_t*)a;
+    uint32_t state_b = *(const uint32_t*)b;
+    return (state_a > state_b) - (state_a < state_b);
+}
+
+// Replays a stream into both dedup structures, false if they kept different states
+static bool unit_dedup_replay(
+    UnitDedupStream* stream,
+    struct Msb* hash,
+    struct Msb* scan,
+    uint64_t* hash_ns,
+    uint64_t* scan_ns) {
+    for(int i = 0; i < UNIT_DEDUP_BUCKETS; i++) {
+        msb_bucket_init(&hash[i], i);
+        scan[i].tail = 0;
+    }
+    uint64_t start = unit_ns();
+    for(size_t i = 0; i < stream->count; i++) {
+        uint32_t state = stream->states[i];
+        msb_bucket_insert(&hash[state >> 24], state >> 24, state);
+    }
+    for(int i = 0; i < UNIT_DEDUP_BUCKETS; i++) {
+        msb_bucket_compact(&hash[i], i);
+    }
+    *hash_ns += unit_ns() - start;
+    start = unit_ns();
+    for(size_t i = 0; i < stream->count; i++) {
+        uint32_t state = stream->states[i];
+        unit_scan_insert(&scan[state >> 24], state);
+    }
+    *scan_ns += unit_ns() - start;
+
+    for(int i = 0; i < UNIT_DEDUP_BUCKETS; i++) {
+        // A full bucket drops states, the two would differ in which ones
+        if((hash[i].tail != scan[i].tail) || (scan[i].tail >= MSB_BUCKET_CAPACITY - 1)) {
+            return false;
+        }
+        qsort(hash[i].states, hash[i].tail, sizeof(uint32_t), unit_state_compare);
+        qsort(scan[i].states, scan[i].tail, sizeof(uint32_t), unit_state_compare);
+        if(memcmp(hash[i].states, scan[i].states, sizeof(uint32_t) * hash[i].tail) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool unit_test_msb_dedup(void) {
+    static const char* const vectors[UNIT_DEDUP_VECTORS] = {"mfkey32", "static_nested"};
+    struct Msb* hash = malloc(sizeof(struct Msb) * UNIT_DEDUP_BUCKETS);
+    struct Msb* scan = malloc(sizeof(struct Msb) * UNIT_DEDUP_BUCKETS);
+    uint64_t hash_ns = 0, scan_ns = 0;
+    size_t states = 0, nonces = 0;
+    bool passed = true;
+
+    for(size_t v = 0; passed && (v < UNIT_DEDUP_VECTORS); v++) {
+        ProgramState* program_state = malloc(sizeof(ProgramState));
+        MfClassicNonceArray* nonce_arr = unit_load_nonces(vectors[v], program_state);
+        for(uint32_t i = 0; passed && nonce_arr && (i < nonce_arr->total_nonces); i++) {
+            UnitDedupStream odd = {0}, even = {0};
+            unit_dedup_collect(&nonce_arr->remaining_nonce_array[i], &odd, &even);
+            passed = unit_dedup_replay(&odd, hash, scan, &hash_ns, &scan_ns) &&
+                     unit_dedup_replay(&even, hash, scan, &hash_ns, &scan_ns);
+            if(!passed) {
+                printf("FAIL msb_dedup: %s nonce %" PRIu32 " buckets differ\n", vectors[v], i);
+            }
+            states += odd.count + even.count;
+            nonces++;
+            free(odd.states);
+            free(even.states);
+        }
+        if(!nonce_arr) {
+            printf("FAIL msb_dedup: can't load %s\n", vectors[v]);
+            passed = false;
+        } else {
+            unit_free_nonces(nonce_arr);
+        }
+        free(program_state);
+    }
+
+    if(passed) {
+        printf(
+            "ok   msb_dedup: %zu states of %zu nonces, hash set %.1f M states/s, "
+            "linear scan %.1f M states/s\n",
+            states,
+            nonces,
+            states * 1000.0 / MAX(hash_ns, 1u),
+            states * 1000.0 / MAX(scan_ns, 1u));
+    }
+    free(hash);
+    free(scan);
+    return passed;
+}
+
+// Bitsliced prefilter
+
+#define UNIT_BS_ROUNDS      20000
+#define UNIT_BS_BENCH_STATE (1 << 20)
+
+typedef struct {
+    const char* vector;
+    uint64_t keys[2];
+    size_t key_count;
+} UnitBsVector;
+
+static const UnitBsVector unit_bs_vectors[] = {
+    {"mfkey32", {0xA0A1A2A3A4A5, 0x123456789ABC}, 2},
+    {"mfkey32_parity", {0xFFEEDDCCBBAA}, 1},
+    {"static_nested", {0x4D3A99C351DD}, 1},
+    {"static_encrypted", {0x1A982C7E459A}, 1},
+};
+
+static uint32_t unit_random_state = 0x2545F491;
+
+static uint32_t unit_random(void) {
+    // xorshift32, the same sequence on every run
+    unit_random_state ^= unit_random_state << 13;
+    unit_random_state ^= unit_random_state >> 17;
+    unit_random_state ^= unit_random_state << 5;
+    return unit_random_state;
+}
+
+// Lane of the plane window as a scalar state
+static void unit_bs_lane(const struct Crypto1BsState* bs, int lane, struct Crypto1State* s) {
+    s->odd = 0;
+    s->even = 0;
+    for(int i = 0; i < 24; i++) {
+        s->odd |= ((bs->planes[bs->base + 2 * i] >> lane) & 1) << i;
+        s->even |= ((bs->planes[bs->base + 2 * i + 1] >> lane) & 1) << i;
+    }
+}
+
+static bool unit_bs_lanes_equal(
+    const struct Crypto1BsState* bs,
+    const struct Crypto1State* scalar,
+    int count,
+    const char* step) {
+    for(int lane = 0; lane < count; lane++) {
+        struct Crypto1State s;
+        unit_bs_lane(bs, lane, &s);
+        // Forward clocking leaves stale bits above bit 23 in the scalar state
+        if((s.odd != (scalar[lane].odd & 0xFFFFFF)) ||
+           (s.even != (scalar[lane].even & 0xFFFFFF))) {
+            printf("FAIL crypto1_bs: lane %d of %d differs after %s\n", lane, count, step);
+            return false;
+        }
+    }
+    return true;
+}
+
+// One round on random states: load, a rollback matched against the keystream of a
+// witness lane, a plain rollback to the far edge of the plane window, then a forward
+// word back down to planes[0]. The witness keeps every step running over all 32 bits.
+static bool unit_bs_round(struct Crypto1BsState* bs, int count) {
+    struct Crypto1State scalar[CRYPTO1_BS_LANES];
+    uint32_t all = (count == CRYPTO1_BS_LANES) ? 0xFFFFFFFF : ((1U << count) - 1);
+    for(int lane = 0; lane < count; lane++) {
+        bs->odd[lane] = unit_random() & 0xFFFFFF;
+        bs->even[lane] = unit_random() & 0xFFFFFF;
+        scalar[lane] = (struct Crypto1State){bs->odd[lane], bs->even[lane]};
+    }
+    crypto1_bs_load(bs, count);
+    if(!unit_bs_lanes_equal(bs, scalar, count, "load")) return false;
+
+    int witness = unit_random() % count;
+    uint32_t in = unit_random();
+    struct Crypto1State witness_state = scalar[witness];
+    uint32_t ks = napi_lfsr_rollback_word(&witness_state, in, 0);
+    uint32_t expected = 0;
+    for(int lane = 0; lane < count; lane++) {
+        expected |= (uint32_t)(napi_lfsr_rollback_word(&scalar[lane], in, 0) == ks) << lane;
+    }
+    uint32_t matched = crypto1_bs_rollback_word_match(bs, in, ks, all);
+    if(matched != expected) {
+        printf(
+            "FAIL crypto1_bs: rollback match %08" PRIX32 ", scalar %08" PRIX32 "\n",
+            matched,
+            expected);
+        return false;
+    }
+    if(!unit_bs_lanes_equal(bs, scalar, count, "rollback match")) return false;
+
+    // A keystream the lane doesn't give has to end the match empty, wherever it stops
+    struct Crypto1BsState miss = *bs;
+    if(crypto1_bs_rollback_word_match(&miss, in, ~ks, 1U << witness) != 0) {
+        printf("FAIL crypto1_bs: witness lane matched a wrong keystream\n");
+        return false;
+    }
+
+    in = unit_random();
+    crypto1_bs_rollback_word(bs, in);
+    for(int lane = 0; lane < count; lane++) {
+        rollback_word_noret(&scalar[lane], in, 0);
+    }
+    if(bs->base != 2 * 32) {
+        printf("FAIL crypto1_bs: window base %d after two rollbacks\n", bs->base);
+        return false;
+    }
+    if(!unit_bs_lanes_equal(bs, scalar, count, "rollback")) return false;
+
+    in = unit_random();
+    witness_state = scalar[witness];
+    ks = crypt_word_ret(&witness_state, in, 0);
+    expected = 0;
+    for(int lane = 0; lane < count; lane++) {
+        expected |= (uint32_t)(crypt_word_ret(&scalar[lane], in, 0) == ks) << lane;
+    }
+    // Two words forward from the far edge reach planes[0]
+    bs->base = 2 * 32;
+    matched = crypto1_bs_crypt_word_match(bs, in, ks, all);
+    if(matched != expected) {
+        printf(
+            "FAIL crypto1_bs: crypt match %08" PRIX32 ", scalar %08" PRIX32 "\n",
+            matched,
+            expected);
+        return false;
+    }
+    if(!unit_bs_lanes_equal(bs, scalar, count, "crypt match")) return false;
+    in = unit_random();
+    witness_state = scalar[witness];
+    ks = crypt_word_ret(&witness_state, in, 0);
+    crypto1_bs_crypt_word_match(bs, in, ks, 1U << witness);
+    for(int lane = 0; lane < count; lane++) {
+        crypt_word_ret(&scalar[lane], in, 0);
+    }
+    if(bs->base != 0) {
+        printf("FAIL crypto1_bs: window base %d after two forward words\n", bs->base);
+        return false;
+    }
+    return unit_bs_lanes_equal(bs, scalar, count, "second crypt match");
+}
+
+static bool unit_test_crypto1_bs(void) {
+    struct Crypto1BsState* bs = malloc(sizeof(struct Crypto1BsState));
+    bool passed = true;
+    size_t states = 0;
+    for(int round = 0; passed && (round < UNIT_BS_ROUNDS); round++) {
+        // Every other round on all 32 lanes, the rest on a partial batch
+        int count = (round % 2) ? CRYPTO1_BS_LANES : (int)(unit_random() % CRYPTO1_BS_LANES) + 1;
+        passed = unit_bs_round(bs, count);
+        states += count;
+    }
+    if(passed) {
+        printf("ok   crypto1_bs: %zu random states, 4 words each\n", states);
+    }
+    free(bs);
+    return passed;
+}
+
+static void unit_key_state(uint64_t key, struct Crypto1State* s) {
+    s->odd = 0;
+    s->even = 0;
+    for(int i = 0; i < 24; i++) {
+        s->odd |= (BIT(key, 2 * i + 1) << (i ^ 3));
+        s->even |= (BIT(key, 2 * i) << (i ^ 3));
+    }
+}
+
+// The state check_state() is called with when the key is in the batch
+static void unit_planted_state(const MfClassicNonce* nonce, uint64_t key, struct Crypto1State* s) {
+    unit_key_state(key, s);
+    if(nonce->attack == mfkey32) {
+        crypt_word_noret(s, nonce->uid_xor_nt0, 0);
+        crypt_word_noret(s, nonce->nr0_enc, 1);
+        crypt_word_noret(s, 0, 0);
+    } else if(nonce->attack == static_nested) {
+        crypt_word_noret(s, nonce->uid_xor_nt1, 0);
+    } else {
+        crypt_word_noret(s, nonce->uid_xor_nt0, 0);
+    }
+}
+
+static MsbPartition unit_bs_partition(const MfClassicNonce* nonce, KeySink* sink) {
+    return (MsbPartition){.nonce = *nonce, .cuid_sink = sink};
+}
+
+// check_state_batch() against check_state() on every lane, in lane order
+static bool unit_bs_batch_compare(
+    struct Crypto1BsState* bs,
+    int count,
+    const MfClassicNonce* nonce,
+    KeySink* sink,
+    int* hits) {
+    MsbPartition scalar = unit_bs_partition(nonce, sink);
+    MsbPartition batch = unit_bs_partition(nonce, sink);
+    int scalar_found = 0;
+    for(int lane = 0; !scalar_found && (lane < count); lane++) {
+        struct Crypto1State t = {bs->odd[lane], bs->even[lane]};
+        scalar_found = check_state(&t, &scalar);
+    }
+    int batch_found = check_state_batch(bs, count, &batch);
+    *hits += scalar_found + scalar.num_candidates;
+    bool same_key =
+        !scalar_found ||
+        (memcmp(scalar.nonce.key.data, batch.nonce.key.data, sizeof(MfClassicKey)) == 0);
+    return (scalar_found == batch_found) && (scalar.num_candidates == batch.num_candidates) &&
+           same_key;
+}
+
+static bool unit_test_check_state_batch(void) {
+    struct Crypto1BsState* bs = malloc(sizeof(struct Crypto1BsState));
+    KeySink* sink = key_sink_alloc(MFKEY_TEST_EXT "unit_candidates.nfc");
+    bool passed = true;
+    int batches = 0;
+    for(size_t v = 0; passed && (v < COUNT_OF(unit_bs_vectors)); v++) {
+        const UnitBsVector* vector = &unit_bs_vectors[v];
+        ProgramState* program_state = malloc(sizeof(ProgramState));
+        MfClassicNonceArray* nonce_arr = unit_load_nonces(vector->vector, program_state);
+        passed = nonce_arr != NULL;
+        for(uint32_t i = 0; passed && (i < nonce_arr->total_nonces); i++) {
+            const MfClassicNonce* nonce = &nonce_arr->remaining_nonce_array[i];
+            int hits = 0;
+            for(int round = 0; passed && (round < 64); round++) {
+                int count = (round % 2) ? CRYPTO1_BS_LANES :
+                                          (int)(unit_random() % CRYPTO1_BS_LANES) + 1;
+                for(int lane = 0; lane < count; lane++) {
+                    bs->odd[lane] = unit_random() & 0xFFFFFF;
+                    bs->even[lane] = unit_random() & 0xFFFFFF;
+                }
+                // Half the batches carry a key state, on the edge lanes first
+                if(round % 4 < 2) {
+                    int lane = (round < 4) ? ((round % 2) ? count - 1 : 0) :
+                                             (int)(unit_random() % count);
+                    struct Crypto1State s;
+                    unit_planted_state(nonce, vector->keys[round / 4 % vector->key_count], &s);
+                    bs->odd[lane] = s.odd;
+                    bs->even[lane] = s.even;
+                }
+                passed = unit_bs_batch_compare(bs, count, nonce, sink, &hits);
+                if(!passed) {
+                    printf(
+                        "FAIL check_state_batch: %s nonce %" PRIu32 " batch %d differs\n",
+                        vector->vector,
+                        i,
+                        round);
+                }
+                batches++;
+            }
+            if(passed && (hits == 0)) {
+                printf(
+                    "FAIL check_state_batch: %s nonce %" PRIu32 " key never found\n",
+                    vector->vector,
+                    i);
+                passed = false;
+            }
+        }
+        if(nonce_arr) unit_free_nonces(nonce_arr);
+        free(program_state);
+    }
+    key_sink_free(sink);
+    if(passed) {
+        printf("ok   check_state_batch: %d batches, same result as check_state\n", batches);
+    }
+    free(bs);
+    return passed;
+}
+
+// Random states through both checks, almost none pass the first keystream word
+static bool unit_test_check_state_bench(void) {
+    struct Crypto1BsState* bs = malloc(sizeof(struct Crypto1BsState));
+    KeySink* sink = key_sink_alloc(MFKEY_TEST_EXT "unit_candidates.nfc");
+    uint32_t* states = malloc(sizeof(uint32_t) * 2 * UNIT_BS_BENCH_STATE);
+    for(int i = 0; i < 2 * UNIT_BS_BENCH_STATE; i++) {
+        states[i] = unit_random() & 0xFFFFFF;
+    }
+    bool passed = true;
+    for(size_t v = 0; passed && (v < COUNT_OF(unit_bs_vectors)); v++) {
+        ProgramState* program_state = malloc(sizeof(ProgramState));
+        MfClassicNonceArray* nonce_arr =
+            unit_load_nonces(unit_bs_vectors[v].vector, program_state);
+        passed = nonce_arr != NULL;
+        if(passed) {
+            MsbPartition partition =
+                unit_bs_partition(&nonce_arr->remaining_nonce_array[0], sink);
+            int found = 0;
+            uint64_t start = unit_ns();
+            for(int i = 0; i < UNIT_BS_BENCH_STATE; i++) {
+                struct Crypto1State t = {states[2 * i], states[2 * i + 1]};
+                found += check_state(&t, &partition);
+            }
+            uint64_t scalar_ns = unit_ns() - start;
+            start = unit_ns();
+            for(int i = 0; i < UNIT_BS_BENCH_STATE; i += CRYPTO1_BS_LANES) {
+                for(int lane = 0; lane < CRYPTO1_BS_LANES; lane++) {
+                    bs->odd[lane] = states[2 * (i + lane)];
+                    bs->even[lane] = states[2 * (i + lane) + 1];
+                }
+                found += check_state_batch(bs, CRYPTO1_BS_LANES, &partition);
+            }
+            uint64_t batch_ns = unit_ns() - start;
+            printf(
+                "ok   check_state bench %s: scalar %.1f M candidates/s, "
+                "bitsliced %.1f M candidates/s (%d hits)\n",
+                unit_bs_vectors[v].vector,
+                UNIT_BS_BENCH_STATE * 1000.0 / MAX(scalar_ns, 1u),
+                UNIT_BS_BENCH_STATE * 1000.0 / MAX(batch_ns, 1u),
+                found);
+            unit_free_nonces(nonce_arr);
+        }
+        free(program_state);
+    }
+    key_sink_free(sink);
+    free(states);
+    free(bs);
+    return passed;
+}
+
+// Dictionary key cache
+
+#define UNIT_DICT_NONCES 500
+
+typedef struct {
+    size_t system_keys;
+    size_t user_keys; // A tenth of them repeat system dictionary keys
+    bool cached;
+} UnitDictCase;
+
+static const UnitDictCase unit_dict_cases[] = {
+    {3000, 800, true},
+    // Over DICT_KEY_CACHE_MAX_SIZE, streamed from the SD card for every nonce
+    {9000, 1000, false},
+};
+
+static uint64_t unit_random_key(void) {
+    return ((uint64_t)unit_random() << 16 ^ unit_random()) & 0xFFFFFFFFFFFF;
+}
+
+static void unit_dict_write(const char* path, const uint64_t* keys, size_t count) {
+    FILE* file = fopen(path, "w");
+    fprintf(file, "# Generated by mfkey_unit_test\n");
+    for(size_t i = 0; i < count; i++) {
+        fprintf(file, "%012" PRIX64 "\n", keys[i]);
+    }
+    fclose(file);
+}
+
+// A nonce key_matches_nonce() accepts for the key
+static void unit_dict_nonce(uint64_t key, AttackType attack, MfClassicNonce* nonce) {
+    memset(nonce, 0, sizeof(MfClassicNonce));
+    nonce->attack = attack;
+    struct Crypto1State s;
+    unit_key_state(key, &s);
+    if(attack == mfkey32) {
+        nonce->uid_xor_nt1 = unit_random();
+        nonce->nr1_enc = unit_random();
+        nonce->p64b = unit_random();
+        crypt_word_noret(&s, nonce->uid_xor_nt1, 0);
+        crypt_word_noret(&s, nonce->nr1_enc, 1);
+        nonce->ar1_enc = crypt_word(&s) ^ nonce->p64b;
+    } else {
+        nonce->uid_xor_nt0 = unit_random();
+        nonce->ks1_1_enc = crypt_word_ret(&s, nonce->uid_xor_nt0, 0);
+    }
+}
+
+static bool unit_dict_run(const UnitDictCase* dict_case) {
+    size_t key_count = dict_case->system_keys + dict_case->user_keys;
+    uint64_t* keys = malloc(sizeof(uint64_t) * key_count);
+    for(size_t i = 0; i < key_count; i++) {
+        keys[i] = unit_random_key();
+    }
+    size_t repeated = dict_case->user_keys / 10;
+    for(size_t i = 0; i < repeated; i++) {
+        keys[dict_case->system_keys + i] = keys[i * 7 % dict_case->system_keys];
+    }
+    unit_dict_write(MFKEY_TEST_EXT "nfc/assets/unit_system.nfc", keys, dict_case->system_keys);
+    unit_dict_write(
+        MFKEY_TEST_EXT "nfc/assets/unit_user.nfc",
+        &keys[dict_case->system_keys],
+        dict_case->user_keys);
+
+    // Every other nonce belongs to a dictionary key
+    MfClassicNonce* nonces = malloc(sizeof(MfClassicNonce) * UNIT_DICT_NONCES);
+    static const AttackType attacks[] = {mfkey32, static_nested, static_encrypted};
+    for(int i = 0; i < UNIT_DICT_NONCES; i++) {
+        uint64_t key = (i % 2) ? unit_random_key() : keys[unit_random() % key_count];
+        unit_dict_nonce(key, attacks[i % COUNT_OF(attacks)], &nonces[i]);
+    }
+
+    KeysDict* system_dict = keys_dict_alloc(
+        MFKEY_TEST_EXT "nfc/assets/unit_system.nfc",
+        KeysDictModeOpenExisting,
+        sizeof(MfClassicKey));
+    KeysDict* user_dict = keys_dict_alloc(
+        MFKEY_TEST_EXT "nfc/assets/unit_user.nfc",
+        KeysDictModeOpenExisting,
+        sizeof(MfClassicKey));
+    DictKeyCache cache;
+    uint64_t start = unit_ns();
+    dict_key_cache_load(&cache, system_dict, true, user_dict);
+    uint64_t load_ns = unit_ns() - start;
+
+    bool passed = true;
+    size_t unique = key_count - repeated;
+    if(cache.loaded != dict_case->cached) {
+        printf("FAIL dict_cache %zu keys: loaded %d\n", key_count, cache.loaded);
+        passed = false;
+    } else if(cache.loaded && (cache.count != unique)) {
+        printf(
+            "FAIL dict_cache %zu keys: %zu cached, %zu unique\n", key_count, cache.count, unique);
+        passed = false;
+    }
+    for(size_t i = 1; passed && (i < cache.count); i++) {
+        if(dict_key_compare(&cache.keys[i - 1], &cache.keys[i]) >= 0) {
+            printf("FAIL dict_cache %zu keys: cache not sorted at %zu\n", key_count, i);
+            passed = false;
+        }
+    }
+
+    // Without a cache both lookups would stream, the dictionaries are only read once then
+    DictKeyCache streamed = {0};
+    uint64_t cached_ns = 0, streamed_ns = 0;
+    int hits = 0;
+    for(int i = 0; passed && (i < UNIT_DICT_NONCES); i++) {
+        bool cached_found = false;
+        if(cache.loaded) {
+            start = unit_ns();
+            cached_found =
+                key_already_found_for_nonce(&cache, system_dict, true, user_dict, &nonces[i]);
+            cached_ns += unit_ns() - start;
+        }
+        start = unit_ns();
+        bool streamed_found =
+            key_already_found_for_nonce(&streamed, system_dict, true, user_dict, &nonces[i]);
+        streamed_ns += unit_ns() - start;
+        if(!cache.loaded) cached_found = streamed_found;
+        // A random key can match a nonce by chance, only the dictionary nonces are certain
+        if((cached_found != streamed_found) || ((i % 2 == 0) && !cached_found)) {
+            printf(
+                "FAIL dict_cache %zu keys: nonce %d found %d cached, %d streamed\n",
+                key_count,
+                i,
+                cached_found,
+                streamed_found);
+            passed = false;
+        }
+        hits += cached_found;
+    }
+    if(passed && cache.loaded) {
+        printf(
+            "ok   dict_cache %zu keys: cached in %.1f ms, %d/%d nonces found in %.1f ms, "
+            "%.1f ms streamed\n",
+            key_count,
+            load_ns / 1e6,
+            hits,
+            UNIT_DICT_NONCES,
+            cached_ns / 1e6,
+            streamed_ns / 1e6);
+    } else if(passed) {
+        printf(
+            "ok   dict_cache %zu keys: too large to cache, %d/%d nonces found in %.1f ms "
+            "streamed\n",
+            key_count,
+            hits,
+            UNIT_DICT_NONCES,
+            streamed_ns / 1e6);
+    }
+    dict_key_cache_free(&cache);
+    keys_dict_free(system_dict);
+    keys_dict_free(user_dict);
+    free(nonces);
+    free(keys);
+    return passed;
+}
+
+static bool unit_test_dict_cache(void) {
+    bool passed = unit_setup("dictionary");
+    for(size_t i = 0; passed && (i < COUNT_OF(unit_dict_cases)); i++) {
+        passed = unit_dict_run(&unit_dict_cases[i]);
+    }
+    return passed;
+}
+
+// Key sink
+
+#define UNIT_SINK_KEYS 1000
+
+typedef struct {
+    const char* path;
+    size_t writes;
+} UnitWriteCounter;
+
+static void unit_count_write(const char* path, void* context) {
+    UnitWriteCounter* counter = context;
+    if(strcmp(path, counter->path) == 0) counter->writes++;
+}
+
+static long unit_file_size(const char* path) {
+    FILE* file = fopen(path, "r");
+    if(!file) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// Candidates through a KeySink and through keys_dict_add_key() one by one, like before
+static bool unit_test_key_sink(void) {
+    if(!unit_setup("static_encrypted")) return false;
+    const char* sink_path = MFKEY_TEST_EXT "nfc/assets/unit_sink.nfc";
+    const char* dict_path = MFKEY_TEST_EXT "nfc/assets/unit_dict.nfc";
+    MfClassicKey* keys = malloc(sizeof(MfClassicKey) * UNIT_SINK_KEYS);
+    for(int i = 0; i < UNIT_SINK_KEYS; i++) {
+        bit_lib_num_to_bytes_be(unit_random_key(), sizeof(MfClassicKey), keys[i].data);
+    }
+
+    UnitWriteCounter sink_counter = {.path = sink_path};
+    sdk_stub_set_write_callback(unit_count_write, &sink_counter);
+    KeySink* sink = key_sink_alloc(sink_path);
+    bool passed = true;
+    for(int i = 0; passed && (i < UNIT_SINK_KEYS); i++) {
+        passed = key_sink_add(sink, &keys[i]);
+        // The same candidate again from the next state of the batch
+        if(passed && (i % 10 == 0) && key_sink_add(sink, &keys[i])) {
+            printf("FAIL key_sink: repeated key %d added twice\n", i);
+            passed = false;
+        }
+    }
+    // Only full chunks are written while adding, the rest waits for key_sink_free()
+    size_t full_chunk_writes = sink->writes;
+    key_sink_free(sink);
+
+    UnitWriteCounter dict_counter = {.path = dict_path};
+    sdk_stub_set_write_callback(unit_count_write, &dict_counter);
+    KeysDict* dict = keys_dict_alloc(dict_path, KeysDictModeOpenAlways, sizeof(MfClassicKey));
+    for(int i = 0; i < UNIT_SINK_KEYS; i++) {
+        keys_dict_add_key(dict, keys[i].data, sizeof(MfClassicKey));
+    }
+    keys_dict_free(dict);
+    sdk_stub_set_write_callback(NULL, NULL);
+
+    size_t chunks = (UNIT_SINK_KEYS + KEY_SINK_CHUNK_SIZE - 1) / KEY_SINK_CHUNK_SIZE;
+    long sink_bytes = unit_file_size(sink_path);
+    long dict_bytes = unit_file_size(dict_path);
+    if(passed && ((sink_counter.writes != chunks) ||
+                  (full_chunk_writes != UNIT_SINK_KEYS / KEY_SINK_CHUNK_SIZE))) {
+        printf(
+            "FAIL key_sink: %zu writes, %zu before the sink was freed, %zu chunks\n",
+            sink_counter.writes,
+            full_chunk_writes,
+            chunks);
+        passed = false;
+    }
+    // Same lines in the same order as the dictionary writes them
+    if(passed) {
+        FILE* sink_file = fopen(sink_path, "r");
+        FILE* dict_file = fopen(dict_path, "r");
+        char sink_line[64], dict_line[64];
+        while(passed && fgets(dict_line, sizeof(dict_line), dict_file)) {
+            passed = fgets(sink_line, sizeof(sink_line), sink_file) &&
+                     (strcmp(sink_line, dict_line) == 0);
+        }
+        passed = passed && !fgets(sink_line, sizeof(sink_line), sink_file);
+        fclose(sink_file);
+        fclose(dict_file);
+        if(!passed) printf("FAIL key_sink: file differs from keys_dict_add_key()\n");
+    }
+    if(passed) {
+        printf(
+            "ok   key_sink: %d keys, %ld bytes in %zu writes, %ld bytes in %zu writes "
+            "through keys_dict_add_key()\n",
+            UNIT_SINK_KEYS,
+            sink_bytes,
+            sink_counter.writes,
+            dict_bytes,
+            dict_counter.writes);
+    }
+    free(keys);
+    return passed;
+}
+
+// Introsort
+
+#define UNIT_SORT_GUARD      4
+#define UNIT_SORT_GUARD_WORD 0xA5A5A5A5
+#define UNIT_SORT_BENCH_SIZE (1 << 18)
+
+typedef enum {
+    UnitSortRandom,
+    UnitSortSorted,
+    UnitSortReversed,
+    UnitSortEqual,
+    UnitSortFewUnique,
+    UnitSortOrganPipe,
+    UnitSortSawtooth,
+    UnitSortMedianKiller,
+    UnitSortPatternCount,
+} UnitSortPattern;
+
+static const char* const unit_sort_pattern_names[UnitSortPatternCount] = {
+    "random",
+    "sorted",
+    "reversed",
+    "equal",
+    "few unique",
+    "organ pipe",
+    "sawtooth",
+    "median-of-3 killer",
+};
+
+static void unit_sort_fill(unsigned int* array, int n, UnitSortPattern pattern) {
+    for(int i = 0; i < n; i++) {
+        switch(pattern) {
+        case UnitSortRandom:
+            array[i] = unit_random();
+            break;
+        case UnitSortSorted:
+            array[i] = i;
+            break;
+        case UnitSortReversed:
+            array[i] = n - i;
+            break;
+        case UnitSortEqual:
+            array[i] = 7;
+            break;
+        case UnitSortFewUnique:
+            array[i] = unit_random() % 4;
+            break;
+        case UnitSortOrganPipe:
+            array[i] = (i < n / 2) ? i : n - i;
+            break;
+        case UnitSortSawtooth:
+            array[i] = i % 17;
+            break;
+        default:
+            break;
+        }
+    }
+    if(pattern == UnitSortMedianKiller) {
+        // Musser's median-of-3 killer, odd n gets the largest value last
+        int k = n / 2;
+        for(int i = 1; i <= k; i++) {
+            if(i % 2) {
+                array[i - 1] = i;
+                array[i] = k + i;
+            }
+            array[k + i - 1] = 2 * i;
+        }
+        if(n % 2) array[n - 1] = n;
+    }
+}
+
+static int unit_uint_compare(const void* a, const void* b) {
+    unsigned int value_a = *(const unsigned int*)a;
+    unsigned int value_b = *(const unsigned int*)b;
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+// Sorts the pattern between guard words, depth -1 for introsort()'s own depth limit
+static bool unit_sort_check(int n, UnitSortPattern pattern, int depth) {
+    unsigned int* array = malloc(sizeof(unsigned int) * (n + 2 * UNIT_SORT_GUARD));
+    unsigned int* expected = malloc(sizeof(unsigned int) * (n + 1));
+    for(int i = 0; i < n + 2 * UNIT_SORT_GUARD; i++) {
+        array[i] = UNIT_SORT_GUARD_WORD;
+    }
+    unsigned int* range = &array[UNIT_SORT_GUARD];
+    unit_sort_fill(range, n, pattern);
+    memcpy(expected, range, sizeof(unsigned int) * n);
+    qsort(expected, n, sizeof(unsigned int), unit_uint_compare);
+
+    if(depth < 0) {
+        introsort(array, UNIT_SORT_GUARD, UNIT_SORT_GUARD + n - 1);
+    } else {
+        introsort_depth(array, UNIT_SORT_GUARD, UNIT_SORT_GUARD + n - 1, depth);
+    }
+
+    const char* failure = NULL;
+    for(int i = 0; i < UNIT_SORT_GUARD; i++) {
+        if((array[i] != UNIT_SORT_GUARD_WORD) ||
+           (array[UNIT_SORT_GUARD + n + i] != UNIT_SORT_GUARD_WORD)) {
+            failure = "wrote outside the range";
+        }
+    }
+    for(int i = 1; !failure && (i < n); i++) {
+        if(range[i - 1] > range[i]) failure = "not sorted";
+    }
+    // Sorted and equal to the sorted input, so it is a permutation of the input
+    if(!failure && (memcmp(range, expected, sizeof(unsigned int) * n) != 0)) {
+        failure = "not a permutation of the input";
+    }
+    if(failure) {
+        printf(
+            "FAIL introsort: %s, %d elements, depth %d, %s\n",
+            unit_sort_pattern_names[pattern],
+            n,
+            depth,
+            failure);
+    }
+    free(array);
+    free(expected);
+    return !failure;
+}
+
+static uint64_t unit_sort_time(int n, UnitSortPattern pattern, int depth) {
+    unsigned int* array = malloc(sizeof(unsigned int) * n);
+    unit_sort_fill(array, n, pattern);
+    uint64_t start = unit_ns();
+    if(depth < 0) {
+        introsort(array, 0, n - 1);
+    } else {
+        introsort_depth(array, 0, n - 1, depth);
+    }
+    uint64_t elapsed = unit_ns() - start;
+    free(array);
+    return elapsed;
+}
+
+static bool unit_test_introsort(void) {
+    // Every size around the insertion sort cutoff, then sizes that partition deeply
+    static const int large_sizes[] = {255, 256, 1000, 4097, 65536};
+    // 0 is heapsort on every range over the cutoff, 1 and 2 switch after the first
+    // partitions, -1 is the depth introsort() picks
+    static const int depths[] = {-1, 0, 1, 2};
+    bool passed = true;
+    int sorts = 0;
+    for(size_t d = 0; d < COUNT_OF(depths); d++) {
+        for(int pattern = 0; pattern < UnitSortPatternCount; pattern++) {
+            for(int n = 0; passed && (n <= 3 * SORT_INSERTION_SIZE); n++) {
+                passed = unit_sort_check(n, pattern, depths[d]);
+                sorts++;
+            }
+            for(size_t i = 0; passed && (i < COUNT_OF(large_sizes)); i++) {
+                passed = unit_sort_check(large_sizes[i], pattern, depths[d]);
+                sorts++;
+            }
+        }
+    }
+    if(!passed) return false;
+
+    // An input that degrades the partitioning must still end in n log n time
+    uint64_t random_ns = unit_sort_time(UNIT_SORT_BENCH_SIZE, UnitSortRandom, -1);
+    uint64_t killer_ns = unit_sort_time(UNIT_SORT_BENCH_SIZE, UnitSortMedianKiller, -1);
+    uint64_t heap_ns = unit_sort_time(UNIT_SORT_BENCH_SIZE, UnitSortRandom, 0);
+    uint64_t sorted_ns = unit_sort_time(UNIT_SORT_BENCH_SIZE, UnitSortSorted, -1);
+    if(killer_ns > 20 * MAX(random_ns, heap_ns)) {
+        printf(
+            "FAIL introsort: median-of-3 killer %.1f ms, random %.1f ms\n",
+            killer_ns / 1e6,
+            random_ns / 1e6);
+        return false;
+    }
+    printf(
+        "ok   introsort: %d sorts, %d elements random %.1f ms, sorted %.1f ms, "
+        "median-of-3 killer %.1f ms, heapsort only %.1f ms\n",
+        sorts,
+        UNIT_SORT_BENCH_SIZE,
+        random_ns / 1e6,
+        sorted_ns / 1e6,
+        killer_ns / 1e6,
+        heap_ns / 1e6);
+    return true;
+}
+
+// Nonce cache
+
+#define UNIT_CACHE_NONCES 5000
+
+static void unit_cache_write_logs(int nonces) {
+    FILE* mfkey32_log = fopen(MFKEY_TEST_EXT "nfc/.mfkey32.log", "w");
+    FILE* nested_log = fopen(MFKEY_TEST_EXT "nfc/.nested.log", "w");
+    for(int i = 0; i < nonces; i++) {
+        uint32_t words[6];
+        for(size_t j = 0; j < COUNT_OF(words); j++) {
+            words[j] = unit_random();
+        }
+        fprintf(
+            mfkey32_log,
+            "Sec %d key %c cuid 11223344 nt0 %08" PRIx32 " nr0 %08" PRIx32 " ar0 %08" PRIx32
+            " nt1 %08" PRIx32 " nr1 %08" PRIx32 " ar1 %08" PRIx32 "%s\n",
+            i % 40,
+            (i % 3) ? 'A' : 'B',
+            words[0],
+            words[1],
+            words[2],
+            words[3],
+            words[4],
+            words[5],
+            (i % 4) ? "" : " par0 01101001");
+        if(i % 2) {
+            fprintf(
+                nested_log,
+                "Sec %d key A cuid 11223344 nt0 %08" PRIx32 " ks0 %08" PRIx32
+                " par0 0110 nt1 %08" PRIx32 " ks1 %08" PRIx32 " par1 1001 dist 0\n",
+                i % 40,
+                words[0],
+                words[1],
+                words[2],
+                words[3]);
+        } else {
+            // Only "dist 0" lines are nonces
+            fprintf(
+                nested_log,
+                "Sec %d key A cuid 11223344 nt0 %08" PRIx32 " ks0 %08" PRIx32 " par0 0110 %s\n",
+                i % 40,
+                words[0],
+                words[1],
+                (i % 6) ? "dist 0" : "dist 160");
+        }
+    }
+    fclose(mfkey32_log);
+    fclose(nested_log);
+}
+
+typedef struct {
+    MfClassicNonceArray* nonce_arr;
+    ProgramState* program_state;
+    uint64_t ns;
+} UnitCacheLoad;
+
+static void unit_cache_load(UnitCacheLoad* load) {
+    const MfkeyPlugin* plugin = init_plugin_ep()->entry_point;
+    load->program_state = malloc(sizeof(ProgramState));
+    uint64_t start = unit_ns();
+    load->program_state->mfkey32_present =
+        plugin->napi_mf_classic_mfkey32_nonces_check_presence();
+    load->program_state->nested_present = plugin->napi_mf_classic_nested_nonces_check_presence();
+    KeysDict* user_dict =
+        keys_dict_alloc(KEYS_DICT_USER_PATH, KeysDictModeOpenAlways, sizeof(MfClassicKey));
+    load->nonce_arr =
+        plugin->napi_mf_classic_nonce_array_alloc(NULL, false, user_dict, load->program_state);
+    keys_dict_free(user_dict);
+    load->ns = unit_ns() - start;
+}
+
+static void unit_cache_free(UnitCacheLoad* load) {
+    unit_free_nonces(load->nonce_arr);
+    free(load->program_state);
+}
+
+static bool unit_cache_same(const UnitCacheLoad* a, const UnitCacheLoad* b, const char* step) {
+    const MfClassicNonceArray* arr_a = a->nonce_arr;
+    const MfClassicNonceArray* arr_b = b->nonce_arr;
+    bool same = (arr_a->total_nonces == arr_b->total_nonces) &&
+                (arr_a->log_nonces == arr_b->log_nonces) &&
+                (arr_a->log_hash == arr_b->log_hash) &&
+                (a->program_state->total == b->program_state->total) &&
+                (memcmp(arr_a->remaining_nonce_array,
+                        arr_b->remaining_nonce_array,
+                        sizeof(MfClassicNonce) * arr_a->total_nonces) == 0);
+    if(!same) {
+        printf(
+            "FAIL nonce_cache: %s, %" PRIu32 " nonces hash %08" PRIX32 ", parsed %" PRIu32
+            " hash %08" PRIX32 "\n",
+            step,
+            arr_b->total_nonces,
+            arr_b->log_hash,
+            arr_a->total_nonces,
+            arr_a->log_hash);
+    }
+    return same;
+}
+
+static bool unit_test_nonce_cache(void) {
+    if(!unit_setup("mfkey32")) return false;
+    unit_cache_write_logs(UNIT_CACHE_NONCES);
+
+    // Parsed from the logs, which writes both caches
+    UnitCacheLoad parsed, cached, reparsed;
+    unit_cache_load(&parsed);
+    unit_cache_load(&cached);
+    bool passed = unit_cache_same(&parsed, &cached, "loaded from the cache");
+    uint64_t parsed_ns = parsed.ns;
+    uint64_t cached_ns = cached.ns;
+    uint32_t nonces = parsed.nonce_arr->total_nonces;
+    unit_cache_free(&cached);
+
+    // A cache cut short while it was written is dropped and the log parsed again
+    if(passed) {
+        passed = truncate(MFKEY_TEST_EXT "nfc/.nested.cache", 100) == 0;
+        unit_cache_load(&reparsed);
+        passed = passed && unit_cache_same(&parsed, &reparsed, "after a cut short cache");
+        unit_cache_free(&reparsed);
+    }
+    unit_cache_free(&parsed);
+
+    // A log that grew makes its cache stale
+    if(passed) {
+        FILE* log = fopen(MFKEY_TEST_EXT "nfc/.mfkey32.log", "a");
+        fprintf(
+            log,
+            "Sec 1 key A cuid 11223344 nt0 01202034 nr0 01cc053f ar0 fceaf464 nt1 caff23a7 "
+            "nr1 5b580519 ar1 082e996e\n");
+        fclose(log);
+        unit_cache_load(&reparsed);
+        unit_cache_load(&cached);
+        passed = (reparsed.nonce_arr->total_nonces == nonces + 1) &&
+                 unit_cache_same(&reparsed, &cached, "after the log grew");
+        if(reparsed.nonce_arr->total_nonces != nonces + 1) {
+            printf(
+                "FAIL nonce_cache: %" PRIu32 " nonces after the log grew, expected %" PRIu32
+                "\n",
+                reparsed.nonce_arr->total_nonces,
+                nonces + 1);
+        }
+        unit_cache_free(&reparsed);
+        unit_cache_free(&cached);
+    }
+
+    if(passed) {
+        printf(
+            "ok   nonce_cache: %d log lines, %" PRIu32 " nonces, %.1f ms parsed, %.1f ms cached\n",
+            2 * UNIT_CACHE_NONCES,
+            nonces,
+            parsed_ns / 1e6,
+            cached_ns / 1e6);
+    }
+    return passed;
+}
+
+// MSB table planner
+
+typedef struct {
+    size_t free_heap;
+    size_t max_free_block; // 0 for an unfragmented heap
+    int limit; // Buckets per round, 0 if nothing fits
+} UnitPlanCase;
+
+// Each bucket count needs 2 * 3076 bytes of tables and 14336 bytes of fixed buffers
+static const UnitPlanCase unit_plan_cases[] = {
+    {200000, 0, 16},
+    {112768, 0, 16},
+    {112767, 0, 15},
+    {100000, 0, 13},
+    {80000, 0, 10},
+    {60000, 0, 7},
+    {45000, 0, 4},
+    {22000, 0, 1},
+    {20487, 0, 0},
+    // Fragmented, the largest block bounds the table size
+    {200000, 30000, 9},
+    {200000, 5120, 1},
+    // The 5120 byte buffers don't fit
+    {200000, 5119, 0},
+};
+
+static bool unit_plan_no_stop(MsbPartition* partition, MsbPartitionEvent event, void* context) {
+    UNUSED(partition);
+    UNUSED(event);
+    UNUSED(context);
+    return false;
+}
+
+// Time of the first round with the planned tables, on the first nonce of a vector
+static uint64_t unit_plan_round_ns(void** blocks, int limit, const MfClassicNonce* nonce) {
+    Profile profile = {0};
+    MsbPartition partition = {
+        .nonce = *nonce,
+        .profile = &profile,
+        .tables =
+            {
+                .odd_msbs = blocks[0],
+                .even_msbs = blocks[1],
+                .temp_states_odd = blocks[2],
+                .temp_states_even = blocks[3],
+                .states_buffer = blocks[4],
+                .msb_limit = limit,
+            },
+        .callback = unit_plan_no_stop,
+    };
+    int ks_enc, oks, eks;
+    unsigned int in;
+    unit_nonce_keystream(&partition.nonce, &ks_enc, &in);
+    msb_keystream_split(ks_enc, &oks, &eks);
+    uint64_t start = unit_ns();
+    recover_msb_range(&partition, oks, eks, in, 0, 0);
+    return unit_ns() - start;
+}
+
+static bool unit_test_msb_planner(void) {
+    // Trimming keeps the round count and never adds buckets
+    for(int limit = 1; limit <= MSB_LIMIT_MAX; limit++) {
+        int rounds = msb_rounds(limit);
+        int trimmed = (256 + rounds - 1) / rounds;
+        if((trimmed > limit) || (msb_rounds(trimmed) != rounds)) {
+            printf("FAIL msb_planner: %d buckets trimmed to %d\n", limit, trimmed);
+            return false;
+        }
+    }
+
+    ProgramState* program_state = malloc(sizeof(ProgramState));
+    MfClassicNonceArray* nonce_arr = unit_load_nonces("static_nested", program_state);
+    bool passed = nonce_arr != NULL;
+    uint64_t round_ns[MSB_LIMIT_MAX + 1] = {0};
+    for(size_t i = 0; passed && (i < COUNT_OF(unit_plan_cases)); i++) {
+        const UnitPlanCase* plan = &unit_plan_cases[i];
+        sdk_stub_set_heap(plan->free_heap, plan->max_free_block);
+        int limit = 0;
+        void** blocks = allocate_msb_tables(&limit);
+        sdk_stub_set_heap(0, 0);
+        if(!blocks) limit = 0;
+        if(limit != plan->limit) {
+            printf(
+                "FAIL msb_planner: heap %zu, largest block %zu, %d buckets, expected %d\n",
+                plan->free_heap,
+                plan->max_free_block,
+                limit,
+                plan->limit);
+            passed = false;
+        } else if(!blocks) {
+            printf(
+                "ok   msb_planner: heap %zu, largest block %zu, no tables fit\n",
+                plan->free_heap,
+                plan->max_free_block ? plan->max_free_block : plan->free_heap);
+        } else {
+            if(!round_ns[limit]) {
+                round_ns[limit] =
+                    unit_plan_round_ns(blocks, limit, &nonce_arr->remaining_nonce_array[0]);
+            }
+            printf(
+                "ok   msb_planner: heap %zu, largest block %zu, %d buckets, %d rounds, "
+                "%.1f s per nonce here\n",
+                plan->free_heap,
+                plan->max_free_block ? plan->max_free_block : plan->free_heap,
+                limit,
+                msb_rounds(limit),
+                round_ns[limit] * msb_rounds(limit) / 1e9);
+        }
+        if(blocks) {
+            for(int j = 0; j < 5; j++) {
+                free(blocks[j]);
+            }
+            free(blocks);
+        }
+    }
+    if(nonce_arr) unit_free_nonces(nonce_arr);
+    free(program_state);
+    return passed;
+}
+
+// Nonce scheduling
+
+#define UNIT_SCHEDULE_SECTORS 16
+#define UNIT_SCHEDULE_UID     0x11223344
+
+typedef struct {
+    int searches[3]; // recover() runs, indexed by AttackType
+    int cracked;
+    int completed;
+    uint32_t device_ms; // Built-in round estimates, a hit takes half the rounds
+} UnitScheduleRun;
+
+static void unit_schedule_add(
+    MfClassicNonceArray* nonce_arr,
+    uint64_t key,
+    AttackType attack,
+    int sector,
+    const MfClassicNonce* repeat_of) {
+    MfClassicNonce nonce;
+    if(repeat_of) {
+        nonce = *repeat_of;
+    } else {
+        unit_dict_nonce(key, attack, &nonce);
+        nonce.uid = UNIT_SCHEDULE_UID;
+        nonce.sector = sector;
+        nonce.key_type = MfClassicKeyTypeA;
+        nonce.nt0 = unit_random();
+        nonce.nt1 = unit_random();
+        if(attack == mfkey32) {
+            nonce.nr0_enc = unit_random();
+            nonce.ar0_enc = unit_random();
+        } else {
+            nonce.par_1 = unit_random() & 0xF;
+            if(attack == static_nested) {
+                // The second nonce is the one static nested recovers from
+                struct Crypto1State s;
+                unit_key_state(key, &s);
+                nonce.uid_xor_nt1 = unit_random();
+                nonce.ks1_2_enc = crypt_word_ret(&s, nonce.uid_xor_nt1, 0);
+            }
+        }
+    }
+    nonce.log_index = nonce_arr->total_nonces;
+    nonce_arr->remaining_nonce_array = realloc(
+        nonce_arr->remaining_nonce_array, sizeof(MfClassicNonce) * (nonce_arr->total_nonces + 1));
+    nonce_arr->remaining_nonce_array[nonce_arr->total_nonces++] = nonce;
+    nonce_arr->remaining_nonces++;
+}
+
+// Per sector, mfkey32 sectors: a wrong capture logged three times, then two good ones.
+// Nested sectors: a static encrypted capture and its repeat around a good and a wrong
+// static nested capture.
+static void unit_schedule_logs(MfClassicNonceArray* nonce_arr, uint64_t* keys) {
+    memset(nonce_arr, 0, sizeof(MfClassicNonceArray));
+    for(int sector = 0; sector < UNIT_SCHEDULE_SECTORS; sector++) {
+        keys[sector] = unit_random_key();
+        if(sector % 2 == 0) {
+            unit_schedule_add(nonce_arr, unit_random_key(), mfkey32, sector, NULL);
+            uint32_t wrong = nonce_arr->total_nonces - 1;
+            for(int i = 0; i < 2; i++) {
+                unit_schedule_add(
+                    nonce_arr, 0, mfkey32, sector, &nonce_arr->remaining_nonce_array[wrong]);
+            }
+            unit_schedule_add(nonce_arr, keys[sector], mfkey32, sector, NULL);
+            unit_schedule_add(nonce_arr, keys[sector], mfkey32, sector, NULL);
+        } else {
+            unit_schedule_add(nonce_arr, keys[sector], static_encrypted, sector, NULL);
+            uint32_t encrypted = nonce_arr->total_nonces - 1;
+            unit_schedule_add(nonce_arr, keys[sector], static_nested, sector, NULL);
+            unit_schedule_add(nonce_arr, unit_random_key(), static_nested, sector, NULL);
+            unit_schedule_add(
+                nonce_arr,
+                0,
+                static_encrypted,
+                sector,
+                &nonce_arr->remaining_nonce_array[encrypted]);
+        }
+    }
+}
+
+// What recover() gives: the key for a capture of it, except static encrypted, which only
+// yields candidates
+static bool unit_schedule_recover(
+    const MfClassicNonce* nonce,
+    const uint64_t* keys,
+    MfClassicKey* key,
+    UnitScheduleRun* run,
+    Profile* profile) {
+    bit_lib_num_to_bytes_be(keys[nonce->sector], sizeof(MfClassicKey), key->data);
+    bool found = (nonce->attack != static_encrypted) && key_matches_nonce(key, nonce);
+    uint32_t rounds = msb_rounds(MSB_LIMIT_MAX);
+    run->searches[nonce->attack]++;
+    uint32_t round_ms = profile_round_estimate(profile, nonce->attack);
+    run->device_ms += round_ms * (found ? rounds / 2 : rounds);
+    return found;
+}
+
+// The loop before scheduling: log order, a nonce is only skipped once a found key checks
+// out against it
+static void unit_schedule_log_order(
+    MfClassicNonceArray* nonce_arr,
+    const uint64_t* keys,
+    UnitScheduleRun* run,
+    Profile* profile) {
+    MfClassicKey found[UNIT_SCHEDULE_SECTORS * 8];
+    int found_count = 0;
+    for(uint32_t i = 0; i < nonce_arr->total_nonces; i++) {
+        MfClassicNonce* nonce = &nonce_arr->remaining_nonce_array[i];
+        run->completed++;
+        if(key_already_found_for_nonce_in_solved(found, found_count, nonce)) {
+            run->cracked++;
+            continue;
+        }
+        MfClassicKey key;
+        if(unit_schedule_recover(nonce, keys, &key, run, profile)) {
+            found[found_count++] = key;
+            run->cracked++;
+        }
+    }
+}
+
+// The decisions mfkey() makes, without the searches
+static void unit_schedule_mfkey(
+    MfClassicNonceArray* nonce_arr,
+    const uint64_t* keys,
+    UnitScheduleRun* run,
+    Profile* profile) {
+    ProgramState* program_state = malloc(sizeof(ProgramState));
+    MfClassicKey found[UNIT_SCHEDULE_SECTORS * 8];
+    int found_count = 0;
+    qsort(
+        nonce_arr->remaining_nonce_array,
+        nonce_arr->total_nonces,
+        sizeof(MfClassicNonce),
+        nonce_schedule_sort_compare);
+    for(uint32_t i = 0; i < nonce_arr->total_nonces; i++) {
+        MfClassicNonce* nonce = &nonce_arr->remaining_nonce_array[i];
+        run->completed++;
+        if(nonce->solved || key_already_found_for_nonce_in_solved(found, found_count, nonce)) {
+            run->cracked++;
+            continue;
+        }
+        if(nonce->covered) continue;
+        if(nonce->attack == static_encrypted) {
+            static_encrypted_siblings_collect(nonce_arr, i, program_state);
+            free(program_state->sen_siblings);
+        }
+        MfClassicKey key;
+        if(!unit_schedule_recover(nonce, keys, &key, run, profile)) {
+            nonce_group_cancel(nonce_arr, i, NULL);
+            continue;
+        }
+        run->cracked++;
+        found[found_count++] = key;
+        nonce_group_cancel(nonce_arr, i, &key);
+    }
+    free(program_state);
+}
+
+static bool unit_test_nonce_schedule(void) {
+    MfClassicNonceArray log_order, scheduled;
+    uint64_t keys[UNIT_SCHEDULE_SECTORS];
+    unit_schedule_logs(&log_order, keys);
+    scheduled = log_order;
+    scheduled.remaining_nonce_array = malloc(sizeof(MfClassicNonce) * log_order.total_nonces);
+    memcpy(
+        scheduled.remaining_nonce_array,
+        log_order.remaining_nonce_array,
+        sizeof(MfClassicNonce) * log_order.total_nonces);
+
+    Profile profile = {.msb_limit = MSB_LIMIT_MAX};
+    UnitScheduleRun before = {0}, after = {0};
+    unit_schedule_log_order(&log_order, keys, &before, &profile);
+    unit_schedule_mfkey(&scheduled, keys, &after, &profile);
+
+    bool passed = true;
+    for(uint32_t i = 1; i < scheduled.total_nonces; i++) {
+        const MfClassicNonce* prev = &scheduled.remaining_nonce_array[i - 1];
+        const MfClassicNonce* next = &scheduled.remaining_nonce_array[i];
+        if((prev->attack > next->attack) ||
+           ((prev->attack == next->attack) && (prev->log_index >= next->log_index))) {
+            printf("FAIL nonce_schedule: out of order at %" PRIu32 "\n", i);
+            passed = false;
+        }
+    }
+    // Only captures of the sector key are cracked, the wrong ones are never solved
+    for(uint32_t i = 0; i < scheduled.total_nonces; i++) {
+        MfClassicNonce* nonce = &scheduled.remaining_nonce_array[i];
+        MfClassicKey key;
+        bit_lib_num_to_bytes_be(keys[nonce->sector], sizeof(MfClassicKey), key.data);
+        if(nonce->solved && !key_matches_nonce(&key, nonce)) {
+            printf(
+                "FAIL nonce_schedule: wrong capture %" PRIu32 " solved\n", nonce->log_index);
+            passed = false;
+        }
+    }
+    // A static encrypted capture searched first in log order stays uncracked, scheduled
+    // after the static nested one it is solved by its key
+    if(passed && ((after.cracked < before.cracked) || (after.completed != before.completed))) {
+        printf(
+            "FAIL nonce_schedule: cracked %d completed %d, log order %d %d\n",
+            after.cracked,
+            after.completed,
+            before.cracked,
+            before.completed);
+        passed = false;
+    }
+    int searches_before = before.searches[0] + before.searches[1] + before.searches[2];
+    int searches_after = after.searches[0] + after.searches[1] + after.searches[2];
+    if(passed && (searches_after > searches_before)) {
+        printf(
+            "FAIL nonce_schedule: %d searches, %d in log order\n",
+            searches_after,
+            searches_before);
+        passed = false;
+    }
+    if(passed) {
+        printf(
+            "ok   nonce_schedule: %" PRIu32 " nonces, %d -> %d cracked, searches "
+            "mfkey32/nested/encrypted %d/%d/%d -> %d/%d/%d, about %" PRIu32 " -> %" PRIu32
+            " min on the device\n",
+            scheduled.total_nonces,
+            before.cracked,
+            after.cracked,
+            before.searches[mfkey32],
+            before.searches[static_nested],
+            before.searches[static_encrypted],
+            after.searches[mfkey32],
+            after.searches[static_nested],
+            after.searches[static_encrypted],
+            before.device_ms / 60000,
+            after.device_ms / 60000);
+    }
+    free(log_order.remaining_nonce_array);
+    free(scheduled.remaining_nonce_array);
+    return passed;
+}
+
+static const MfkeyUnitCase mfkey_unit_cases[] = {
+    {"msb_dedup", unit_test_msb_dedup},
+    {"crypto1_bs", unit_test_crypto1_bs},
+    {"check_state_batch", unit_test_check_state_batch},
+    {"check_state_bench", unit_test_check_state_bench},
+    {"dict_cache", unit_test_dict_cache},
+    {"key_sink", unit_test_key_sink},
+    {"introsort", unit_test_introsort},
+    {"nonce_cache", unit_test_nonce_cache},
+    {"msb_planner", unit_test_msb_planner},
+    {"nonce_schedule", unit_test_nonce_schedule},
+};
+
+int main(void) {
+    size_t failed = 0;
+    for(size_t i = 0; i < COUNT_OF(mfkey_unit_cases); i++) {
+        if(!mfkey_unit_cases[i].test()) failed++;
+    }
+
+    size_t count = COUNT_OF(mfkey_unit_cases);
+    printf("%zu of %zu unit tests passed\n", count - failed, count);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <furi.h>
+
+uint64_t bit_lib_bytes_to_num_be(const uint8_t* src, uint8_t len);
+void bit_lib_num_to_bytes_be(uint64_t src, uint8_t len, uint8_t* dest);
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <furi.h>
+
+typedef enum {
+    DolphinDeedNfcMfcAdd,
+} DolphinDeed;
+
+void dolphin_deed(DolphinDeed deed);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <storage/storage.h>
+
+// The init plugin is linked into the test, loading it returns its descriptor
+
+typedef struct FlipperApplication FlipperApplication;
+
+typedef struct {
+    const char* appid;
+    uint32_t ep_api_version;
+    const void* entry_point;
+} FlipperAppPluginDescriptor;
+
+FlipperApplication* flipper_application_alloc(Storage* storage, const void* api_interface);
+void flipper_application_free(FlipperApplication* app);
+int flipper_application_preload(FlipperApplication* app, const char* path);
+int flipper_application_map_to_memory(FlipperApplication* app);
+const FlipperAppPluginDescriptor*
+    flipper_application_plugin_get_descriptor(FlipperApplication* app);
@@ -0,0 +1,94 @@
+#pragma once
+
+// Host stand-in for the parts of the Flipper SDK mfkey uses
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <assert.h>
+
+// Zeroed like the firmware allocator
+#define malloc(size) calloc(1, (size))
+
+#define furi_assert(x) assert(x)
+#define furi_check(x)  assert(x)
+#define UNUSED(x)      (void)(x)
+#define COUNT_OF(x)    (sizeof(x) / sizeof((x)[0]))
+#define MAX(a, b)      ((a) > (b) ? (a) : (b))
+#define MIN(a, b)      ((a) < (b) ? (a) : (b))
+
+// The SD card is a directory next to the test, set by the Makefile
+#define EXT_PATH(path)        MFKEY_TEST_EXT path
+#define APP_DATA_PATH(path)   MFKEY_TEST_EXT "apps_data/mfkey/" path
+#define APP_ASSETS_PATH(path) MFKEY_TEST_EXT "apps_assets/mfkey/" path
+
+#define FURI_LOG_E(tag, ...) ((void)0)
+#define FURI_LOG_W(tag, ...) ((void)0)
+#define FURI_LOG_I(tag, ...) ((void)0)
+#define FURI_LOG_D(tag, ...) ((void)0)
+#define FURI_LOG_T(tag, ...) ((void)0)
+
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef enum {
+    FuriStatusOk,
+    FuriStatusError,
+} FuriStatus;
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+uint32_t furi_get_tick(void);
+uint32_t furi_kernel_get_tick_frequency(void);
+
+size_t memmgr_get_free_heap(void);
+size_t memmgr_heap_get_max_free_block(void);
+
+typedef struct FuriMutex FuriMutex;
+
+typedef enum {
+    FuriMutexTypeNormal,
+} FuriMutexType;
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* instance);
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* instance);
+
+typedef struct FuriThread FuriThread;
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+
+typedef struct FuriMessageQueue FuriMessageQueue;
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size);
+void furi_message_queue_free(FuriMessageQueue* instance);
+FuriStatus furi_message_queue_put(FuriMessageQueue* instance, const void* msg, uint32_t timeout);
+FuriStatus furi_message_queue_get(FuriMessageQueue* instance, void* msg, uint32_t timeout);
+
+typedef struct FuriString FuriString;
+
+#define FURI_STRING_FAILURE ((size_t)-1)
+
+FuriString* furi_string_alloc(void);
+FuriString* furi_string_alloc_printf(const char* format, ...);
+void furi_string_free(FuriString* string);
+const char* furi_string_get_cstr(const FuriString* string);
+size_t furi_string_size(const FuriString* string);
+void furi_string_reset(FuriString* string);
+void furi_string_printf(FuriString* string, const char* format, ...);
+void furi_string_cat_printf(FuriString* string, const char* format, ...);
+bool furi_string_start_with_str(const FuriString* string, const char* start);
+size_t furi_string_search_str(const FuriString* string, const char* needle, ...);
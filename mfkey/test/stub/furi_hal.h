@@ -0,0 +1,6 @@
+#pragma once
+
+#include <furi.h>
+
+uint32_t furi_hal_rtc_get_timestamp(void);
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "gui.h"
+
+void elements_progress_bar(Canvas* canvas, int32_t x, int32_t y, size_t width, float progress);
+void elements_progress_bar_with_text(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    float progress,
+    const char* text);
+void elements_button_center(Canvas* canvas, const char* str);
+void elements_button_right(Canvas* canvas, const char* str);
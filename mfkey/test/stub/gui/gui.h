@@ -0,0 +1,75 @@
+#pragma once
+
+#include <furi.h>
+
+#define RECORD_GUI "gui"
+
+typedef struct Gui Gui;
+typedef struct Canvas Canvas;
+typedef struct ViewPort ViewPort;
+typedef struct Icon Icon;
+
+typedef enum {
+    GuiLayerFullscreen,
+} GuiLayer;
+
+typedef enum {
+    AlignLeft,
+    AlignRight,
+    AlignTop,
+    AlignBottom,
+    AlignCenter,
+} Align;
+
+typedef enum {
+    FontPrimary,
+    FontSecondary,
+} Font;
+
+typedef enum {
+    InputTypePress,
+} InputType;
+
+typedef enum {
+    InputKeyUp,
+    InputKeyDown,
+    InputKeyRight,
+    InputKeyLeft,
+    InputKeyOk,
+    InputKeyBack,
+} InputKey;
+
+typedef struct {
+    InputType type;
+    InputKey key;
+} InputEvent;
+
+typedef void (*ViewPortDrawCallback)(Canvas* canvas, void* context);
+typedef void (*ViewPortInputCallback)(InputEvent* event, void* context);
+
+void canvas_set_font(Canvas* canvas, Font font);
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str);
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon);
+
+ViewPort* view_port_alloc(void);
+void view_port_free(ViewPort* view_port);
+void view_port_draw_callback_set(
+    ViewPort* view_port,
+    ViewPortDrawCallback callback,
+    void* context);
+void view_port_input_callback_set(
+    ViewPort* view_port,
+    ViewPortInputCallback callback,
+    void* context);
+void view_port_update(ViewPort* view_port);
+void view_port_enabled_set(ViewPort* view_port, bool enabled);
+
+void gui_add_view_port(Gui* gui, ViewPort* view_port, GuiLayer layer);
+void gui_remove_view_port(Gui* gui, ViewPort* view_port);
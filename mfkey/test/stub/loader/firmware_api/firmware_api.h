@@ -0,0 +1,3 @@
+#pragma once
+
+extern const void* firmware_api_interface;
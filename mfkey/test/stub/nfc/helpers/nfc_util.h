@@ -0,0 +1,7 @@
+#pragma once
+
+#include <furi.h>
+
+uint8_t nfc_util_even_parity8(uint8_t data);
+uint8_t nfc_util_even_parity32(uint32_t data);
+uint8_t nfc_util_odd_parity8(uint8_t data);
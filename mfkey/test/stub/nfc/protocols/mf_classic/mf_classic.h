@@ -0,0 +1,14 @@
+#pragma once
+
+#include <furi.h>
+
+#define MF_CLASSIC_KEY_SIZE (6)
+
+typedef enum {
+    MfClassicKeyTypeA,
+    MfClassicKeyTypeB,
+} MfClassicKeyType;
+
+typedef struct {
+    uint8_t data[MF_CLASSIC_KEY_SIZE];
+} MfClassicKey;
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct NotificationApp NotificationApp;
+typedef struct NotificationSequence NotificationSequence;
+
+extern const NotificationSequence sequence_audiovisual_alert;
+extern const NotificationSequence sequence_display_backlight_on;
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence);
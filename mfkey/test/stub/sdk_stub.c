@@ -0,0 +1,714 @@
+#define _GNU_SOURCE // vasprintf
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <toolbox/stream/file_stream.h>
+#include <toolbox/stream/buffered_file_stream.h>
+#include <toolbox/keys_dict.h>
+#include <nfc/helpers/nfc_util.h>
+#include <nfc/protocols/mf_classic/mf_classic.h>
+#include <bit_lib/bit_lib.h>
+#include <gui/elements.h>
+#include <notification/notification_messages.h>
+#include <dolphin/dolphin.h>
+#include <flipper_application/flipper_application.h>
+#include <loader/firmware_api/firmware_api.h>
+#include <mfkey_icons.h>
+#include "sdk_stub.h"
+
+#include <stdarg.h>
+#include <time.h>
+#include <sys/stat.h>
+
+// Heap left to the app on the device, the recovery sizes its tables from it
+#define SDK_STUB_HEAP_SIZE (200 * 1000)
+
+// Core
+
+void* furi_record_open(const char* name) {
+    UNUSED(name);
+    return NULL;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+uint32_t furi_get_tick(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+static size_t sdk_stub_free_heap = SDK_STUB_HEAP_SIZE;
+static size_t sdk_stub_max_free_block = SDK_STUB_HEAP_SIZE;
+
+void sdk_stub_set_heap(size_t free_heap, size_t max_free_block) {
+    sdk_stub_free_heap = free_heap ? free_heap : SDK_STUB_HEAP_SIZE;
+    sdk_stub_max_free_block = max_free_block ? max_free_block : sdk_stub_free_heap;
+}
+
+size_t memmgr_get_free_heap(void) {
+    return sdk_stub_free_heap;
+}
+
+size_t memmgr_heap_get_max_free_block(void) {
+    return sdk_stub_max_free_block;
+}
+
+uint32_t furi_hal_rtc_get_timestamp(void) {
+    return time(NULL);
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return 64;
+}
+
+// The attack runs on the test thread, there is nothing to lock or to wait for
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    UNUSED(type);
+    return NULL;
+}
+
+void furi_mutex_free(FuriMutex* instance) {
+    UNUSED(instance);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout) {
+    UNUSED(instance);
+    UNUSED(timeout);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* instance) {
+    UNUSED(instance);
+    return FuriStatusOk;
+}
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    UNUSED(name);
+    UNUSED(stack_size);
+    UNUSED(callback);
+    UNUSED(context);
+    return NULL;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    UNUSED(thread);
+}
+
+void furi_thread_start(FuriThread* thread) {
+    UNUSED(thread);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    UNUSED(thread);
+    return true;
+}
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size) {
+    UNUSED(msg_count);
+    UNUSED(msg_size);
+    return NULL;
+}
+
+void furi_message_queue_free(FuriMessageQueue* instance) {
+    UNUSED(instance);
+}
+
+FuriStatus furi_message_queue_put(FuriMessageQueue* instance, const void* msg, uint32_t timeout) {
+    UNUSED(instance);
+    UNUSED(msg);
+    UNUSED(timeout);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_message_queue_get(FuriMessageQueue* instance, void* msg, uint32_t timeout) {
+    UNUSED(instance);
+    UNUSED(msg);
+    UNUSED(timeout);
+    return FuriStatusError;
+}
+
+// FuriString
+
+struct FuriString {
+    char* data;
+};
+
+static void furi_string_vprintf(FuriString* string, const char* format, va_list args) {
+    free(string->data);
+    if(vasprintf(&string->data, format, args) < 0) abort();
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = malloc(sizeof(FuriString));
+    string->data = strdup("");
+    return string;
+}
+
+FuriString* furi_string_alloc_printf(const char* format, ...) {
+    FuriString* string = furi_string_alloc();
+    va_list args;
+    va_start(args, format);
+    furi_string_vprintf(string, format, args);
+    va_end(args);
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return strlen(string->data);
+}
+
+void furi_string_reset(FuriString* string) {
+    string->data[0] = '\0';
+}
+
+void furi_string_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    furi_string_vprintf(string, format, args);
+    va_end(args);
+}
+
+void furi_string_cat_printf(FuriString* string, const char* format, ...) {
+    char* tail;
+    va_list args;
+    va_start(args, format);
+    if(vasprintf(&tail, format, args) < 0) abort();
+    va_end(args);
+    size_t length = strlen(string->data);
+    string->data = realloc(string->data, length + strlen(tail) + 1);
+    strcpy(string->data + length, tail);
+    free(tail);
+}
+
+bool furi_string_start_with_str(const FuriString* string, const char* start) {
+    return strncmp(string->data, start, strlen(start)) == 0;
+}
+
+size_t furi_string_search_str(const FuriString* string, const char* needle, ...) {
+    const char* found = strstr(string->data, needle);
+    return found ? (size_t)(found - string->data) : FURI_STRING_FAILURE;
+}
+
+// Storage, on the host file system
+
+struct File {
+    FILE* file;
+};
+
+struct Stream {
+    FILE* file;
+    char path[256];
+};
+
+static SdkStubWriteCallback sdk_stub_write_callback;
+static void* sdk_stub_write_context;
+
+void sdk_stub_set_write_callback(SdkStubWriteCallback callback, void* context) {
+    sdk_stub_write_callback = callback;
+    sdk_stub_write_context = context;
+}
+
+static const char* sdk_stub_fopen_mode(FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    if(open_mode & FSOM_CREATE_ALWAYS) return (access_mode & FSAM_READ) ? "w+" : "w";
+    if(open_mode & (FSOM_OPEN_APPEND | FSOM_OPEN_ALWAYS)) return "a+";
+    return (access_mode & FSAM_WRITE) ? "r+" : "r";
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
+    UNUSED(storage);
+    struct stat file_stat;
+    if(stat(path, &file_stat)) return FSE_NOT_EXIST;
+    if(fileinfo) fileinfo->size = file_stat.st_size;
+    return FSE_OK;
+}
+
+FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp) {
+    UNUSED(storage);
+    struct stat file_stat;
+    if(stat(path, &file_stat)) return FSE_NOT_EXIST;
+    *timestamp = file_stat.st_mtime;
+    return FSE_OK;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    return remove(path) ? FSE_NOT_EXIST : FSE_OK;
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    UNUSED(storage);
+    return rename(old_path, new_path) ? FSE_INTERNAL : FSE_OK;
+}
+
+bool storage_simply_mkdir(Storage* storage, const char* path) {
+    UNUSED(storage);
+    mkdir(path, 0777);
+    return true;
+}
+
+bool storage_simply_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    remove(path);
+    return true;
+}
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return malloc(sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    free(file);
+}
+
+bool storage_file_open(
+    File* file,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode) {
+    file->file = fopen(path, sdk_stub_fopen_mode(access_mode, open_mode));
+    return file->file != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(file->file) fclose(file->file);
+    file->file = NULL;
+    return true;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    return fread(buff, 1, bytes_to_read, file->file);
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    return fwrite(buff, 1, bytes_to_write, file->file);
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    return fseek(file->file, offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    long position = ftell(file->file);
+    fseek(file->file, 0, SEEK_END);
+    long size = ftell(file->file);
+    fseek(file->file, position, SEEK_SET);
+    return size;
+}
+
+bool storage_file_eof(File* file) {
+    return feof(file->file);
+}
+
+bool storage_file_sync(File* file) {
+    return fflush(file->file) == 0;
+}
+
+Stream* file_stream_alloc(Storage* storage) {
+    UNUSED(storage);
+    return malloc(sizeof(Stream));
+}
+
+Stream* buffered_file_stream_alloc(Storage* storage) {
+    return file_stream_alloc(storage);
+}
+
+bool file_stream_open(
+    Stream* stream,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode) {
+    stream->file = fopen(path, sdk_stub_fopen_mode(access_mode, open_mode));
+    snprintf(stream->path, sizeof(stream->path), "%s", path);
+    // Append mode writes at the end, reading starts at the beginning like the firmware
+    if(stream->file && (open_mode & FSOM_OPEN_ALWAYS)) fseek(stream->file, 0, SEEK_SET);
+    return stream->file != NULL;
+}
+
+bool buffered_file_stream_open(
+    Stream* stream,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode) {
+    return file_stream_open(stream, path, access_mode, open_mode);
+}
+
+bool file_stream_close(Stream* stream) {
+    if(stream->file) fclose(stream->file);
+    stream->file = NULL;
+    return true;
+}
+
+bool buffered_file_stream_close(Stream* stream) {
+    return file_stream_close(stream);
+}
+
+void stream_free(Stream* stream) {
+    free(stream);
+}
+
+bool stream_eof(Stream* stream) {
+    int c = fgetc(stream->file);
+    if(c == EOF) return true;
+    ungetc(c, stream->file);
+    return false;
+}
+
+bool stream_rewind(Stream* stream) {
+    return fseek(stream->file, 0, SEEK_SET) == 0;
+}
+
+bool stream_seek(Stream* stream, int32_t offset, StreamOffset offset_type) {
+    int whence = (offset_type == StreamOffsetFromStart) ? SEEK_SET :
+                 (offset_type == StreamOffsetFromEnd)   ? SEEK_END :
+                                                          SEEK_CUR;
+    return fseek(stream->file, offset, whence) == 0;
+}
+
+size_t stream_tell(Stream* stream) {
+    return ftell(stream->file);
+}
+
+size_t stream_size(Stream* stream) {
+    long position = ftell(stream->file);
+    fseek(stream->file, 0, SEEK_END);
+    long size = ftell(stream->file);
+    fseek(stream->file, position, SEEK_SET);
+    return size;
+}
+
+size_t stream_read(Stream* stream, uint8_t* data, size_t size) {
+    return fread(data, 1, size, stream->file);
+}
+
+bool stream_read_line(Stream* stream, FuriString* str_result) {
+    char line[256];
+    if(!fgets(line, sizeof(line), stream->file)) return false;
+    furi_string_printf(str_result, "%s", line);
+    return true;
+}
+
+size_t stream_write(Stream* stream, const uint8_t* data, size_t size) {
+    // Switching from reading to writing needs a seek
+    fseek(stream->file, 0, SEEK_CUR);
+    size_t written = fwrite(data, 1, size, stream->file);
+    fflush(stream->file);
+    if(sdk_stub_write_callback) {
+        sdk_stub_write_callback(stream->path, sdk_stub_write_context);
+    }
+    return written;
+}
+
+size_t stream_write_char(Stream* stream, char c) {
+    return stream_write(stream, (const uint8_t*)&c, 1);
+}
+
+size_t stream_write_cstring(Stream* stream, const char* string) {
+    return stream_write(stream, (const uint8_t*)string, strlen(string));
+}
+
+size_t stream_write_string(Stream* stream, FuriString* string) {
+    return stream_write_cstring(stream, furi_string_get_cstr(string));
+}
+
+// KeysDict
+
+struct KeysDict {
+    Stream* stream;
+    size_t total_keys;
+};
+
+static bool keys_dict_is_key_line(FuriString* line) {
+    const char* data = furi_string_get_cstr(line);
+    return (data[0] != '#') && (strlen(data) >= MF_CLASSIC_KEY_SIZE * 2);
+}
+
+bool keys_dict_check_presence(const char* path) {
+    struct stat file_stat;
+    return stat(path, &file_stat) == 0;
+}
+
+KeysDict* keys_dict_alloc(const char* path, KeysDictMode mode, size_t key_size) {
+    UNUSED(key_size);
+    KeysDict* instance = malloc(sizeof(KeysDict));
+    instance->stream = buffered_file_stream_alloc(NULL);
+    FS_OpenMode open_mode = (mode == KeysDictModeOpenAlways) ? FSOM_OPEN_ALWAYS :
+                                                               FSOM_OPEN_EXISTING;
+    if(!buffered_file_stream_open(instance->stream, path, FSAM_READ_WRITE, open_mode)) abort();
+
+    FuriString* line = furi_string_alloc();
+    while(stream_read_line(instance->stream, line)) {
+        if(keys_dict_is_key_line(line)) instance->total_keys++;
+    }
+    furi_string_free(line);
+    stream_rewind(instance->stream);
+    return instance;
+}
+
+void keys_dict_free(KeysDict* instance) {
+    buffered_file_stream_close(instance->stream);
+    stream_free(instance->stream);
+    free(instance);
+}
+
+size_t keys_dict_get_total_keys(KeysDict* instance) {
+    return instance->total_keys;
+}
+
+bool keys_dict_rewind(KeysDict* instance) {
+    return stream_rewind(instance->stream);
+}
+
+bool keys_dict_get_next_key(KeysDict* instance, uint8_t* key, size_t key_size) {
+    FuriString* line = furi_string_alloc();
+    bool key_read = false;
+    while(stream_read_line(instance->stream, line)) {
+        if(!keys_dict_is_key_line(line)) continue;
+        uint64_t value = strtoull(furi_string_get_cstr(line), NULL, 16);
+        bit_lib_num_to_bytes_be(value, key_size, key);
+        key_read = true;
+        break;
+    }
+    furi_string_free(line);
+    return key_read;
+}
+
+bool keys_dict_add_key(KeysDict* instance, const uint8_t* key, size_t key_size) {
+    FuriString* line = furi_string_alloc();
+    for(size_t i = 0; i < key_size; i++) {
+        furi_string_cat_printf(line, "%02X", key[i]);
+    }
+    furi_string_cat_printf(line, "\n");
+    stream_seek(instance->stream, 0, StreamOffsetFromEnd);
+    stream_write_string(instance->stream, line);
+    furi_string_free(line);
+    instance->total_keys++;
+    return true;
+}
+
+bool keys_dict_is_key_present(KeysDict* instance, const uint8_t* key, size_t key_size) {
+    uint8_t dict_key[MF_CLASSIC_KEY_SIZE];
+    keys_dict_rewind(instance);
+    while(keys_dict_get_next_key(instance, dict_key, key_size)) {
+        if(memcmp(dict_key, key, key_size) == 0) return true;
+    }
+    return false;
+}
+
+// NFC helpers
+
+uint8_t nfc_util_even_parity8(uint8_t data) {
+    return __builtin_parity(data);
+}
+
+uint8_t nfc_util_even_parity32(uint32_t data) {
+    return __builtin_parity(data);
+}
+
+uint8_t nfc_util_odd_parity8(uint8_t data) {
+    return !__builtin_parity(data);
+}
+
+uint64_t bit_lib_bytes_to_num_be(const uint8_t* src, uint8_t len) {
+    uint64_t value = 0;
+    for(uint8_t i = 0; i < len; i++) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+void bit_lib_num_to_bytes_be(uint64_t src, uint8_t len, uint8_t* dest) {
+    for(int i = len - 1; i >= 0; i--) {
+        dest[i] = src & 0xFF;
+        src >>= 8;
+    }
+}
+
+// GUI, notifications and the plugin loader, nothing to show or to load
+
+struct Icon {
+    uint8_t unused;
+};
+
+struct NotificationSequence {
+    uint8_t unused;
+};
+
+const Icon I_mfkey;
+const NotificationSequence sequence_audiovisual_alert;
+const NotificationSequence sequence_display_backlight_on;
+const void* firmware_api_interface;
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    UNUSED(canvas);
+    UNUSED(font);
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(height);
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str) {
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(horizontal);
+    UNUSED(vertical);
+    UNUSED(str);
+}
+
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon) {
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(icon);
+}
+
+void elements_progress_bar(Canvas* canvas, int32_t x, int32_t y, size_t width, float progress) {
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(progress);
+}
+
+void elements_progress_bar_with_text(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    float progress,
+    const char* text) {
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(progress);
+    UNUSED(text);
+}
+
+void elements_button_center(Canvas* canvas, const char* str) {
+    UNUSED(canvas);
+    UNUSED(str);
+}
+
+void elements_button_right(Canvas* canvas, const char* str) {
+    UNUSED(canvas);
+    UNUSED(str);
+}
+
+ViewPort* view_port_alloc(void) {
+    return NULL;
+}
+
+void view_port_free(ViewPort* view_port) {
+    UNUSED(view_port);
+}
+
+void view_port_draw_callback_set(
+    ViewPort* view_port,
+    ViewPortDrawCallback callback,
+    void* context) {
+    UNUSED(view_port);
+    UNUSED(callback);
+    UNUSED(context);
+}
+
+void view_port_input_callback_set(
+    ViewPort* view_port,
+    ViewPortInputCallback callback,
+    void* context) {
+    UNUSED(view_port);
+    UNUSED(callback);
+    UNUSED(context);
+}
+
+void view_port_update(ViewPort* view_port) {
+    UNUSED(view_port);
+}
+
+void view_port_enabled_set(ViewPort* view_port, bool enabled) {
+    UNUSED(view_port);
+    UNUSED(enabled);
+}
+
+void gui_add_view_port(Gui* gui, ViewPort* view_port, GuiLayer layer) {
+    UNUSED(gui);
+    UNUSED(view_port);
+    UNUSED(layer);
+}
+
+void gui_remove_view_port(Gui* gui, ViewPort* view_port) {
+    UNUSED(gui);
+    UNUSED(view_port);
+}
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence) {
+    UNUSED(app);
+    UNUSED(sequence);
+}
+
+void dolphin_deed(DolphinDeed deed) {
+    UNUSED(deed);
+}
+
+const FlipperAppPluginDescriptor* init_plugin_ep(void);
+
+FlipperApplication* flipper_application_alloc(Storage* storage, const void* api_interface) {
+    UNUSED(storage);
+    UNUSED(api_interface);
+    return NULL;
+}
+
+void flipper_application_free(FlipperApplication* app) {
+    UNUSED(app);
+}
+
+int flipper_application_preload(FlipperApplication* app, const char* path) {
+    UNUSED(app);
+    UNUSED(path);
+    return 0;
+}
+
+int flipper_application_map_to_memory(FlipperApplication* app) {
+    UNUSED(app);
+    return 0;
+}
+
+const FlipperAppPluginDescriptor*
+    flipper_application_plugin_get_descriptor(FlipperApplication* app) {
+    UNUSED(app);
+    return init_plugin_ep();
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+
+// Test controls of the stubs, not part of the SDK
+
+// Called after every write through a stream, a test can stop a run at a given file write
+typedef void (*SdkStubWriteCallback)(const char* path, void* context);
+
+void sdk_stub_set_write_callback(SdkStubWriteCallback callback, void* context);
+
+// Free heap and largest free block the memmgr functions report, they don't shrink as
+// memory is allocated. 0 restores the default heap, a max_free_block of 0 is the whole heap.
+void sdk_stub_set_heap(size_t free_heap, size_t max_free_block);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <storage/storage.h>
+#include "stream.h"
+
+Stream* file_stream_alloc(Storage* storage);
+bool file_stream_open(
+    Stream* stream,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode);
+bool file_stream_close(Stream* stream);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct Stream Stream;
+
+typedef enum {
+    StreamOffsetFromCurrent,
+    StreamOffsetFromStart,
+    StreamOffsetFromEnd,
+} StreamOffset;
+
+void stream_free(Stream* stream);
+bool stream_eof(Stream* stream);
+bool stream_rewind(Stream* stream);
+bool stream_seek(Stream* stream, int32_t offset, StreamOffset offset_type);
+size_t stream_tell(Stream* stream);
+size_t stream_size(Stream* stream);
+size_t stream_read(Stream* stream, uint8_t* data, size_t size);
+bool stream_read_line(Stream* stream, FuriString* str_result);
+size_t stream_write(Stream* stream, const uint8_t* data, size_t size);
+size_t stream_write_char(Stream* stream, char c);
+size_t stream_write_cstring(Stream* stream, const char* string);
+size_t stream_write_string(Stream* stream, FuriString* string);
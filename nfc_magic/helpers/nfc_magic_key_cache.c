@@ -0,0 +1,414 @@
+#include "nfc_magic_key_cache.h"
+
+#include <furi.h>
+#include <bit_lib/bit_lib.h>
+#include <toolbox/hex.h>
+#include <toolbox/stream/buffered_file_stream.h>
+#include <toolbox/stream/file_stream.h>
+
+#define TAG "NfcMagicKeyCache"
+
+// Each table is a single allocation, capped on its own. 4096 keys at most, well within
+// the 16-bit slot index
+#define NFC_MAGIC_KEY_CACHE_KEYS_MAX_SIZE  (24 * 1024)
+#define NFC_MAGIC_KEY_CACHE_SLOTS_MAX_SIZE (16 * 1024)
+// Heap left to the poller and the GUI
+#define NFC_MAGIC_KEY_CACHE_HEAP_RESERVE (16 * 1024)
+#define NFC_MAGIC_KEY_CACHE_SLOT_EMPTY   0xFFFF
+#define NFC_MAGIC_KEY_CACHE_NOT_CACHED   SIZE_MAX
+
+// Keys tried first, found on this card or on the most cards before
+#define NFC_MAGIC_KEY_CACHE_HOT_MAX     32
+#define NFC_MAGIC_KEY_CACHE_HITS_MAGIC  0x5348434E // "NCHS"
+#define NFC_MAGIC_KEY_CACHE_HITS_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+} NfcMagicKeyCacheHitsHeader;
+
+typedef struct {
+    MfClassicKey key;
+    uint16_t cards; // Cards the key was found on
+} NfcMagicKeyCacheHit;
+
+typedef struct {
+    size_t first; // First key of the dictionary in keys
+    size_t count; // Keys of the dictionary in keys
+    Stream* stream; // Keys past the budget, NULL if all of them fit
+    size_t stream_offset; // File offset of the first key not in keys
+    size_t stream_count;
+} NfcMagicKeyCacheRange;
+
+struct NfcMagicKeyCache {
+    Storage* storage;
+    MfClassicKey* keys;
+    size_t keys_count;
+    size_t keys_capacity;
+    uint16_t* slots; // Index of keys by value, open addressing, only while loading
+    size_t slots_mask;
+    NfcMagicKeyCacheRange ranges[NfcMagicKeyCacheDictNum];
+    NfcMagicKeyCacheRange* selected;
+    size_t position; // Next key of the selected dictionary
+    FuriString* line;
+
+    uint16_t hot[NFC_MAGIC_KEY_CACHE_HOT_MAX]; // Index in keys, found on this card first
+    size_t hot_count;
+    size_t hot_found; // Leading hot keys found on this card
+    size_t hot_position; // Next hot key, the rest of the dictionary follows
+    uint8_t* hot_map; // Bit per key in keys, set for hot keys
+    NfcMagicKeyCacheHit hits[NFC_MAGIC_KEY_CACHE_HOT_MAX]; // Most cards first
+    size_t hits_count;
+    MfClassicKey found[NFC_MAGIC_KEY_CACHE_HOT_MAX]; // Found on this card
+    size_t found_count;
+    MfClassicKey served; // Last key handed out
+    size_t served_index; // Its index in keys, NFC_MAGIC_KEY_CACHE_NOT_CACHED if read from SD
+};
+
+// Same lines KeysDict accepts: one key per line in hex, anything else is skipped
+static bool nfc_magic_key_cache_read_key(Stream* stream, FuriString* line, MfClassicKey* key) {
+    while(stream_read_line(stream, line)) {
+        furi_string_trim(line);
+        if(furi_string_size(line) != sizeof(MfClassicKey) * 2) continue;
+
+        const char* str = furi_string_get_cstr(line);
+        bool valid = true;
+        for(size_t i = 0; valid && (i < sizeof(MfClassicKey)); i++) {
+            valid = hex_chars_to_uint8(str[i * 2], str[i * 2 + 1], &key->data[i]);
+        }
+        if(valid) return true;
+    }
+    return false;
+}
+
+// Slot holding the key, or the empty slot it goes into
+static size_t nfc_magic_key_cache_find_slot(NfcMagicKeyCache* instance, const MfClassicKey* key) {
+    uint64_t value = bit_lib_bytes_to_num_be(key->data, sizeof(MfClassicKey));
+    size_t slot = ((value * 0x9E3779B97F4A7C15ULL) >> 32) & instance->slots_mask;
+    while(instance->slots[slot] != NFC_MAGIC_KEY_CACHE_SLOT_EMPTY) {
+        if(memcmp(instance->keys[instance->slots[slot]].data, key->data, sizeof(MfClassicKey)) ==
+           0) {
+            break;
+        }
+        slot = (slot + 1) & instance->slots_mask;
+    }
+    return slot;
+}
+
+static void nfc_magic_key_cache_insert(NfcMagicKeyCache* instance, const MfClassicKey* key) {
+    size_t slot = nfc_magic_key_cache_find_slot(instance, key);
+    if(instance->slots[slot] == NFC_MAGIC_KEY_CACHE_SLOT_EMPTY) {
+        instance->slots[slot] = instance->keys_count;
+        instance->keys[instance->keys_count++] = *key;
+    }
+}
+
+static bool nfc_magic_key_cache_is_hot(NfcMagicKeyCache* instance, size_t index) {
+    return instance->hot_map[index / 8] & (1 << (index % 8));
+}
+
+// Hot keys found on this card come first, in the order they were found
+static void nfc_magic_key_cache_set_hot(NfcMagicKeyCache* instance, size_t index, bool found) {
+    size_t position = instance->hot_count;
+    if(nfc_magic_key_cache_is_hot(instance, index)) {
+        position = 0;
+        while(instance->hot[position] != index) {
+            position++;
+        }
+        if(!found || (position < instance->hot_found)) return;
+    } else if(instance->hot_count == NFC_MAGIC_KEY_CACHE_HOT_MAX) {
+        if(!found || (instance->hot_found == NFC_MAGIC_KEY_CACHE_HOT_MAX)) return;
+        // Drop the hot key with the fewest cards
+        position = --instance->hot_count;
+        size_t dropped = instance->hot[position];
+        instance->hot_map[dropped / 8] &= ~(1 << (dropped % 8));
+    }
+
+    size_t insert = found ? instance->hot_found++ : position;
+    memmove(
+        &instance->hot[insert + 1],
+        &instance->hot[insert],
+        sizeof(uint16_t) * (position - insert));
+    instance->hot[insert] = index;
+    instance->hot_map[index / 8] |= 1 << (index % 8);
+    if(position == instance->hot_count) {
+        instance->hot_count++;
+        // A pass already past the hot keys stays past them
+        if(instance->hot_position >= insert) instance->hot_position++;
+    }
+}
+
+static void nfc_magic_key_cache_load_hits(NfcMagicKeyCache* instance, const char* path) {
+    Stream* stream = file_stream_alloc(instance->storage);
+    do {
+        if(!file_stream_open(stream, path, FSAM_READ, FSOM_OPEN_EXISTING)) break;
+        NfcMagicKeyCacheHitsHeader header;
+        if(stream_read(stream, (uint8_t*)&header, sizeof(header)) != sizeof(header)) break;
+        if((header.magic != NFC_MAGIC_KEY_CACHE_HITS_MAGIC) ||
+           (header.version != NFC_MAGIC_KEY_CACHE_HITS_VERSION) ||
+           (header.count > NFC_MAGIC_KEY_CACHE_HOT_MAX)) {
+            break;
+        }
+        size_t hits_size = sizeof(NfcMagicKeyCacheHit) * header.count;
+        if(stream_read(stream, (uint8_t*)instance->hits, hits_size) != hits_size) break;
+        instance->hits_count = header.count;
+    } while(false);
+    file_stream_close(stream);
+    stream_free(stream);
+
+    for(size_t i = 0; (i < instance->hits_count) && (instance->keys_count > 0); i++) {
+        size_t slot = nfc_magic_key_cache_find_slot(instance, &instance->hits[i].key);
+        if(instance->slots[slot] != NFC_MAGIC_KEY_CACHE_SLOT_EMPTY) {
+            nfc_magic_key_cache_set_hot(instance, instance->slots[slot], false);
+        }
+    }
+}
+
+// Bytes one table may take, it has to fit in the largest free block
+static size_t nfc_magic_key_cache_budget(size_t max_size) {
+    size_t free_block = memmgr_heap_get_max_free_block();
+    if(free_block <= NFC_MAGIC_KEY_CACHE_HEAP_RESERVE) return 0;
+    return MIN(max_size, free_block - NFC_MAGIC_KEY_CACHE_HEAP_RESERVE);
+}
+
+static void nfc_magic_key_cache_load(
+    NfcMagicKeyCache* instance,
+    NfcMagicKeyCacheDict dict,
+    const char* path) {
+    NfcMagicKeyCacheRange* range = &instance->ranges[dict];
+    range->first = instance->keys_count;
+
+    Stream* stream = buffered_file_stream_alloc(instance->storage);
+    if(buffered_file_stream_open(stream, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        MfClassicKey key;
+        bool more = true;
+        while(more && (instance->keys_count < instance->keys_capacity)) {
+            more = nfc_magic_key_cache_read_key(stream, instance->line, &key);
+            if(more) nfc_magic_key_cache_insert(instance, &key);
+        }
+        range->count = instance->keys_count - range->first;
+
+        if(more) {
+            // Out of budget, the rest of the file is read on every pass
+            range->stream_offset = stream_tell(stream);
+            while(nfc_magic_key_cache_read_key(stream, instance->line, &key)) {
+                range->stream_count++;
+            }
+            if(range->stream_count > 0) {
+                range->stream = stream;
+                return;
+            }
+        }
+    }
+    buffered_file_stream_close(stream);
+    stream_free(stream);
+}
+
+NfcMagicKeyCache* nfc_magic_key_cache_alloc(
+    Storage* storage,
+    const char* user_path,
+    const char* system_path,
+    const char* hits_path) {
+    furi_assert(storage);
+    furi_assert(user_path);
+    furi_assert(system_path);
+    furi_assert(hits_path);
+
+    NfcMagicKeyCache* instance = malloc(sizeof(NfcMagicKeyCache));
+    instance->storage = storage;
+    instance->line = furi_string_alloc();
+    instance->served_index = NFC_MAGIC_KEY_CACHE_NOT_CACHED;
+
+    instance->keys_capacity =
+        nfc_magic_key_cache_budget(NFC_MAGIC_KEY_CACHE_KEYS_MAX_SIZE) / sizeof(MfClassicKey);
+    size_t slots_count = 1;
+    if(instance->keys_capacity > 0) {
+        instance->keys = malloc(sizeof(MfClassicKey) * instance->keys_capacity);
+
+        // Two slots per key while loading, the slot count is a power of two
+        size_t slots_budget =
+            nfc_magic_key_cache_budget(NFC_MAGIC_KEY_CACHE_SLOTS_MAX_SIZE) / sizeof(uint16_t);
+        while((slots_count < instance->keys_capacity * 2) && (slots_count * 2 <= slots_budget)) {
+            slots_count <<= 1;
+        }
+        instance->keys_capacity = MIN(instance->keys_capacity, slots_count / 2);
+    }
+
+    if(instance->keys_capacity > 0) {
+        instance->slots = malloc(sizeof(uint16_t) * slots_count);
+        memset(instance->slots, 0xFF, sizeof(uint16_t) * slots_count);
+        instance->slots_mask = slots_count - 1;
+    } else {
+        // No room for the tables, every key is read from the file
+        free(instance->keys);
+        instance->keys = NULL;
+    }
+
+    nfc_magic_key_cache_load(instance, NfcMagicKeyCacheDictUser, user_path);
+    nfc_magic_key_cache_load(instance, NfcMagicKeyCacheDictSystem, system_path);
+    instance->hot_map = malloc((instance->keys_count + 7) / 8 + 1);
+    nfc_magic_key_cache_load_hits(instance, hits_path);
+
+    free(instance->slots);
+    instance->slots = NULL;
+    if(instance->keys_count == 0) {
+        free(instance->keys);
+        instance->keys = NULL;
+    } else if(instance->keys_count < instance->keys_capacity) {
+        instance->keys = realloc(instance->keys, sizeof(MfClassicKey) * instance->keys_count);
+    }
+
+    FURI_LOG_D(
+        TAG,
+        "%zu keys in RAM, %zu user and %zu system keys left on SD",
+        instance->keys_count,
+        instance->ranges[NfcMagicKeyCacheDictUser].stream_count,
+        instance->ranges[NfcMagicKeyCacheDictSystem].stream_count);
+
+    nfc_magic_key_cache_select(instance, NfcMagicKeyCacheDictUser);
+
+    return instance;
+}
+
+void nfc_magic_key_cache_free(NfcMagicKeyCache* instance) {
+    furi_assert(instance);
+
+    for(size_t i = 0; i < NfcMagicKeyCacheDictNum; i++) {
+        if(instance->ranges[i].stream) {
+            buffered_file_stream_close(instance->ranges[i].stream);
+            stream_free(instance->ranges[i].stream);
+        }
+    }
+    furi_string_free(instance->line);
+    free(instance->hot_map);
+    free(instance->keys);
+    free(instance);
+}
+
+bool nfc_magic_key_cache_select(NfcMagicKeyCache* instance, NfcMagicKeyCacheDict dict) {
+    furi_assert(instance);
+    furi_assert(dict < NfcMagicKeyCacheDictNum);
+
+    instance->selected = &instance->ranges[dict];
+    nfc_magic_key_cache_rewind(instance);
+
+    return nfc_magic_key_cache_get_total_keys(instance) > 0;
+}
+
+size_t nfc_magic_key_cache_get_total_keys(NfcMagicKeyCache* instance) {
+    furi_assert(instance);
+
+    return instance->selected->count + instance->selected->stream_count;
+}
+
+void nfc_magic_key_cache_rewind(NfcMagicKeyCache* instance) {
+    furi_assert(instance);
+
+    instance->position = 0;
+    instance->hot_position = 0;
+    if(instance->selected->stream) {
+        stream_seek(
+            instance->selected->stream,
+            instance->selected->stream_offset,
+            StreamOffsetFromStart);
+    }
+}
+
+bool nfc_magic_key_cache_get_next_key(NfcMagicKeyCache* instance, MfClassicKey* key) {
+    furi_assert(instance);
+    furi_assert(key);
+
+    NfcMagicKeyCacheRange* range = instance->selected;
+    // Hot keys of this dictionary first, then the rest of it in file order
+    while(instance->hot_position < instance->hot_count) {
+        size_t index = instance->hot[instance->hot_position++];
+        if((index >= range->first) && (index < range->first + range->count)) {
+            instance->served_index = index;
+            instance->served = *key = instance->keys[index];
+            return true;
+        }
+    }
+    while(instance->position < range->count) {
+        size_t index = range->first + instance->position++;
+        if(!nfc_magic_key_cache_is_hot(instance, index)) {
+            instance->served_index = index;
+            instance->served = *key = instance->keys[index];
+            return true;
+        }
+    }
+    if(range->stream && nfc_magic_key_cache_read_key(range->stream, instance->line, key)) {
+        instance->served_index = NFC_MAGIC_KEY_CACHE_NOT_CACHED;
+        instance->served = *key;
+        return true;
+    }
+    return false;
+}
+
+void nfc_magic_key_cache_key_found(NfcMagicKeyCache* instance) {
+    furi_assert(instance);
+
+    bool known = false;
+    for(size_t i = 0; (i < instance->found_count) && !known; i++) {
+        known = (memcmp(instance->found[i].data, instance->served.data, sizeof(MfClassicKey)) ==
+                 0);
+    }
+    if(!known && (instance->found_count < NFC_MAGIC_KEY_CACHE_HOT_MAX)) {
+        instance->found[instance->found_count++] = instance->served;
+    }
+    if(instance->served_index != NFC_MAGIC_KEY_CACHE_NOT_CACHED) {
+        nfc_magic_key_cache_set_hot(instance, instance->served_index, true);
+    }
+}
+
+bool nfc_magic_key_cache_save_hits(NfcMagicKeyCache* instance, const char* path) {
+    furi_assert(instance);
+    furi_assert(path);
+
+    if(instance->found_count == 0) return true;
+
+    // Count this card for every key found on it, keys new to the file replace the ones
+    // found on the fewest cards
+    for(size_t i = 0; i < instance->found_count; i++) {
+        size_t j = 0;
+        while((j < instance->hits_count) &&
+              (memcmp(instance->hits[j].key.data, instance->found[i].data, sizeof(MfClassicKey)) !=
+               0)) {
+            j++;
+        }
+        if(j == instance->hits_count) {
+            if(instance->hits_count < NFC_MAGIC_KEY_CACHE_HOT_MAX) {
+                instance->hits_count++;
+            } else {
+                j = instance->hits_count - 1;
+            }
+            instance->hits[j].key = instance->found[i];
+            instance->hits[j].cards = 0;
+        }
+        if(instance->hits[j].cards < UINT16_MAX) instance->hits[j].cards++;
+        // Keep the most cards first
+        for(; (j > 0) && (instance->hits[j - 1].cards < instance->hits[j].cards); j--) {
+            NfcMagicKeyCacheHit hit = instance->hits[j - 1];
+            instance->hits[j - 1] = instance->hits[j];
+            instance->hits[j] = hit;
+        }
+    }
+    instance->found_count = 0;
+
+    NfcMagicKeyCacheHitsHeader header = {
+        .magic = NFC_MAGIC_KEY_CACHE_HITS_MAGIC,
+        .version = NFC_MAGIC_KEY_CACHE_HITS_VERSION,
+        .count = instance->hits_count,
+    };
+    size_t hits_size = sizeof(NfcMagicKeyCacheHit) * instance->hits_count;
+    Stream* stream = file_stream_alloc(instance->storage);
+    bool saved = false;
+    if(file_stream_open(stream, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        saved = (stream_write(stream, (uint8_t*)&header, sizeof(header)) == sizeof(header)) &&
+                (stream_write(stream, (uint8_t*)instance->hits, hits_size) == hits_size);
+    }
+    file_stream_close(stream);
+    stream_free(stream);
+    if(!saved) FURI_LOG_E(TAG, "Unable to save key hits");
+    return saved;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <storage/storage.h>
+#include <nfc/protocols/mf_classic/mf_classic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    NfcMagicKeyCacheDictUser,
+    NfcMagicKeyCacheDictSystem,
+
+    NfcMagicKeyCacheDictNum,
+} NfcMagicKeyCacheDict;
+
+typedef struct NfcMagicKeyCache NfcMagicKeyCache;
+
+/** Load the user and system dictionaries
+ *
+ * Keys are kept in RAM up to a budget that fits the largest free heap block, system
+ * keys already in the user dictionary are left out. Keys past the budget are read from the file,
+ * one key at a time, the way KeysDict does.
+ *
+ * Keys found on earlier cards, as listed in the hits file, are handed out first.
+ *
+ * @param storage     - Storage instance
+ * @param user_path   - user dictionary path, may not exist
+ * @param system_path - system dictionary path
+ * @param hits_path   - key hits file, may not exist
+ * @return NfcMagicKeyCache*
+ */
+NfcMagicKeyCache* nfc_magic_key_cache_alloc(
+    Storage* storage,
+    const char* user_path,
+    const char* system_path,
+    const char* hits_path);
+
+/** Free NfcMagicKeyCache
+ *
+ * @param instance - NfcMagicKeyCache instance
+ */
+void nfc_magic_key_cache_free(NfcMagicKeyCache* instance);
+
+/** Serve keys from one dictionary, starting with its first key
+ *
+ * @param instance - NfcMagicKeyCache instance
+ * @param dict     - dictionary to serve
+ * @return true if the dictionary has any key
+ */
+bool nfc_magic_key_cache_select(NfcMagicKeyCache* instance, NfcMagicKeyCacheDict dict);
+
+/** Keys in the selected dictionary
+ *
+ * @param instance - NfcMagicKeyCache instance
+ * @return number of keys
+ */
+size_t nfc_magic_key_cache_get_total_keys(NfcMagicKeyCache* instance);
+
+/** Go back to the first key of the selected dictionary
+ *
+ * @param instance - NfcMagicKeyCache instance
+ */
+void nfc_magic_key_cache_rewind(NfcMagicKeyCache* instance);
+
+/** Get the next key of the selected dictionary, drop-in for keys_dict_get_next_key()
+ *
+ * @param instance - NfcMagicKeyCache instance
+ * @param key      - where to put the key
+ * @return true if a key was read, false at the end of the dictionary
+ */
+bool nfc_magic_key_cache_get_next_key(NfcMagicKeyCache* instance, MfClassicKey* key);
+
+/** Report that the last key handed out opened a sector
+ *
+ * The key is handed out first for the following sectors.
+ *
+ * @param instance - NfcMagicKeyCache instance
+ */
+void nfc_magic_key_cache_key_found(NfcMagicKeyCache* instance);
+
+/** Add the keys found on this card to the hits file
+ *
+ * @param instance - NfcMagicKeyCache instance
+ * @param path     - key hits file
+ * @return true on success or when no key was found
+ */
+bool nfc_magic_key_cache_save_hits(NfcMagicKeyCache* instance, const char* path);
+
+#ifdef __cplusplus
+}
+#endif
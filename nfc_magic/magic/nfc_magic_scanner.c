@@ -6,9 +6,18 @@
 #include "protocols/gen2/gen2_poller.h"
 #include "protocols/gen4/gen4_poller.h"
 #include <nfc/nfc_poller.h>
+#include <nfc/protocols/iso14443_3a/iso14443_3a_poller.h>
 
 #include <furi/furi.h>
 
+#define NFC_MAGIC_SCANNER_THREAD_FLAG_FINGERPRINT (1U << 1)
+
+static const NfcProtocol nfc_magic_scanner_not_magic_protocols[] = {
+    NfcProtocolIso14443_3b,
+    NfcProtocolIso15693_3,
+    NfcProtocolFelica,
+};
+
 typedef enum {
     NfcMagicScannerSessionStateIdle,
     NfcMagicScannerSessionStateActive,
@@ -24,16 +33,22 @@ struct NfcMagicScanner {
     Gen4* gen4_data;
     bool magic_protocol_detected;
 
+    // Kept across scans, so a card found once is probed for its type first
+    Iso14443_3aData* fingerprint; // Anticollision data of the card in the field
+    Iso14443_3aData* last_fingerprint; // Last card detected as magic
+    NfcMagicProtocol last_protocol;
+    bool card_present;
+
+    // Reused for every probe of a scan, only allocated while the worker runs
+    NfcPoller* iso3_poller;
+    NfcPoller* mfc_poller;
+    NfcPoller* not_magic_pollers[COUNT_OF(nfc_magic_scanner_not_magic_protocols)];
+
     NfcMagicScannerCallback callback;
     void* context;
 
     FuriThread* scan_worker;
-};
-
-static const NfcProtocol nfc_magic_scanner_not_magic_protocols[] = {
-    NfcProtocolIso14443_3b,
-    NfcProtocolIso15693_3,
-    NfcProtocolFelica,
+    FuriThreadId thread_id;
 };
 
 static void nfc_magic_scanner_reset(NfcMagicScanner* instance) {
@@ -41,12 +56,35 @@ static void nfc_magic_scanner_reset(NfcMagicScanner* instance) {
     instance->current_protocol = NfcMagicProtocolGen1;
 }
 
+static void nfc_magic_scanner_alloc_pollers(NfcMagicScanner* instance) {
+    instance->iso3_poller = nfc_poller_alloc(instance->nfc, NfcProtocolIso14443_3a);
+    instance->mfc_poller = nfc_poller_alloc(instance->nfc, NfcProtocolMfClassic);
+    for(size_t i = 0; i < COUNT_OF(nfc_magic_scanner_not_magic_protocols); i++) {
+        instance->not_magic_pollers[i] =
+            nfc_poller_alloc(instance->nfc, nfc_magic_scanner_not_magic_protocols[i]);
+    }
+}
+
+static void nfc_magic_scanner_free_pollers(NfcMagicScanner* instance) {
+    for(size_t i = 0; i < COUNT_OF(nfc_magic_scanner_not_magic_protocols); i++) {
+        nfc_poller_free(instance->not_magic_pollers[i]);
+        instance->not_magic_pollers[i] = NULL;
+    }
+    nfc_poller_free(instance->mfc_poller);
+    instance->mfc_poller = NULL;
+    nfc_poller_free(instance->iso3_poller);
+    instance->iso3_poller = NULL;
+}
+
 NfcMagicScanner* nfc_magic_scanner_alloc(Nfc* nfc) {
     furi_assert(nfc);
 
     NfcMagicScanner* instance = malloc(sizeof(NfcMagicScanner));
     instance->nfc = nfc;
     instance->gen4_data = gen4_alloc();
+    instance->fingerprint = iso14443_3a_alloc();
+    instance->last_fingerprint = iso14443_3a_alloc();
+    instance->last_protocol = NfcMagicProtocolInvalid;
 
     return instance;
 }
@@ -54,6 +92,8 @@ NfcMagicScanner* nfc_magic_scanner_alloc(Nfc* nfc) {
 void nfc_magic_scanner_free(NfcMagicScanner* instance) {
     furi_assert(instance);
 
+    iso14443_3a_free(instance->last_fingerprint);
+    iso14443_3a_free(instance->fingerprint);
     gen4_free(instance->gen4_data);
     free(instance);
 }
@@ -64,46 +104,114 @@ void nfc_magic_scanner_set_gen4_password(NfcMagicScanner* instance, Gen4Password
     instance->gen4_password = password;
 }
 
+static NfcCommand nfc_magic_scanner_fingerprint_callback(NfcGenericEvent event, void* context) {
+    furi_assert(context);
+    furi_assert(event.protocol == NfcProtocolIso14443_3a);
+    furi_assert(event.event_data);
+
+    NfcMagicScanner* instance = context;
+    Iso14443_3aPollerEvent* iso3_event = event.event_data;
+
+    instance->card_present = (iso3_event->type == Iso14443_3aPollerEventTypeReady);
+    if(instance->card_present) {
+        iso14443_3a_copy(instance->fingerprint, nfc_poller_get_data(instance->iso3_poller));
+    }
+    furi_thread_flags_set(instance->thread_id, NFC_MAGIC_SCANNER_THREAD_FLAG_FINGERPRINT);
+
+    return NfcCommandStop;
+}
+
+static bool nfc_magic_scanner_read_fingerprint(NfcMagicScanner* instance) {
+    instance->card_present = false;
+
+    nfc_poller_start(instance->iso3_poller, nfc_magic_scanner_fingerprint_callback, instance);
+    uint32_t flags = furi_thread_flags_wait(
+        NFC_MAGIC_SCANNER_THREAD_FLAG_FINGERPRINT, FuriFlagWaitAny, FuriWaitForever);
+    if(flags & NFC_MAGIC_SCANNER_THREAD_FLAG_FINGERPRINT) {
+        furi_thread_flags_clear(NFC_MAGIC_SCANNER_THREAD_FLAG_FINGERPRINT);
+    }
+    nfc_poller_stop(instance->iso3_poller);
+
+    return instance->card_present;
+}
+
+// Order the probes for the card in the field, returns the number of probes
+static size_t nfc_magic_scanner_plan(NfcMagicScanner* instance, NfcMagicProtocol* order) {
+    size_t count = 0;
+    bool planned[NfcMagicProtocolNum] = {};
+
+    // The card detected last time is most likely still the one in the field
+    if((instance->last_protocol != NfcMagicProtocolInvalid) &&
+       iso14443_3a_is_equal(instance->fingerprint, instance->last_fingerprint)) {
+        order[count++] = instance->last_protocol;
+        planned[instance->last_protocol] = true;
+    }
+    // Ultralight SAK, Gen2 and genuine Classic cards can't answer it
+    if(instance->fingerprint->sak == 0x00) {
+        if(!planned[NfcMagicProtocolGen4]) order[count++] = NfcMagicProtocolGen4;
+        planned[NfcMagicProtocolGen4] = true;
+        planned[NfcMagicProtocolGen2] = true;
+        planned[NfcMagicProtocolClassic] = true;
+    }
+    for(size_t i = 0; i < NfcMagicProtocolNum; i++) {
+        if(!planned[i]) order[count++] = i;
+    }
+
+    return count;
+}
+
+static bool nfc_magic_scanner_probe(NfcMagicScanner* instance, NfcMagicProtocol protocol) {
+    bool detected = false;
+
+    if(protocol == NfcMagicProtocolGen1) {
+        detected = gen1a_poller_detect(instance->nfc);
+    } else if(protocol == NfcMagicProtocolGen4) {
+        gen4_reset(instance->gen4_data);
+        Gen4 gen4_data;
+        Gen4PollerError error =
+            gen4_poller_detect(instance->nfc, instance->gen4_password, &gen4_data);
+        detected = (error == Gen4PollerErrorNone);
+        if(detected) {
+            gen4_copy(instance->gen4_data, &gen4_data);
+        }
+    } else if(protocol == NfcMagicProtocolGen2) {
+        Gen2PollerError error = gen2_poller_detect(instance->nfc);
+        detected = (error == Gen2PollerErrorNone);
+    } else if(protocol == NfcMagicProtocolClassic) {
+        detected = nfc_poller_detect(instance->mfc_poller);
+    }
+
+    return detected;
+}
+
 static int32_t nfc_magic_scanner_worker(void* context) {
     furi_assert(context);
 
     NfcMagicScanner* instance = context;
     furi_assert(instance->session_state == NfcMagicScannerSessionStateActive);
+    instance->thread_id = furi_thread_get_current_id();
 
     while(instance->session_state == NfcMagicScannerSessionStateActive) {
-        do {
-            if(instance->current_protocol == NfcMagicProtocolGen1) {
-                instance->magic_protocol_detected = gen1a_poller_detect(instance->nfc);
-                if(instance->magic_protocol_detected) {
-                    break;
-                }
-            } else if(instance->current_protocol == NfcMagicProtocolGen4) {
-                gen4_reset(instance->gen4_data);
-                Gen4 gen4_data;
-                Gen4PollerError error =
-                    gen4_poller_detect(instance->nfc, instance->gen4_password, &gen4_data);
-                instance->magic_protocol_detected = (error == Gen4PollerErrorNone);
-                if(instance->magic_protocol_detected) {
-                    gen4_copy(instance->gen4_data, &gen4_data);
-                    break;
-                }
-            } else if(instance->current_protocol == NfcMagicProtocolGen2) {
-                Gen2PollerError error = gen2_poller_detect(instance->nfc);
-                instance->magic_protocol_detected = (error == Gen2PollerErrorNone);
-                if(instance->magic_protocol_detected) {
-                    break;
-                }
-            } else if(instance->current_protocol == NfcMagicProtocolClassic) {
-                NfcPoller* poller = nfc_poller_alloc(instance->nfc, NfcProtocolMfClassic);
-                instance->magic_protocol_detected = nfc_poller_detect(poller);
-                nfc_poller_free(poller);
-                if(instance->magic_protocol_detected) {
-                    break;
-                }
+        instance->magic_protocol_detected = false;
+
+        // No point probing for magic types without an Iso14443-3a card in the field
+        if(nfc_magic_scanner_read_fingerprint(instance)) {
+            NfcMagicProtocol order[NfcMagicProtocolNum];
+            size_t count = nfc_magic_scanner_plan(instance, order);
+            for(size_t i = 0; i < count; i++) {
+                if(instance->session_state != NfcMagicScannerSessionStateActive) break;
+
+                instance->current_protocol = order[i];
+                instance->magic_protocol_detected =
+                    nfc_magic_scanner_probe(instance, instance->current_protocol);
+                if(instance->magic_protocol_detected) break;
             }
-        } while(false);
+        }
 
         if(instance->magic_protocol_detected) {
+            instance->last_protocol = instance->current_protocol;
+            iso14443_3a_copy(instance->last_fingerprint, instance->fingerprint);
+
             NfcMagicScannerEvent event = {
                 .type = NfcMagicScannerEventTypeDetected,
                 .data.protocol = instance->current_protocol,
@@ -111,29 +219,25 @@ static int32_t nfc_magic_scanner_worker(void* context) {
             instance->callback(event, instance->context);
             break;
         }
+        if(instance->session_state != NfcMagicScannerSessionStateActive) break;
 
-        if(instance->current_protocol == NfcMagicProtocolNum - 1) {
-            bool not_magic_protocol_detected = false;
-            for(size_t i = 0; i < COUNT_OF(nfc_magic_scanner_not_magic_protocols); i++) {
-                NfcProtocol protocol = nfc_magic_scanner_not_magic_protocols[i];
-                NfcPoller* poller = nfc_poller_alloc(instance->nfc, protocol);
-                not_magic_protocol_detected = nfc_poller_detect(poller);
-                nfc_poller_free(poller);
-                if(not_magic_protocol_detected) {
-                    break;
-                }
-            }
+        bool not_magic_protocol_detected = false;
+        for(size_t i = 0; i < COUNT_OF(nfc_magic_scanner_not_magic_protocols); i++) {
+            not_magic_protocol_detected = nfc_poller_detect(instance->not_magic_pollers[i]);
             if(not_magic_protocol_detected) {
-                NfcMagicScannerEvent event = {
-                    .type = NfcMagicScannerEventTypeDetectedNotMagic,
-                };
-                instance->callback(event, instance->context);
                 break;
             }
         }
-        instance->current_protocol = (instance->current_protocol + 1) % NfcMagicProtocolNum;
+        if(not_magic_protocol_detected) {
+            NfcMagicScannerEvent event = {
+                .type = NfcMagicScannerEventTypeDetectedNotMagic,
+            };
+            instance->callback(event, instance->context);
+            break;
+        }
     }
 
+    nfc_magic_scanner_free_pollers(instance);
     nfc_magic_scanner_reset(instance);
 
     return 0;
@@ -148,6 +252,7 @@ void nfc_magic_scanner_start(
 
     instance->callback = callback;
     instance->context = context;
+    nfc_magic_scanner_alloc_pollers(instance);
 
     instance->scan_worker = furi_thread_alloc();
     furi_thread_set_name(instance->scan_worker, "NfcMagicScanWorker");
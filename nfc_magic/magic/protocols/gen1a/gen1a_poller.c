@@ -149,6 +149,7 @@ NfcCommand gen1a_poller_request_mode_handler(Gen1aPoller* instance) {
 
     instance->gen1a_event.type = Gen1aPollerEventTypeRequestMode;
     command = instance->callback(instance->gen1a_event, instance->context);
+    instance->mode = instance->gen1a_event_data.request_mode.mode;
     if(instance->gen1a_event_data.request_mode.mode == Gen1aPollerModeWipe) {
         instance->state = Gen1aPollerStateWipe;
     } else if(instance->gen1a_event_data.request_mode.mode == Gen1aPollerModeDump) {
@@ -202,6 +203,33 @@ NfcCommand gen1a_poller_write_data_request_handler(Gen1aPoller* instance) {
     return command;
 }
 
+// Read the card and mark the blocks that differ from mfc_data
+static Gen1aPollerError
+    gen1a_poller_diff_blocks(Gen1aPoller* instance, const MfClassicData* mfc_data) {
+    Gen1aPollerError error = Gen1aPollerErrorNone;
+    uint16_t total_block_num = mf_classic_get_total_block_num(mfc_data->type);
+    MfClassicBlock block = {};
+    uint8_t misses = 0;
+
+    memset(instance->changed_blocks, 0xFF, sizeof(instance->changed_blocks));
+    for(uint16_t i = 0; i < total_block_num; i++) {
+        // A card this different is likely blank, reading the rest would only add frames
+        if(misses == GEN1A_POLLER_DIFF_MISS_LIMIT) break;
+
+        error = gen1a_poller_read_block(instance, i, &block);
+        if(error != Gen1aPollerErrorNone) break;
+
+        if(memcmp(block.data, mfc_data->block[i].data, sizeof(MfClassicBlock)) == 0) {
+            bit_lib_set_bit(instance->changed_blocks, i, false);
+            misses = 0;
+        } else {
+            misses++;
+        }
+    }
+
+    return error;
+}
+
 NfcCommand gen1a_poller_write_handler(Gen1aPoller* instance) {
     NfcCommand command = NfcCommandContinue;
     Gen1aPollerError error = Gen1aPollerErrorNone;
@@ -219,6 +247,23 @@ NfcCommand gen1a_poller_write_handler(Gen1aPoller* instance) {
                     instance->state = Gen1aPollerStateFail;
                     break;
                 }
+                if(instance->mode == Gen1aPollerModeWriteDiff) {
+                    error = gen1a_poller_diff_blocks(instance, mfc_data);
+                    if(error != Gen1aPollerErrorNone) {
+                        instance->state = Gen1aPollerStateFail;
+                        break;
+                    }
+                }
+            }
+            if(instance->mode == Gen1aPollerModeWriteDiff) {
+                while((instance->current_block < total_block_num) &&
+                      !bit_lib_get_bit(instance->changed_blocks, instance->current_block)) {
+                    instance->current_block++;
+                }
+                if(instance->current_block == total_block_num) {
+                    instance->state = Gen1aPollerStateSuccess;
+                    break;
+                }
             }
             error = gen1a_poller_write_block(
                 instance, instance->current_block, &mfc_data->block[instance->current_block]);
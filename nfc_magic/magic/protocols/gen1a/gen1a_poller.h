@@ -22,6 +22,7 @@ typedef enum {
     Gen1aPollerModeWipe,
     Gen1aPollerModeDump,
     Gen1aPollerModeWrite,
+    Gen1aPollerModeWriteDiff, // Write only the blocks that differ from the card
 } Gen1aPollerMode;
 
 typedef struct {
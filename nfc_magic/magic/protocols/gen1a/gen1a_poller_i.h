@@ -4,6 +4,7 @@
 #include <nfc/protocols/nfc_generic_event.h>
 #include <nfc/nfc_device.h>
 #include <nfc/protocols/mf_classic/mf_classic.h>
+#include <bit_lib/bit_lib.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,6 +12,8 @@ extern "C" {
 
 #define GEN1A_POLLER_MAX_BUFFER_SIZE (64U)
 #define GEN1A_POLLER_MAX_FWT (60000U)
+// Changed blocks in a row after which the rest of the card is written without reading it
+#define GEN1A_POLLER_DIFF_MISS_LIMIT (8U)
 
 typedef enum {
     Gen1aPollerErrorNone,
@@ -44,7 +47,9 @@ struct Gen1aPoller {
     Gen1aPollerState state;
     Gen1aPollerSessionState session_state;
 
+    Gen1aPollerMode mode;
     uint16_t current_block;
+    uint8_t changed_blocks[MF_CLASSIC_TOTAL_BLOCKS_MAX / 8]; // Diff write, blocks to write
     NfcDevice* mfc_device;
 
     BitBuffer* tx_buffer;
@@ -13,8 +13,41 @@
 
 #define BEBIT(x, n) FURI_BIT(x, (n) ^ 24)
 
+// Byte-wide engine tables, built on first use from the bit-serial step.
+// The feedback of 8 steps is linear in the state and input bits, so it is the xor of
+// one lookup per state byte and one for the input byte. Feedback bits f0..f7 are packed
+// as f1 f3 f5 f7 f0 f2 f4 f6, the nibbles shifted into odd and even respectively.
+static struct {
+    bool ready;
+    uint8_t filter_lo[256]; // Filter index bits of state bits 0..7
+    uint8_t filter_mid[256]; // Filter index bits of state bits 8..15
+    uint8_t feed_odd[3][256];
+    uint8_t feed_even[3][256];
+    uint8_t feed_in[256];
+} crypto1_tables;
+
+static uint8_t crypto1_feed_bits(uint32_t odd, uint32_t even, uint8_t in);
+
+static void crypto1_tables_init(void) {
+    if(crypto1_tables.ready) return;
+
+    for(size_t i = 0; i < 256; i++) {
+        crypto1_tables.filter_lo[i] = (0xf22c0 >> (i & 0xf) & 16) | (0x6c9c0 >> (i >> 4) & 8);
+        crypto1_tables.filter_mid[i] = (0x3c8b0 >> (i & 0xf) & 4) | (0x1e458 >> (i >> 4) & 2);
+    }
+    for(size_t i = 0; i < 256; i++) {
+        for(size_t j = 0; j < 3; j++) {
+            crypto1_tables.feed_odd[j][i] = crypto1_feed_bits(i << (8 * j), 0, 0);
+            crypto1_tables.feed_even[j][i] = crypto1_feed_bits(0, i << (8 * j), 0);
+        }
+        crypto1_tables.feed_in[i] = crypto1_feed_bits(0, 0, i);
+    }
+    crypto1_tables.ready = true;
+}
+
 Crypto1* crypto1_alloc() {
     Crypto1* instance = malloc(sizeof(Crypto1));
+    crypto1_tables_init();
 
     return instance;
 }
@@ -43,10 +76,8 @@ void crypto1_init(Crypto1* crypto1, uint64_t key) {
 
 static uint32_t crypto1_filter(uint32_t in) {
     uint32_t out = 0;
-    out = 0xf22c0 >> (in & 0xf) & 16;
-    out |= 0x6c9c0 >> (in >> 4 & 0xf) & 8;
-    out |= 0x3c8b0 >> (in >> 8 & 0xf) & 4;
-    out |= 0x1e458 >> (in >> 12 & 0xf) & 2;
+    out = crypto1_tables.filter_lo[in & 0xff];
+    out |= crypto1_tables.filter_mid[in >> 8 & 0xff];
     out |= 0x0d938 >> (in >> 16 & 0xf) & 1;
     return FURI_BIT(0xEC57E80A, out);
 }
@@ -64,11 +95,50 @@ uint8_t crypto1_bit(Crypto1* crypto1, uint8_t in, int is_encrypted) {
     return out;
 }
 
+static uint8_t crypto1_feed_bits(uint32_t odd, uint32_t even, uint8_t in) {
+    Crypto1 crypto1 = {.odd = odd, .even = even};
+    for(uint8_t i = 0; i < 8; i++) {
+        crypto1_bit(&crypto1, FURI_BIT(in, i), 0);
+    }
+    return (crypto1.odd & 0xf) << 4 | (crypto1.even & 0xf);
+}
+
+// 8 unencrypted steps at once, the keystream is filtered from the shifted state
+static uint8_t crypto1_byte_unencrypted(Crypto1* crypto1, uint8_t in) {
+    uint8_t feed = crypto1_tables.feed_in[in];
+    feed ^= crypto1_tables.feed_odd[0][crypto1->odd & 0xff];
+    feed ^= crypto1_tables.feed_odd[1][crypto1->odd >> 8 & 0xff];
+    feed ^= crypto1_tables.feed_odd[2][crypto1->odd >> 16 & 0xff];
+    feed ^= crypto1_tables.feed_even[0][crypto1->even & 0xff];
+    feed ^= crypto1_tables.feed_even[1][crypto1->even >> 8 & 0xff];
+    feed ^= crypto1_tables.feed_even[2][crypto1->even >> 16 & 0xff];
+
+    uint32_t odd = crypto1->odd << 4 | feed >> 4;
+    uint32_t even = crypto1->even << 4 | (feed & 0xf);
+    uint8_t out = crypto1_filter(odd >> 4);
+    out |= crypto1_filter(even >> 3) << 1;
+    out |= crypto1_filter(odd >> 3) << 2;
+    out |= crypto1_filter(even >> 2) << 3;
+    out |= crypto1_filter(odd >> 2) << 4;
+    out |= crypto1_filter(even >> 1) << 5;
+    out |= crypto1_filter(odd >> 1) << 6;
+    out |= crypto1_filter(even) << 7;
+
+    crypto1->odd = odd;
+    crypto1->even = even;
+    return out;
+}
+
 uint8_t crypto1_byte(Crypto1* crypto1, uint8_t in, int is_encrypted) {
     furi_assert(crypto1);
     uint8_t out = 0;
-    for(uint8_t i = 0; i < 8; i++) {
-        out |= crypto1_bit(crypto1, FURI_BIT(in, i), is_encrypted) << i;
+    if(is_encrypted) {
+        // Keystream is fed back, go bit by bit
+        for(uint8_t i = 0; i < 8; i++) {
+            out |= crypto1_bit(crypto1, FURI_BIT(in, i), is_encrypted) << i;
+        }
+    } else {
+        out = crypto1_byte_unencrypted(crypto1, in);
     }
     return out;
 }
@@ -76,8 +146,15 @@ uint8_t crypto1_byte(Crypto1* crypto1, uint8_t in, int is_encrypted) {
 uint32_t crypto1_word(Crypto1* crypto1, uint32_t in, int is_encrypted) {
     furi_assert(crypto1);
     uint32_t out = 0;
-    for(uint8_t i = 0; i < 32; i++) {
-        out |= (uint32_t)crypto1_bit(crypto1, BEBIT(in, i), is_encrypted) << (24 ^ i);
+    if(is_encrypted) {
+        for(uint8_t i = 0; i < 32; i++) {
+            out |= (uint32_t)crypto1_bit(crypto1, BEBIT(in, i), is_encrypted) << (24 ^ i);
+        }
+    } else {
+        // Big endian byte order, each byte least significant bit first
+        for(int8_t shift = 24; shift >= 0; shift -= 8) {
+            out |= (uint32_t)crypto1_byte_unencrypted(crypto1, in >> shift) << shift;
+        }
     }
     return out;
 }
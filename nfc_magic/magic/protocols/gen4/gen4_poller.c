@@ -204,6 +204,8 @@ NfcCommand gen4_poller_idle_handler(Gen4Poller* instance) {
     NfcCommand command = NfcCommandContinue;
 
     instance->current_block = 0;
+    memset(instance->phase_ms, 0, sizeof(instance->phase_ms));
+    instance->write_retries = 0;
 
     instance->gen4_event.type = Gen4PollerEventTypeCardDetected;
     command = instance->callback(instance->gen4_event, instance->context);
@@ -217,9 +219,12 @@ NfcCommand gen4_poller_request_mode_handler(Gen4Poller* instance) {
 
     instance->gen4_event.type = Gen4PollerEventTypeRequestMode;
     command = instance->callback(instance->gen4_event, instance->context);
+    instance->mode = instance->gen4_event_data.request_mode.mode;
     if(instance->gen4_event_data.request_mode.mode == Gen4PollerModeWipe) {
         instance->state = Gen4PollerStateWipe;
-    } else if(instance->gen4_event_data.request_mode.mode == Gen4PollerModeWrite) {
+    } else if(
+        (instance->gen4_event_data.request_mode.mode == Gen4PollerModeWrite) ||
+        (instance->gen4_event_data.request_mode.mode == Gen4PollerModeWriteDiff)) {
         instance->state = Gen4PollerStateRequestWriteData;
     } else if(instance->gen4_event_data.request_mode.mode == Gen4PollerModeSetPassword) {
         instance->state = Gen4PollerStateChangePassword;
@@ -238,47 +243,173 @@ NfcCommand gen4_poller_request_mode_handler(Gen4Poller* instance) {
     return command;
 }
 
+static const uint8_t* gen4_poller_wipe_block_data(Gen4Poller* instance, uint16_t block_num) {
+    UNUSED(instance);
+
+    if(block_num == 0) {
+        return gen4_poller_default_block_0;
+    } else if(gen4_poller_is_sector_trailer(block_num)) {
+        return gen4_poller_default_sector_trailer_block;
+    } else {
+        return gen4_poller_default_empty_block;
+    }
+}
+
+static const uint8_t* gen4_poller_mf_classic_block_data(Gen4Poller* instance, uint16_t block_num) {
+    const MfClassicData* mfc_data = instance->data;
+
+    return mfc_data->block[block_num].data;
+}
+
+static const uint8_t*
+    gen4_poller_mf_ultralight_block_data(Gen4Poller* instance, uint16_t block_num) {
+    const MfUltralightData* mfu_data = instance->data;
+
+    return mfu_data->page[block_num].data;
+}
+
+// Read the card and mark the blocks that differ from the source, block_size bytes per block
+static Gen4PollerError gen4_poller_diff_blocks(
+    Gen4Poller* instance,
+    Gen4PollerBlockData block_data,
+    size_t block_size,
+    uint16_t block_num) {
+    Gen4PollerError error = Gen4PollerErrorNone;
+    uint8_t block[GEN4_POLLER_BLOCK_SIZE] = {};
+    uint8_t misses = 0;
+    uint32_t start = furi_get_tick();
+
+    memset(instance->changed_blocks, 0xFF, sizeof(instance->changed_blocks));
+    block_num = MIN(block_num, GEN4_POLLER_BLOCKS_TOTAL);
+    for(uint16_t i = 0; i < block_num; i++) {
+        // A card this different is likely blank, reading the rest would only add frames
+        if(misses == GEN4_POLLER_DIFF_MISS_LIMIT) break;
+
+        error = gen4_poller_read_block(instance, instance->password, i, block);
+        if(error != Gen4PollerErrorNone) break;
+
+        if(memcmp(block, block_data(instance, i), block_size) == 0) {
+            bit_lib_set_bit(instance->changed_blocks, i, false);
+            misses = 0;
+        } else {
+            misses++;
+        }
+    }
+    instance->phase_ms[Gen4PollerPhaseRead] += furi_get_tick() - start;
+
+    return error;
+}
+
+// Skip the blocks a diff write found unchanged, returns false when none is left
+static bool gen4_poller_next_changed_block(Gen4Poller* instance, uint16_t block_num) {
+    if(instance->mode == Gen4PollerModeWriteDiff) {
+        while((instance->current_block < MIN(block_num, GEN4_POLLER_BLOCKS_TOTAL)) &&
+              !bit_lib_get_bit(instance->changed_blocks, instance->current_block)) {
+            instance->current_block++;
+        }
+    }
+
+    return instance->current_block < block_num;
+}
+
+// Write one block, a write left without an answer is read back before it is sent again
+static Gen4PollerError gen4_poller_write_block_checked(
+    Gen4Poller* instance,
+    uint8_t block_num,
+    const uint8_t* data,
+    size_t block_size) {
+    Gen4PollerError error = Gen4PollerErrorNone;
+    uint8_t block[GEN4_POLLER_BLOCK_SIZE] = {};
+
+    for(size_t i = 0; i < GEN4_POLLER_WRITE_RETRIES; i++) {
+        error = gen4_poller_write_block(instance, instance->password, block_num, data);
+        if(error == Gen4PollerErrorNone) break;
+
+        instance->write_retries++;
+        if((gen4_poller_read_block(instance, instance->password, block_num, block) ==
+            Gen4PollerErrorNone) &&
+           (memcmp(block, data, block_size) == 0)) {
+            error = Gen4PollerErrorNone;
+            break;
+        }
+    }
+
+    return error;
+}
+
+// Write up to GEN4_POLLER_WRITE_RUN blocks from current_block on without leaving the callback
+static Gen4PollerError gen4_poller_write_run(
+    Gen4Poller* instance,
+    Gen4PollerBlockData block_data,
+    size_t block_size,
+    uint16_t block_num) {
+    Gen4PollerError error = Gen4PollerErrorNone;
+    uint32_t start = furi_get_tick();
+
+    for(size_t i = 0; i < GEN4_POLLER_WRITE_RUN; i++) {
+        if(!gen4_poller_next_changed_block(instance, block_num)) break;
+
+        error = gen4_poller_write_block_checked(
+            instance,
+            instance->current_block,
+            block_data(instance, instance->current_block),
+            block_size);
+        if(error != Gen4PollerErrorNone) {
+            FURI_LOG_D(TAG, "Failed to write %d block: %d", instance->current_block, error);
+            break;
+        }
+        instance->current_block++;
+    }
+    instance->phase_ms[Gen4PollerPhaseWrite] += furi_get_tick() - start;
+
+    return error;
+}
+
+static void gen4_poller_log_phases(Gen4Poller* instance) {
+    FURI_LOG_I(
+        TAG,
+        "Config %lu ms, read %lu ms, write %lu ms, %u retries",
+        instance->phase_ms[Gen4PollerPhaseConfig],
+        instance->phase_ms[Gen4PollerPhaseRead],
+        instance->phase_ms[Gen4PollerPhaseWrite],
+        instance->write_retries);
+}
+
 NfcCommand gen4_poller_wipe_handler(Gen4Poller* instance) {
     NfcCommand command = NfcCommandContinue;
 
     do {
         Gen4PollerError error = Gen4PollerErrorNone;
         if(instance->current_block == 0) {
+            uint32_t start = furi_get_tick();
             error = gen4_poller_set_config(
                 instance,
                 instance->password,
                 &gen4_poller_default_config,
                 GEN4_POLLER_DEFAULT_CONFIG_SIZE,
                 false);
+            instance->phase_ms[Gen4PollerPhaseConfig] += furi_get_tick() - start;
             if(error != Gen4PollerErrorNone) {
                 FURI_LOG_D(TAG, "Failed to set default config: %d", error);
                 instance->state = Gen4PollerStateFail;
                 break;
             }
             gen4_password_reset(&instance->password);
-            error = gen4_poller_write_block(
-                instance, instance->password, instance->current_block, gen4_poller_default_block_0);
-            if(error != Gen4PollerErrorNone) {
-                FURI_LOG_D(TAG, "Failed to write 0 block: %d", error);
-                instance->state = Gen4PollerStateFail;
-                break;
-            }
-        } else if(instance->current_block < GEN4_POLLER_BLOCKS_TOTAL) {
-            const uint8_t* block = gen4_poller_is_sector_trailer(instance->current_block) ?
-                                       gen4_poller_default_sector_trailer_block :
-                                       gen4_poller_default_empty_block;
-            error = gen4_poller_write_block(
-                instance, instance->password, instance->current_block, block);
+        }
+        if(instance->current_block < GEN4_POLLER_BLOCKS_TOTAL) {
+            error = gen4_poller_write_run(
+                instance,
+                gen4_poller_wipe_block_data,
+                GEN4_POLLER_BLOCK_SIZE,
+                GEN4_POLLER_BLOCKS_TOTAL);
             if(error != Gen4PollerErrorNone) {
-                FURI_LOG_D(TAG, "Failed to write %d block: %d", instance->current_block, error);
                 instance->state = Gen4PollerStateFail;
                 break;
             }
         } else {
+            gen4_poller_log_phases(instance);
             instance->state = Gen4PollerStateSuccess;
-            break;
         }
-        instance->current_block++;
     } while(false);
 
     return command;
@@ -331,31 +462,43 @@ static NfcCommand gen4_poller_write_mf_classic(Gen4Poller* instance) {
             instance->config.data_parsed.total_blocks = instance->total_blocks - 1;
             instance->config.data_parsed.direct_write_mode = Gen4DirectWriteBlock0ModeDisabled;
 
+            uint32_t start = furi_get_tick();
             Gen4PollerError error = gen4_poller_set_config(
                 instance, instance->password, &instance->config, GEN4_CONFIG_SIZE, false);
+            instance->phase_ms[Gen4PollerPhaseConfig] += furi_get_tick() - start;
             if(error != Gen4PollerErrorNone) {
                 FURI_LOG_D(TAG, "Failed to write config: %d", error);
                 instance->state = Gen4PollerStateFail;
                 break;
             }
+            if(instance->mode == Gen4PollerModeWriteDiff) {
+                error = gen4_poller_diff_blocks(
+                    instance,
+                    gen4_poller_mf_classic_block_data,
+                    sizeof(MfClassicBlock),
+                    instance->total_blocks);
+                if(error != Gen4PollerErrorNone) {
+                    FURI_LOG_D(TAG, "Failed to read blocks: %d", error);
+                    instance->state = Gen4PollerStateFail;
+                    break;
+                }
+            }
         }
-        if(instance->current_block < instance->total_blocks) {
-            FURI_LOG_D(TAG, "Writing block %d", instance->current_block);
-            Gen4PollerError error = gen4_poller_write_block(
+        if(gen4_poller_next_changed_block(instance, instance->total_blocks)) {
+            FURI_LOG_D(TAG, "Writing from block %d", instance->current_block);
+            Gen4PollerError error = gen4_poller_write_run(
                 instance,
-                instance->password,
-                instance->current_block,
-                mfc_data->block[instance->current_block].data);
+                gen4_poller_mf_classic_block_data,
+                sizeof(MfClassicBlock),
+                instance->total_blocks);
             if(error != Gen4PollerErrorNone) {
-                FURI_LOG_D(TAG, "Failed to write %d block: %d", instance->current_block, error);
                 instance->state = Gen4PollerStateFail;
                 break;
             }
         } else {
+            gen4_poller_log_phases(instance);
             instance->state = Gen4PollerStateSuccess;
-            break;
         }
-        instance->current_block++;
     } while(false);
 
     return command;
@@ -419,29 +562,41 @@ static NfcCommand gen4_poller_write_mf_ultralight(Gen4Poller* instance) {
             instance->config.data_parsed.total_blocks = instance->total_blocks - 1;
             instance->config.data_parsed.direct_write_mode = Gen4DirectWriteBlock0ModeDisabled;
 
+            uint32_t start = furi_get_tick();
             Gen4PollerError error = gen4_poller_set_config(
                 instance, instance->password, &instance->config, GEN4_CONFIG_SIZE, false);
+            instance->phase_ms[Gen4PollerPhaseConfig] += furi_get_tick() - start;
             if(error != Gen4PollerErrorNone) {
                 FURI_LOG_D(TAG, "Failed to write config: %d", error);
                 instance->state = Gen4PollerStateFail;
                 break;
             }
+            if(instance->mode == Gen4PollerModeWriteDiff) {
+                error = gen4_poller_diff_blocks(
+                    instance,
+                    gen4_poller_mf_ultralight_block_data,
+                    sizeof(MfUltralightPage),
+                    mfu_data->pages_read);
+                if(error != Gen4PollerErrorNone) {
+                    FURI_LOG_D(TAG, "Failed to read pages: %d", error);
+                    instance->state = Gen4PollerStateFail;
+                    break;
+                }
+            }
         }
 
-        if(instance->current_block < mfu_data->pages_read) {
+        if(gen4_poller_next_changed_block(instance, mfu_data->pages_read)) {
             FURI_LOG_D(
-                TAG, "Writing page %zu / %zu", instance->current_block, mfu_data->pages_read);
-            Gen4PollerError error = gen4_poller_write_block(
+                TAG, "Writing from page %zu / %zu", instance->current_block, mfu_data->pages_read);
+            Gen4PollerError error = gen4_poller_write_run(
                 instance,
-                instance->password,
-                instance->current_block,
-                mfu_data->page[instance->current_block].data);
+                gen4_poller_mf_ultralight_block_data,
+                sizeof(MfUltralightPage),
+                mfu_data->pages_read);
             if(error != Gen4PollerErrorNone) {
-                FURI_LOG_D(TAG, "Failed to write %d page: %d", instance->current_block, error);
                 instance->state = Gen4PollerStateFail;
                 break;
             }
-            instance->current_block++;
         } else {
             uint8_t block[GEN4_POLLER_BLOCK_SIZE] = {};
             bool write_success = true;
@@ -545,6 +700,7 @@ static NfcCommand gen4_poller_write_mf_ultralight(Gen4Poller* instance) {
                 FURI_LOG_D(TAG, "Password is not supported, skipping");
             }
 
+            gen4_poller_log_phases(instance);
             instance->state = Gen4PollerStateSuccess;
         }
     } while(false);
@@ -39,6 +39,7 @@ typedef enum {
 typedef enum {
     Gen4PollerModeWipe,
     Gen4PollerModeWrite,
+    Gen4PollerModeWriteDiff, // Write only the blocks that differ from the card
     Gen4PollerModeSetPassword,
 
     Gen4PollerModeGetInfo,
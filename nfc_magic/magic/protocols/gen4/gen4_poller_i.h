@@ -16,6 +16,11 @@ extern "C" {
 
 #define GEN4_POLLER_BLOCK_SIZE (16)
 #define GEN4_POLLER_BLOCKS_TOTAL (256)
+// Changed blocks in a row after which the rest of the card is written without reading it
+#define GEN4_POLLER_DIFF_MISS_LIMIT (8U)
+// Blocks written per poller callback
+#define GEN4_POLLER_WRITE_RUN (16U)
+#define GEN4_POLLER_WRITE_RETRIES (3U)
 
 typedef enum {
     Gen4PollerStateIdle,
@@ -36,6 +41,14 @@ typedef enum {
     Gen4PollerStateNum,
 } Gen4PollerState;
 
+typedef enum {
+    Gen4PollerPhaseConfig,
+    Gen4PollerPhaseRead, // Diff write read pass
+    Gen4PollerPhaseWrite,
+
+    Gen4PollerPhaseNum,
+} Gen4PollerPhase;
+
 struct Gen4Poller {
     NfcPoller* poller;
     Iso14443_3aPoller* iso3_poller;
@@ -53,8 +66,12 @@ struct Gen4Poller {
     BitBuffer* tx_buffer;
     BitBuffer* rx_buffer;
 
+    Gen4PollerMode mode;
     uint16_t current_block;
     uint16_t total_blocks;
+    uint8_t changed_blocks[GEN4_POLLER_BLOCKS_TOTAL / 8]; // Diff write, blocks to write
+    uint32_t phase_ms[Gen4PollerPhaseNum];
+    uint16_t write_retries;
 
     NfcProtocol protocol;
     const NfcDeviceData* data;
@@ -66,6 +83,9 @@ struct Gen4Poller {
     void* context;
 };
 
+// Source data of one block, for the block write engine
+typedef const uint8_t* (*Gen4PollerBlockData)(Gen4Poller* instance, uint16_t block_num);
+
 Gen4PollerError gen4_poller_set_config(
     Gen4Poller* instance,
     Gen4Password password,
@@ -79,6 +99,12 @@ Gen4PollerError gen4_poller_write_block(
     uint8_t block_num,
     const uint8_t* data);
 
+Gen4PollerError gen4_poller_read_block(
+    Gen4Poller* instance,
+    Gen4Password password,
+    uint8_t block_num,
+    uint8_t* data);
+
 Gen4PollerError gen4_poller_change_password(
     Gen4Poller* instance,
     Gen4Password pwd_current,
@@ -2,6 +2,7 @@
 
 #include "nfc_magic_app.h"
 #include "helpers/nfc_magic_custom_events.h"
+#include "helpers/nfc_magic_key_cache.h"
 
 #include <furi.h>
 #include <gui/gui.h>
@@ -48,6 +49,7 @@
 
 #define NFC_APP_MF_CLASSIC_DICT_USER_PATH (NFC_APP_FOLDER "/assets/mf_classic_dict_user.nfc")
 #define NFC_APP_MF_CLASSIC_DICT_SYSTEM_PATH (NFC_APP_FOLDER "/assets/mf_classic_dict.nfc")
+#define NFC_APP_MF_CLASSIC_KEY_HITS_PATH (NFC_APP_FOLDER "/.nfc_magic_key_hits")
 
 #define NFC_MAGIC_APP_NAME_SIZE 22
 #define NFC_MAGIC_APP_TEXT_STORE_SIZE 128
@@ -73,7 +75,7 @@ enum NfcMagicAppCustomEvent {
 };
 
 typedef struct {
-    KeysDict* dict;
+    NfcMagicKeyCache* key_cache;
     uint8_t sectors_total;
     uint8_t sectors_read;
     uint8_t current_sector;
@@ -55,8 +55,7 @@ NfcCommand nfc_dict_attack_worker_callback(NfcGenericEvent event, void* context)
             instance->view_dispatcher, NfcMagicAppCustomEventDictAttackDataUpdate);
     } else if(mfc_event->type == MfClassicPollerEventTypeRequestKey) {
         MfClassicKey key = {};
-        if(keys_dict_get_next_key(
-               instance->nfc_dict_context.dict, key.data, sizeof(MfClassicKey))) {
+        if(nfc_magic_key_cache_get_next_key(instance->nfc_dict_context.key_cache, &key)) {
             mfc_event->data->key_request_data.key = key;
             mfc_event->data->key_request_data.key_provided = true;
             instance->nfc_dict_context.dict_keys_current++;
@@ -75,16 +74,18 @@ NfcCommand nfc_dict_attack_worker_callback(NfcGenericEvent event, void* context)
         view_dispatcher_send_custom_event(
             instance->view_dispatcher, NfcMagicAppCustomEventDictAttackDataUpdate);
     } else if(mfc_event->type == MfClassicPollerEventTypeNextSector) {
-        keys_dict_rewind(instance->nfc_dict_context.dict);
+        nfc_magic_key_cache_rewind(instance->nfc_dict_context.key_cache);
         instance->nfc_dict_context.dict_keys_current = 0;
         instance->nfc_dict_context.current_sector =
             mfc_event->data->next_sector_data.current_sector;
         view_dispatcher_send_custom_event(
             instance->view_dispatcher, NfcMagicAppCustomEventDictAttackDataUpdate);
     } else if(mfc_event->type == MfClassicPollerEventTypeFoundKeyA) {
+        nfc_magic_key_cache_key_found(instance->nfc_dict_context.key_cache);
         view_dispatcher_send_custom_event(
             instance->view_dispatcher, NfcMagicAppCustomEventDictAttackDataUpdate);
     } else if(mfc_event->type == MfClassicPollerEventTypeFoundKeyB) {
+        nfc_magic_key_cache_key_found(instance->nfc_dict_context.key_cache);
         view_dispatcher_send_custom_event(
             instance->view_dispatcher, NfcMagicAppCustomEventDictAttackDataUpdate);
     } else if(mfc_event->type == MfClassicPollerEventTypeKeyAttackStart) {
@@ -94,7 +95,7 @@ NfcCommand nfc_dict_attack_worker_callback(NfcGenericEvent event, void* context)
         view_dispatcher_send_custom_event(
             instance->view_dispatcher, NfcMagicAppCustomEventDictAttackDataUpdate);
     } else if(mfc_event->type == MfClassicPollerEventTypeKeyAttackStop) {
-        keys_dict_rewind(instance->nfc_dict_context.dict);
+        nfc_magic_key_cache_rewind(instance->nfc_dict_context.key_cache);
         instance->nfc_dict_context.is_key_attack = false;
         instance->nfc_dict_context.dict_keys_current = 0;
         view_dispatcher_send_custom_event(
@@ -138,32 +139,21 @@ static void nfc_magic_scene_mf_classic_dict_attack_update_view(NfcMagicApp* inst
 static void nfc_magic_scene_mf_classic_dict_attack_prepare_view(NfcMagicApp* instance) {
     uint32_t state =
         scene_manager_get_scene_state(instance->scene_manager, NfcMagicSceneMfClassicDictAttack);
+    NfcMagicKeyCache* key_cache = instance->nfc_dict_context.key_cache;
     if(state == DictAttackStateUserDictInProgress) {
-        do {
-            if(!keys_dict_check_presence(NFC_APP_MF_CLASSIC_DICT_USER_PATH)) {
-                state = DictAttackStateSystemDictInProgress;
-                break;
-            }
-
-            instance->nfc_dict_context.dict = keys_dict_alloc(
-                NFC_APP_MF_CLASSIC_DICT_USER_PATH, KeysDictModeOpenAlways, sizeof(MfClassicKey));
-            if(keys_dict_get_total_keys(instance->nfc_dict_context.dict) == 0) {
-                keys_dict_free(instance->nfc_dict_context.dict);
-                state = DictAttackStateSystemDictInProgress;
-                break;
-            }
-
+        if(nfc_magic_key_cache_select(key_cache, NfcMagicKeyCacheDictUser)) {
             dict_attack_set_header(instance->dict_attack, "MF Classic User Dictionary");
-        } while(false);
+        } else {
+            state = DictAttackStateSystemDictInProgress;
+        }
     }
     if(state == DictAttackStateSystemDictInProgress) {
-        instance->nfc_dict_context.dict = keys_dict_alloc(
-            NFC_APP_MF_CLASSIC_DICT_SYSTEM_PATH, KeysDictModeOpenExisting, sizeof(MfClassicKey));
+        // Keys already tried from the user dictionary are not in this one
+        nfc_magic_key_cache_select(key_cache, NfcMagicKeyCacheDictSystem);
         dict_attack_set_header(instance->dict_attack, "MF Classic System Dictionary");
     }
 
-    instance->nfc_dict_context.dict_keys_total =
-        keys_dict_get_total_keys(instance->nfc_dict_context.dict);
+    instance->nfc_dict_context.dict_keys_total = nfc_magic_key_cache_get_total_keys(key_cache);
     dict_attack_set_total_dict_keys(
         instance->dict_attack, instance->nfc_dict_context.dict_keys_total);
     instance->nfc_dict_context.dict_keys_current = 0;
@@ -183,6 +173,12 @@ void nfc_magic_scene_mf_classic_dict_attack_on_enter(void* context) {
         instance->scene_manager,
         NfcMagicSceneMfClassicDictAttack,
         DictAttackStateUserDictInProgress);
+    // Both dictionaries are read once here instead of once per sector
+    instance->nfc_dict_context.key_cache = nfc_magic_key_cache_alloc(
+        instance->storage,
+        NFC_APP_MF_CLASSIC_DICT_USER_PATH,
+        NFC_APP_MF_CLASSIC_DICT_SYSTEM_PATH,
+        NFC_APP_MF_CLASSIC_KEY_HITS_PATH);
     nfc_magic_scene_mf_classic_dict_attack_prepare_view(instance);
     dict_attack_set_card_state(instance->dict_attack, true);
     view_dispatcher_switch_to_view(instance->view_dispatcher, NfcMagicAppViewDictAttack);
@@ -214,7 +210,6 @@ bool nfc_magic_scene_mf_classic_dict_attack_on_event(void* context, SceneManager
             if(state == DictAttackStateUserDictInProgress) {
                 nfc_poller_stop(instance->poller);
                 nfc_poller_free(instance->poller);
-                keys_dict_free(instance->nfc_dict_context.dict);
                 scene_manager_set_scene_state(
                     instance->scene_manager,
                     NfcMagicSceneMfClassicDictAttack,
@@ -249,7 +244,6 @@ bool nfc_magic_scene_mf_classic_dict_attack_on_event(void* context, SceneManager
                 if(instance->nfc_dict_context.is_card_present) {
                     nfc_poller_stop(instance->poller);
                     nfc_poller_free(instance->poller);
-                    keys_dict_free(instance->nfc_dict_context.dict);
                     scene_manager_set_scene_state(
                         instance->scene_manager,
                         NfcMagicSceneMfClassicDictAttack,
@@ -302,7 +296,10 @@ void nfc_magic_scene_mf_classic_dict_attack_on_exit(void* context) {
         NfcMagicSceneMfClassicDictAttack,
         DictAttackStateUserDictInProgress);
 
-    keys_dict_free(instance->nfc_dict_context.dict);
+    nfc_magic_key_cache_save_hits(
+        instance->nfc_dict_context.key_cache, NFC_APP_MF_CLASSIC_KEY_HITS_PATH);
+    nfc_magic_key_cache_free(instance->nfc_dict_context.key_cache);
+    instance->nfc_dict_context.key_cache = NULL;
 
     instance->nfc_dict_context.current_sector = 0;
     instance->nfc_dict_context.sectors_total = 0;
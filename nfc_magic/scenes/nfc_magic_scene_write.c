@@ -15,7 +15,7 @@ NfcCommand nfc_magic_scene_write_gen1_poller_callback(Gen1aPollerEvent event, vo
         view_dispatcher_send_custom_event(
             instance->view_dispatcher, NfcMagicCustomEventCardDetected);
     } else if(event.type == Gen1aPollerEventTypeRequestMode) {
-        event.data->request_mode.mode = Gen1aPollerModeWrite;
+        event.data->request_mode.mode = Gen1aPollerModeWriteDiff;
     } else if(event.type == Gen1aPollerEventTypeRequestDataToWrite) {
         const MfClassicData* mfc_data =
             nfc_device_get_data(instance->source_dev, NfcProtocolMfClassic);
@@ -75,7 +75,7 @@ NfcCommand nfc_magic_scene_write_gen4_poller_callback(Gen4PollerEvent event, voi
         view_dispatcher_send_custom_event(
             instance->view_dispatcher, NfcMagicCustomEventCardDetected);
     } else if(event.type == Gen4PollerEventTypeRequestMode) {
-        event.data->request_mode.mode = Gen4PollerModeWrite;
+        event.data->request_mode.mode = Gen4PollerModeWriteDiff;
     } else if(event.type == Gen4PollerEventTypeRequestDataToWrite) {
         NfcProtocol protocol = nfc_device_get_protocol(instance->source_dev);
         event.data->request_data.protocol = protocol;
@@ -0,0 +1,407 @@
+// Checks the byte-wide Crypto1 engine of the Gen2 poller against the bit-serial step it
+// replaced, on random states and inputs, and times both on the frames the poller sends
+//
+//   ./crypto1_test
+
+#include <furi.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "magic/protocols/gen2/crypto1.c"
+
+#define CRYPTO1_TEST_STATES    200000
+#define CRYPTO1_TEST_OPS       4 // Operations run on every state
+#define CRYPTO1_TEST_FRAME     18 // Data block with CRC, the longest frame the poller sends
+#define CRYPTO1_TEST_FRAMES    200000
+#define CRYPTO1_TEST_NONCES    200000
+#define CRYPTO1_TEST_BUF_BYTES 32
+
+typedef enum {
+    Crypto1TestOpBit,
+    Crypto1TestOpByte,
+    Crypto1TestOpWord,
+    Crypto1TestOpEncrypt,
+    Crypto1TestOpDecrypt,
+    Crypto1TestOpReaderNonce,
+
+    Crypto1TestOpNum,
+} Crypto1TestOp;
+
+static const char* crypto1_test_op_names[Crypto1TestOpNum] = {
+    "bit",
+    "byte",
+    "word",
+    "encrypt",
+    "decrypt",
+    "reader nonce",
+};
+
+static uint32_t crypto1_test_rng = 0x2545F491;
+
+static uint32_t crypto1_test_random(void) {
+    crypto1_test_rng ^= crypto1_test_rng << 13;
+    crypto1_test_rng ^= crypto1_test_rng >> 17;
+    crypto1_test_rng ^= crypto1_test_rng << 5;
+    return crypto1_test_rng;
+}
+
+static uint64_t crypto1_test_random_key(void) {
+    return ((uint64_t)crypto1_test_random() << 16 ^ crypto1_test_random()) & 0xFFFFFFFFFFFF;
+}
+
+static uint64_t crypto1_test_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+// Bit-serial reference, the step crypto1.c ran before the byte tables
+
+static uint32_t ref_filter(uint32_t in) {
+    uint32_t out = 0;
+    out = 0xf22c0 >> (in & 0xf) & 16;
+    out |= 0x6c9c0 >> (in >> 4 & 0xf) & 8;
+    out |= 0x3c8b0 >> (in >> 8 & 0xf) & 4;
+    out |= 0x1e458 >> (in >> 12 & 0xf) & 2;
+    out |= 0x0d938 >> (in >> 16 & 0xf) & 1;
+    return FURI_BIT(0xEC57E80A, out);
+}
+
+static uint8_t ref_bit(Crypto1* crypto1, uint8_t in, int is_encrypted) {
+    uint8_t out = ref_filter(crypto1->odd);
+    uint32_t feed = out & (!!is_encrypted);
+    feed ^= !!in;
+    feed ^= LF_POLY_ODD & crypto1->odd;
+    feed ^= LF_POLY_EVEN & crypto1->even;
+    crypto1->even = crypto1->even << 1 | (nfc_util_even_parity32(feed));
+
+    FURI_SWAP(crypto1->odd, crypto1->even);
+    return out;
+}
+
+static uint8_t ref_byte(Crypto1* crypto1, uint8_t in, int is_encrypted) {
+    uint8_t out = 0;
+    for(uint8_t i = 0; i < 8; i++) {
+        out |= ref_bit(crypto1, FURI_BIT(in, i), is_encrypted) << i;
+    }
+    return out;
+}
+
+static uint32_t ref_word(Crypto1* crypto1, uint32_t in, int is_encrypted) {
+    uint32_t out = 0;
+    for(uint8_t i = 0; i < 32; i++) {
+        out |= (uint32_t)ref_bit(crypto1, BEBIT(in, i), is_encrypted) << (24 ^ i);
+    }
+    return out;
+}
+
+static void ref_decrypt(Crypto1* crypto, const BitBuffer* buff, BitBuffer* out) {
+    size_t bits = bit_buffer_get_size(buff);
+    bit_buffer_set_size(out, bits);
+    const uint8_t* encrypted_data = bit_buffer_get_data(buff);
+    if(bits < 8) {
+        uint8_t decrypted_byte = 0;
+        for(size_t i = 0; i < 4; i++) {
+            decrypted_byte |= (ref_bit(crypto, 0, 0) ^ FURI_BIT(encrypted_data[0], i)) << i;
+        }
+        bit_buffer_set_byte(out, 0, decrypted_byte);
+    } else {
+        for(size_t i = 0; i < bits / 8; i++) {
+            bit_buffer_set_byte(out, i, ref_byte(crypto, 0, 0) ^ encrypted_data[i]);
+        }
+    }
+}
+
+static void
+    ref_encrypt(Crypto1* crypto, uint8_t* keystream, const BitBuffer* buff, BitBuffer* out) {
+    size_t bits = bit_buffer_get_size(buff);
+    bit_buffer_set_size(out, bits);
+    const uint8_t* plain_data = bit_buffer_get_data(buff);
+    if(bits < 8) {
+        uint8_t encrypted_byte = 0;
+        for(size_t i = 0; i < bits; i++) {
+            encrypted_byte |= (ref_bit(crypto, 0, 0) ^ FURI_BIT(plain_data[0], i)) << i;
+        }
+        bit_buffer_set_byte(out, 0, encrypted_byte);
+    } else {
+        for(size_t i = 0; i < bits / 8; i++) {
+            uint8_t encrypted_byte =
+                ref_byte(crypto, keystream ? keystream[i] : 0, 0) ^ plain_data[i];
+            bool parity_bit =
+                ((ref_filter(crypto->odd) ^ nfc_util_odd_parity8(plain_data[i])) & 0x01);
+            bit_buffer_set_byte_with_parity(out, i, encrypted_byte, parity_bit);
+        }
+    }
+}
+
+static void ref_encrypt_reader_nonce(
+    Crypto1* crypto,
+    uint64_t key,
+    uint32_t cuid,
+    uint8_t* nt,
+    uint8_t* nr,
+    BitBuffer* out,
+    bool is_nested) {
+    bit_buffer_set_size_bytes(out, 8);
+    uint32_t nt_num = bit_lib_bytes_to_num_be(nt, sizeof(uint32_t));
+
+    crypto1_init(crypto, key);
+    if(is_nested) {
+        nt_num = ref_word(crypto, nt_num ^ cuid, 1) ^ nt_num;
+    } else {
+        ref_word(crypto, nt_num ^ cuid, 0);
+    }
+
+    for(size_t i = 0; i < 4; i++) {
+        uint8_t byte = ref_byte(crypto, nr[i], 0) ^ nr[i];
+        bool parity_bit = ((ref_filter(crypto->odd) ^ nfc_util_odd_parity8(nr[i])) & 0x01);
+        bit_buffer_set_byte_with_parity(out, i, byte, parity_bit);
+        nr[i] = byte;
+    }
+
+    nt_num = prng_successor(nt_num, 32);
+    for(size_t i = 4; i < 8; i++) {
+        nt_num = prng_successor(nt_num, 8);
+        uint8_t byte = ref_byte(crypto, 0, 0) ^ (uint8_t)(nt_num);
+        bool parity_bit = ((ref_filter(crypto->odd) ^ nfc_util_odd_parity8(nt_num)) & 0x01);
+        bit_buffer_set_byte_with_parity(out, i, byte, parity_bit);
+    }
+}
+
+// Differential test
+
+static bool crypto1_test_buffers_equal(const BitBuffer* a, const BitBuffer* b) {
+    size_t bits = bit_buffer_get_size(a);
+    if(bits != bit_buffer_get_size(b)) return false;
+    size_t bytes = (bits + 7) / 8;
+    return (memcmp(bit_buffer_get_data(a), bit_buffer_get_data(b), bytes) == 0) &&
+           (memcmp(bit_buffer_get_parity(a), bit_buffer_get_parity(b), (bytes + 7) / 8) == 0);
+}
+
+// Runs one random operation on both engines, false on the first difference
+static bool crypto1_test_op(
+    Crypto1TestOp op,
+    Crypto1* crypto,
+    Crypto1* ref,
+    BitBuffer* in,
+    BitBuffer* out,
+    BitBuffer* ref_out) {
+    uint32_t value = crypto1_test_random();
+    int is_encrypted = crypto1_test_random() & 1;
+    bit_buffer_reset(out);
+    bit_buffer_reset(ref_out);
+
+    bool same = true;
+    switch(op) {
+    case Crypto1TestOpBit:
+        same = crypto1_bit(crypto, value & 1, is_encrypted) ==
+               ref_bit(ref, value & 1, is_encrypted);
+        break;
+    case Crypto1TestOpByte:
+        same = crypto1_byte(crypto, value, is_encrypted) == ref_byte(ref, value, is_encrypted);
+        break;
+    case Crypto1TestOpWord:
+        same = crypto1_word(crypto, value, is_encrypted) == ref_word(ref, value, is_encrypted);
+        break;
+    case Crypto1TestOpEncrypt:
+    case Crypto1TestOpDecrypt: {
+        // A 4 bit ACK/NAK now and then, whole frames otherwise
+        size_t bytes = 1 + value % CRYPTO1_TEST_FRAME;
+        uint8_t data[CRYPTO1_TEST_FRAME];
+        uint8_t keystream[CRYPTO1_TEST_FRAME];
+        for(size_t i = 0; i < bytes; i++) {
+            data[i] = crypto1_test_random();
+            keystream[i] = crypto1_test_random();
+        }
+        if(value % 8 == 0) {
+            bit_buffer_copy_bits(in, data, 4);
+        } else {
+            bit_buffer_copy_bytes(in, data, bytes);
+        }
+        if(op == Crypto1TestOpEncrypt) {
+            uint8_t* ks = is_encrypted ? keystream : NULL;
+            crypto1_encrypt(crypto, ks, in, out);
+            ref_encrypt(ref, ks, in, ref_out);
+        } else {
+            crypto1_decrypt(crypto, in, out);
+            ref_decrypt(ref, in, ref_out);
+        }
+        same = crypto1_test_buffers_equal(out, ref_out);
+        break;
+    }
+    case Crypto1TestOpReaderNonce: {
+        uint64_t key = crypto1_test_random_key();
+        uint32_t cuid = crypto1_test_random();
+        uint8_t nt[4], nr[4], ref_nr[4];
+        bit_lib_num_to_bytes_be(value, sizeof(nt), nt);
+        bit_lib_num_to_bytes_be(crypto1_test_random(), sizeof(nr), nr);
+        memcpy(ref_nr, nr, sizeof(nr));
+        crypto1_encrypt_reader_nonce(crypto, key, cuid, nt, nr, out, is_encrypted);
+        ref_encrypt_reader_nonce(ref, key, cuid, nt, ref_nr, ref_out, is_encrypted);
+        same = (memcmp(nr, ref_nr, sizeof(nr)) == 0) && crypto1_test_buffers_equal(out, ref_out);
+        break;
+    }
+    default:
+        break;
+    }
+    return same && (crypto->odd == ref->odd) && (crypto->even == ref->even);
+}
+
+static size_t crypto1_test_differential(void) {
+    Crypto1* crypto = crypto1_alloc();
+    Crypto1 ref;
+    BitBuffer* in = bit_buffer_alloc(CRYPTO1_TEST_BUF_BYTES);
+    BitBuffer* out = bit_buffer_alloc(CRYPTO1_TEST_BUF_BYTES);
+    BitBuffer* ref_out = bit_buffer_alloc(CRYPTO1_TEST_BUF_BYTES);
+    size_t op_counts[Crypto1TestOpNum] = {0};
+
+    size_t failed = 0;
+    for(size_t i = 0; !failed && (i < CRYPTO1_TEST_STATES); i++) {
+        // Whole words, the registers carry the shifted out bits above bit 23 too
+        if(i % 2) {
+            crypto1_init(crypto, crypto1_test_random_key());
+        } else {
+            crypto->odd = crypto1_test_random();
+            crypto->even = crypto1_test_random();
+        }
+        ref = *crypto;
+
+        uint32_t filter_in = crypto1_test_random();
+        if(crypto1_filter(filter_in) != ref_filter(filter_in)) {
+            printf("FAIL differential: filter of %08" PRIX32 "\n", filter_in);
+            failed++;
+        }
+        for(size_t j = 0; !failed && (j < CRYPTO1_TEST_OPS); j++) {
+            Crypto1TestOp op = crypto1_test_random() % Crypto1TestOpNum;
+            Crypto1 before = ref;
+            if(crypto1_test_op(op, crypto, &ref, in, out, ref_out)) {
+                op_counts[op]++;
+            } else {
+                printf(
+                    "FAIL differential: %s from odd %08" PRIX32 " even %08" PRIX32
+                    ", state %08" PRIX32 " %08" PRIX32 ", expected %08" PRIX32 " %08" PRIX32
+                    "\n",
+                    crypto1_test_op_names[op],
+                    before.odd,
+                    before.even,
+                    crypto->odd,
+                    crypto->even,
+                    ref.odd,
+                    ref.even);
+                failed++;
+            }
+        }
+    }
+
+    if(!failed) {
+        printf("ok   differential: %d states,", CRYPTO1_TEST_STATES);
+        for(size_t op = 0; op < Crypto1TestOpNum; op++) {
+            printf(" %zu %s", op_counts[op], crypto1_test_op_names[op]);
+        }
+        printf("\n");
+    }
+    bit_buffer_free(ref_out);
+    bit_buffer_free(out);
+    bit_buffer_free(in);
+    crypto1_free(crypto);
+    return failed;
+}
+
+// Benchmark
+
+typedef void (*Crypto1TestFrameFn)(Crypto1* crypto, BitBuffer* in, BitBuffer* out);
+
+static void crypto1_test_table_decrypt(Crypto1* crypto, BitBuffer* in, BitBuffer* out) {
+    crypto1_decrypt(crypto, in, out);
+}
+
+static void crypto1_test_ref_decrypt(Crypto1* crypto, BitBuffer* in, BitBuffer* out) {
+    ref_decrypt(crypto, in, out);
+}
+
+static void crypto1_test_table_encrypt(Crypto1* crypto, BitBuffer* in, BitBuffer* out) {
+    crypto1_encrypt(crypto, NULL, in, out);
+}
+
+static void crypto1_test_ref_encrypt(Crypto1* crypto, BitBuffer* in, BitBuffer* out) {
+    ref_encrypt(crypto, NULL, in, out);
+}
+
+// MB/s of frames run through fn, the output is fed back in so nothing is left out
+static double crypto1_test_frames_mbps(Crypto1TestFrameFn fn) {
+    Crypto1* crypto = crypto1_alloc();
+    crypto1_init(crypto, 0xA0A1A2A3A4A5);
+    BitBuffer* in = bit_buffer_alloc(CRYPTO1_TEST_BUF_BYTES);
+    BitBuffer* out = bit_buffer_alloc(CRYPTO1_TEST_BUF_BYTES);
+    uint8_t frame[CRYPTO1_TEST_FRAME] = {0x30, 0x04};
+    bit_buffer_copy_bytes(in, frame, sizeof(frame));
+
+    uint64_t start = crypto1_test_ns();
+    for(size_t i = 0; i < CRYPTO1_TEST_FRAMES; i++) {
+        fn(crypto, in, out);
+        FURI_SWAP(in, out);
+    }
+    uint64_t elapsed = crypto1_test_ns() - start;
+
+    bit_buffer_free(out);
+    bit_buffer_free(in);
+    crypto1_free(crypto);
+    return (double)CRYPTO1_TEST_FRAMES * CRYPTO1_TEST_FRAME * 1000.0 / elapsed;
+}
+
+typedef void (*Crypto1TestNonceFn)(
+    Crypto1* crypto,
+    uint64_t key,
+    uint32_t cuid,
+    uint8_t* nt,
+    uint8_t* nr,
+    BitBuffer* out,
+    bool is_nested);
+
+static double crypto1_test_nonce_ns(Crypto1TestNonceFn fn, bool is_nested) {
+    Crypto1* crypto = crypto1_alloc();
+    BitBuffer* out = bit_buffer_alloc(CRYPTO1_TEST_BUF_BYTES);
+    uint8_t nt[4] = {0x01, 0x20, 0x01, 0x45};
+    uint8_t nr[4] = {0};
+
+    uint64_t start = crypto1_test_ns();
+    for(size_t i = 0; i < CRYPTO1_TEST_NONCES; i++) {
+        fn(crypto, 0xFFFFFFFFFFFF, 0xC0FFEE00 + i, nt, nr, out, is_nested);
+    }
+    uint64_t elapsed = crypto1_test_ns() - start;
+
+    bit_buffer_free(out);
+    crypto1_free(crypto);
+    return (double)elapsed / CRYPTO1_TEST_NONCES;
+}
+
+static void crypto1_test_bench(void) {
+    double decrypt = crypto1_test_frames_mbps(crypto1_test_table_decrypt);
+    double ref_decrypt_mbps = crypto1_test_frames_mbps(crypto1_test_ref_decrypt);
+    double encrypt = crypto1_test_frames_mbps(crypto1_test_table_encrypt);
+    double ref_encrypt_mbps = crypto1_test_frames_mbps(crypto1_test_ref_encrypt);
+    printf(
+        "     decrypt %d byte frames: %.1f MB/s, bit-serial %.1f MB/s\n",
+        CRYPTO1_TEST_FRAME,
+        decrypt,
+        ref_decrypt_mbps);
+    printf(
+        "     encrypt %d byte frames: %.1f MB/s, bit-serial %.1f MB/s\n",
+        CRYPTO1_TEST_FRAME,
+        encrypt,
+        ref_encrypt_mbps);
+    printf(
+        "     reader nonce: %.0f ns, bit-serial %.0f ns; nested %.0f ns, bit-serial %.0f ns\n",
+        crypto1_test_nonce_ns(crypto1_encrypt_reader_nonce, false),
+        crypto1_test_nonce_ns(ref_encrypt_reader_nonce, false),
+        crypto1_test_nonce_ns(crypto1_encrypt_reader_nonce, true),
+        crypto1_test_nonce_ns(ref_encrypt_reader_nonce, true));
+}
+
+int main(void) {
+    size_t failed = crypto1_test_differential();
+    if(!failed) crypto1_test_bench();
+
+    printf("\n%s, %zu failed\n", failed ? "FAIL" : "ok", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+#include "magic_sim.h"
+
+#include <string.h>
+
+MagicSimCard* magic_sim_card;
+MagicSimStats magic_sim_stats;
+MagicSimTiming magic_sim_timing = {
+    .frame_overhead_us = 300,
+    .byte_us = 85,
+    .write_us = 2500,
+    .callback_us = 500,
+};
+
+void magic_sim_reset_stats(void) {
+    memset(&magic_sim_stats, 0, sizeof(magic_sim_stats));
+}
+
+static uint16_t magic_sim_crc_a(const uint8_t* data, size_t size) {
+    uint32_t crc = 0x6363;
+    for(size_t i = 0; i < size; i++) {
+        uint8_t byte = data[i];
+        byte ^= (uint8_t)(crc & 0xFF);
+        byte ^= byte << 4;
+        crc = (crc >> 8) ^ ((uint32_t)byte << 8) ^ ((uint32_t)byte << 3) ^
+              ((uint32_t)byte >> 4);
+    }
+    return crc & 0xFFFF;
+}
+
+static void magic_sim_reply_ack(uint8_t* rx, size_t* rx_bits) {
+    rx[0] = 0x0A;
+    *rx_bits = 4;
+}
+
+static void magic_sim_reply(
+    const uint8_t* data,
+    size_t size,
+    bool append_crc,
+    uint8_t* rx,
+    size_t* rx_bits) {
+    memcpy(rx, data, size);
+    if(append_crc) {
+        uint16_t crc = magic_sim_crc_a(data, size);
+        rx[size++] = crc & 0xFF;
+        rx[size++] = crc >> 8;
+    }
+    *rx_bits = size * 8;
+}
+
+void magic_sim_card_field_on(MagicSimCard* card) {
+    card->woken = false;
+    card->unlocked = false;
+    card->pending_write = -1;
+}
+
+// Backdoor wakeup 40 (7 bits) and 43, then plain 30 reads and A0 writes
+static MagicSimResult magic_sim_gen1a_trx(
+    MagicSimCard* card,
+    const uint8_t* tx,
+    size_t bits,
+    uint8_t* rx,
+    size_t* rx_bits) {
+    if((bits == 7) && (tx[0] == 0x40)) {
+        card->woken = true;
+        magic_sim_reply_ack(rx, rx_bits);
+        return MagicSimResultOk;
+    }
+    if((bits == 8) && (tx[0] == 0x43)) {
+        if(!card->woken) return MagicSimResultTimeout;
+        card->unlocked = true;
+        magic_sim_reply_ack(rx, rx_bits);
+        return MagicSimResultOk;
+    }
+    if(!card->unlocked) return MagicSimResultTimeout;
+
+    if(card->pending_write >= 0) {
+        if(bits != 18 * 8) return MagicSimResultTimeout;
+        memcpy(card->mem[card->pending_write], tx, 16);
+        card->pending_write = -1;
+        magic_sim_reply_ack(rx, rx_bits);
+        return MagicSimResultWrite;
+    }
+    if((bits == 4 * 8) && (tx[0] == 0x30)) {
+        if(tx[1] >= card->blocks) return MagicSimResultTimeout;
+        magic_sim_reply(card->mem[tx[1]], 16, true, rx, rx_bits);
+        return MagicSimResultOk;
+    }
+    if((bits == 4 * 8) && (tx[0] == 0xA0)) {
+        if(tx[1] >= card->blocks) return MagicSimResultTimeout;
+        card->pending_write = tx[1];
+        magic_sim_reply_ack(rx, rx_bits);
+        return MagicSimResultOk;
+    }
+    return MagicSimResultTimeout;
+}
+
+// CF <password> <command> <arguments>
+static MagicSimResult magic_sim_gen4_trx(
+    MagicSimCard* card,
+    const uint8_t* tx,
+    size_t bits,
+    uint8_t* rx,
+    size_t* rx_bits) {
+    static const uint8_t ok[] = {0x90, 0x00};
+    static const uint8_t revision[] = {0x00, 0x00, 0x00, 0x06, 0xA0};
+
+    size_t size = bits / 8;
+    if((size < 6) || (tx[0] != 0xCF)) return MagicSimResultTimeout;
+    if(memcmp(&tx[1], card->password, sizeof(card->password)) != 0) return MagicSimResultTimeout;
+
+    const uint8_t* args = &tx[6];
+    size_t args_size = size - 6;
+    switch(tx[5]) {
+    case 0xC6: // Get config
+        magic_sim_reply(card->config, sizeof(card->config), false, rx, rx_bits);
+        return MagicSimResultOk;
+    case 0xCC: // Get revision
+        magic_sim_reply(revision, sizeof(revision), false, rx, rx_bits);
+        return MagicSimResultOk;
+    case 0xCE: // Read block
+        if((args_size != 1) || (args[0] >= card->blocks)) return MagicSimResultTimeout;
+        magic_sim_reply(card->mem[args[0]], 16, false, rx, rx_bits);
+        return MagicSimResultOk;
+    case 0xCD: // Write block
+        if((args_size != 17) || (args[0] >= card->blocks)) return MagicSimResultTimeout;
+        memcpy(card->mem[args[0]], &args[1], 16);
+        magic_sim_reply(ok, sizeof(ok), false, rx, rx_bits);
+        return MagicSimResultWrite;
+    case 0xF0: // Set config
+    case 0xF1:
+        if(args_size > sizeof(card->config)) args_size = sizeof(card->config);
+        memcpy(card->config, args, args_size);
+        magic_sim_reply(ok, sizeof(ok), false, rx, rx_bits);
+        return MagicSimResultWrite;
+    case 0xFE: // Set password
+        if(args_size != sizeof(card->password)) return MagicSimResultTimeout;
+        memcpy(card->password, args, sizeof(card->password));
+        magic_sim_reply(ok, sizeof(ok), false, rx, rx_bits);
+        return MagicSimResultWrite;
+    case 0x32: // Set shadow mode
+    case 0xCF: // Set direct write block 0 mode
+        magic_sim_reply(ok, sizeof(ok), false, rx, rx_bits);
+        return MagicSimResultWrite;
+    default:
+        return MagicSimResultTimeout;
+    }
+}
+
+MagicSimResult magic_sim_card_trx(
+    MagicSimCard* card,
+    const uint8_t* tx,
+    size_t tx_bits,
+    uint8_t* rx,
+    size_t* rx_bits) {
+    *rx_bits = 0;
+    card->frame_count++;
+    if(card->drop_every && (card->frame_count % card->drop_every == 0)) {
+        return MagicSimResultTimeout;
+    }
+
+    MagicSimResult result;
+    if(card->type == MagicSimCardGen1a) {
+        result = magic_sim_gen1a_trx(card, tx, tx_bits, rx, rx_bits);
+    } else if(card->type == MagicSimCardGen4) {
+        result = magic_sim_gen4_trx(card, tx, tx_bits, rx, rx_bits);
+    } else {
+        result = MagicSimResultTimeout;
+    }
+
+    if(card->drop_reply_every && (card->frame_count % card->drop_reply_every == 0)) {
+        *rx_bits = 0;
+        if(result == MagicSimResultWrite) card->lost_write = true;
+        result = MagicSimResultTimeout;
+    }
+    return result;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+// Gen1a and Gen4 card model behind the Nfc and Iso14443-3a stubs, with a time model
+// for every exchange and optional frame loss
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define MAGIC_SIM_BLOCKS_MAX 256
+
+typedef enum {
+    MagicSimResultOk,
+    MagicSimResultWrite, // Answer sent after programming a block
+    MagicSimResultTimeout,
+} MagicSimResult;
+
+typedef enum {
+    MagicSimCardGen1a,
+    MagicSimCardGen4,
+    MagicSimCardClassic, // Genuine card, answers no magic command
+} MagicSimCardType;
+
+typedef struct {
+    MagicSimCardType type;
+    uint8_t mem[MAGIC_SIM_BLOCKS_MAX][16];
+    uint16_t blocks;
+    uint8_t uid[7];
+    uint8_t uid_len;
+    uint8_t atqa[2];
+    uint8_t sak;
+
+    // Gen1a backdoor
+    bool woken;
+    bool unlocked;
+    int pending_write; // Block of the write waiting for its data, -1 if none
+
+    // Gen4
+    uint8_t password[4];
+    uint8_t config[32];
+
+    // Frame loss, 0 disables. A dropped command never reaches the card, a dropped
+    // answer is lost after the card ran the command.
+    uint32_t drop_every;
+    uint32_t drop_reply_every;
+    uint32_t frame_count;
+    bool lost_write; // Last timeout hid a programmed block
+} MagicSimCard;
+
+typedef struct {
+    uint64_t frames; // Reader frames sent
+    uint64_t bytes; // Bytes on air, both directions
+    uint64_t callbacks; // Poller callbacks
+    uint64_t time_us; // Modelled time
+    uint64_t writes; // Card memory writes
+    uint64_t activations; // Field on and card activations
+} MagicSimStats;
+
+typedef struct {
+    uint32_t frame_overhead_us; // Per exchange, reader side and frame delay
+    uint32_t byte_us; // Per byte on air, 106 kbps with parity
+    uint32_t write_us; // Card programming time of one block
+    uint32_t callback_us; // NFC event loop turnaround per poller callback
+    uint32_t field_on_us; // Field on and guard time before a poller starts
+} MagicSimTiming;
+
+// Card in the field, NULL if none
+extern MagicSimCard* magic_sim_card;
+extern MagicSimStats magic_sim_stats;
+extern MagicSimTiming magic_sim_timing;
+
+void magic_sim_reset_stats(void);
+
+void magic_sim_card_field_on(MagicSimCard* card);
+
+MagicSimResult magic_sim_card_trx(
+    MagicSimCard* card,
+    const uint8_t* tx,
+    size_t tx_bits,
+    uint8_t* rx,
+    size_t* rx_bits);
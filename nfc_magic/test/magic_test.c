@@ -0,0 +1,381 @@
+// Runs the Gen1a and Gen4 pollers against the card model of magic_sim.c, checks the card ends
+// up holding the dump and prints the frames, writes and modelled time of every run
+
+#include <furi.h>
+#include <inttypes.h>
+
+#include "magic/protocols/gen1a/gen1a_poller.h"
+#include "magic/protocols/gen4/gen4_poller.h"
+#include "magic_sim.h"
+
+#define MAGIC_TEST_NTAG215_PAGES 135
+
+typedef enum {
+    MagicTestCardSame,
+    MagicTestCardOneBlock,
+    MagicTestCardOneSector,
+    MagicTestCardWiped,
+    MagicTestCardRandom,
+
+    MagicTestCardNum,
+} MagicTestCardState;
+
+typedef struct {
+    int mode;
+    NfcProtocol protocol;
+    const void* data;
+    bool done;
+    bool success;
+} MagicTestContext;
+
+static const char* magic_test_card_state_names[MagicTestCardNum] = {
+    "same dump",
+    "one block edited",
+    "one sector edited",
+    "wiped card",
+    "random content",
+};
+
+static uint32_t magic_test_rng;
+
+static uint8_t magic_test_random(void) {
+    magic_test_rng = magic_test_rng * 1103515245 + 12345;
+    return magic_test_rng >> 16;
+}
+
+static NfcCommand magic_test_gen1a_callback(Gen1aPollerEvent event, void* context) {
+    MagicTestContext* ctx = context;
+    NfcCommand command = NfcCommandContinue;
+
+    if(event.type == Gen1aPollerEventTypeRequestMode) {
+        event.data->request_mode.mode = ctx->mode;
+    } else if(event.type == Gen1aPollerEventTypeRequestDataToWrite) {
+        event.data->data_to_write.mfc_data = ctx->data;
+    } else if(
+        (event.type == Gen1aPollerEventTypeSuccess) || (event.type == Gen1aPollerEventTypeFail)) {
+        ctx->done = true;
+        ctx->success = (event.type == Gen1aPollerEventTypeSuccess);
+        command = NfcCommandStop;
+    }
+
+    return command;
+}
+
+static NfcCommand magic_test_gen4_callback(Gen4PollerEvent event, void* context) {
+    MagicTestContext* ctx = context;
+    NfcCommand command = NfcCommandContinue;
+
+    if(event.type == Gen4PollerEventTypeRequestMode) {
+        event.data->request_mode.mode = ctx->mode;
+    } else if(event.type == Gen4PollerEventTypeRequestDataToWrite) {
+        event.data->request_data.protocol = ctx->protocol;
+        event.data->request_data.data = ctx->data;
+    } else if(
+        (event.type == Gen4PollerEventTypeSuccess) || (event.type == Gen4PollerEventTypeFail)) {
+        ctx->done = true;
+        ctx->success = (event.type == Gen4PollerEventTypeSuccess);
+        command = NfcCommandStop;
+    }
+
+    return command;
+}
+
+static bool magic_test_run_gen1a(Nfc* nfc, MagicTestContext* ctx) {
+    Gen1aPoller* poller = gen1a_poller_alloc(nfc);
+    gen1a_poller_start(poller, magic_test_gen1a_callback, ctx);
+    gen1a_poller_stop(poller);
+    gen1a_poller_free(poller);
+    return ctx->done && ctx->success;
+}
+
+static bool magic_test_run_gen4(Nfc* nfc, MagicTestContext* ctx) {
+    Gen4Poller* poller = gen4_poller_alloc(nfc);
+    gen4_poller_start(poller, magic_test_gen4_callback, ctx);
+    gen4_poller_stop(poller);
+    gen4_poller_free(poller);
+    return ctx->done && ctx->success;
+}
+
+static void magic_test_default_trailer(uint8_t* trailer) {
+    memset(trailer, 0xFF, MF_CLASSIC_BLOCK_SIZE);
+    trailer[6] = 0xFF;
+    trailer[7] = 0x07;
+    trailer[8] = 0x80;
+    trailer[9] = 0x69;
+}
+
+// Transit card like dump, custom keys on the first sectors and data in some of their blocks
+static void magic_test_make_dump(MfClassicData* dump) {
+    dump->type = MfClassicType1k;
+    dump->iso14443_3a_data->uid_len = 4;
+    dump->iso14443_3a_data->sak = 0x08;
+    dump->iso14443_3a_data->atqa[0] = 0x04;
+
+    magic_test_rng = 12345;
+    for(size_t i = 0; i < MF_CLASSIC_BLOCK_SIZE; i++) {
+        dump->block[0].data[i] = magic_test_random();
+    }
+    dump->block[0].data[5] = 0x08;
+    for(size_t sector = 0; sector < 16; sector++) {
+        uint8_t* trailer = dump->block[sector * 4 + 3].data;
+        magic_test_default_trailer(trailer);
+        if(sector >= 6) continue;
+
+        for(size_t i = 0; i < MF_CLASSIC_KEY_SIZE; i++) {
+            trailer[i] = magic_test_random();
+            trailer[10 + i] = magic_test_random();
+        }
+        for(size_t block = sector * 4; block < sector * 4 + 3; block++) {
+            if((block == 0) || !(magic_test_random() & 1)) continue;
+            for(size_t i = 0; i < MF_CLASSIC_BLOCK_SIZE; i++) {
+                dump->block[block].data[i] = magic_test_random();
+            }
+        }
+    }
+}
+
+static void magic_test_prepare_card(
+    MagicSimCard* card,
+    MagicSimCardType type,
+    const MfClassicData* dump,
+    MagicTestCardState state) {
+    memset(card, 0, sizeof(MagicSimCard));
+    card->type = type;
+    card->blocks = (type == MagicSimCardGen1a) ? 64 : MAGIC_SIM_BLOCKS_MAX;
+
+    if(state == MagicTestCardWiped) {
+        static const uint8_t block0[MF_CLASSIC_BLOCK_SIZE] = {0x01, 0x02, 0x03, 0x04, 0x04, 0x08};
+        memcpy(card->mem[0], block0, sizeof(block0));
+        for(size_t sector = 0; sector < 16; sector++) {
+            magic_test_default_trailer(card->mem[sector * 4 + 3]);
+        }
+        return;
+    }
+
+    for(size_t block = 0; block < 64; block++) {
+        memcpy(card->mem[block], dump->block[block].data, MF_CLASSIC_BLOCK_SIZE);
+    }
+    magic_test_rng = 777;
+    if(state == MagicTestCardOneBlock) {
+        card->mem[9][3] ^= 0x55;
+    } else if(state == MagicTestCardOneSector) {
+        for(size_t block = 20; block < 24; block++) {
+            card->mem[block][block & 7] ^= 0xA5;
+        }
+    } else if(state == MagicTestCardRandom) {
+        for(size_t block = 0; block < 64; block++) {
+            for(size_t i = 0; i < MF_CLASSIC_BLOCK_SIZE; i++) {
+                card->mem[block][i] = magic_test_random();
+            }
+        }
+    }
+}
+
+static bool magic_test_card_has_dump(const MagicSimCard* card, const MfClassicData* dump) {
+    uint16_t blocks = mf_classic_get_total_block_num(dump->type);
+    for(size_t block = 0; block < blocks; block++) {
+        if(memcmp(card->mem[block], dump->block[block].data, MF_CLASSIC_BLOCK_SIZE) != 0) {
+            printf("    block %zu differs\n", block);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Full and diff write of a 1k dump over cards that already hold something
+static size_t magic_test_write_1k(Nfc* nfc, const MfClassicData* dump) {
+    static const char* gen_names[] = {"Gen1a", "Gen4"};
+    static const MagicSimCardType card_types[] = {MagicSimCardGen1a, MagicSimCardGen4};
+    // Gen4 sets its config before every write
+    static const uint64_t config_writes[] = {0, 1};
+    static MagicSimCard card;
+    size_t failed = 0;
+
+    magic_sim_card = &card;
+    for(size_t gen = 0; gen < COUNT_OF(card_types); gen++) {
+        printf(
+            "\n%s 1k write          | full: frames writes    ms | diff: frames writes    ms\n",
+            gen_names[gen]);
+        for(size_t state = 0; state < MagicTestCardNum; state++) {
+            MagicSimStats stats[2];
+            bool passed = true;
+            for(size_t diff = 0; diff < 2; diff++) {
+                magic_test_prepare_card(&card, card_types[gen], dump, state);
+                magic_sim_reset_stats();
+                MagicTestContext ctx = {.protocol = NfcProtocolMfClassic, .data = dump};
+                bool success;
+                if(card_types[gen] == MagicSimCardGen1a) {
+                    ctx.mode = diff ? Gen1aPollerModeWriteDiff : Gen1aPollerModeWrite;
+                    success = magic_test_run_gen1a(nfc, &ctx);
+                } else {
+                    ctx.mode = diff ? Gen4PollerModeWriteDiff : Gen4PollerModeWrite;
+                    success = magic_test_run_gen4(nfc, &ctx);
+                }
+                passed &= success && magic_test_card_has_dump(&card, dump);
+                stats[diff] = magic_sim_stats;
+            }
+            // Nothing but the config to write on a card that already holds the dump
+            if((state == MagicTestCardSame) && (stats[1].writes != config_writes[gen])) {
+                passed = false;
+            }
+
+            printf(
+                "%s %-18s |       %4" PRIu64 "   %4" PRIu64 " %5" PRIu64
+                " |       %4" PRIu64 "   %4" PRIu64 " %5" PRIu64 "\n",
+                passed ? "ok  " : "FAIL",
+                magic_test_card_state_names[state],
+                stats[0].frames,
+                stats[0].writes,
+                stats[0].time_us / 1000,
+                stats[1].frames,
+                stats[1].writes,
+                stats[1].time_us / 1000);
+            if(!passed) failed++;
+        }
+    }
+
+    return failed;
+}
+
+// Gen4 wipe and 4k write with a slow event loop and with lost commands and answers
+static size_t magic_test_gen4_faults(Nfc* nfc) {
+    static const uint32_t callback_us[] = {500, 2000, 5000};
+    static const char* fault_names[] = {"clean", "1/50 cmd lost", "1/50 ack lost"};
+    static MagicSimCard card;
+    size_t failed = 0;
+
+    MfClassicData* dump = mf_classic_alloc();
+    dump->type = MfClassicType4k;
+    dump->iso14443_3a_data->uid_len = 4;
+    dump->iso14443_3a_data->sak = 0x18;
+    for(size_t block = 0; block < MF_CLASSIC_TOTAL_BLOCKS_MAX; block++) {
+        for(size_t i = 0; i < MF_CLASSIC_BLOCK_SIZE; i++) {
+            dump->block[block].data[i] = block * 31 + i;
+        }
+    }
+
+    uint32_t callback_us_saved = magic_sim_timing.callback_us;
+    magic_sim_card = &card;
+    printf("\nGen4 wipe and 4k write\n");
+    for(size_t write = 0; write < 2; write++) {
+        for(size_t fault = 0; fault < COUNT_OF(fault_names); fault++) {
+            for(size_t i = 0; i < COUNT_OF(callback_us); i++) {
+                // Latency only matters on a clean link, the faults run at the default one
+                if(fault && i) continue;
+
+                memset(&card, 0, sizeof(card));
+                card.type = MagicSimCardGen4;
+                card.blocks = MAGIC_SIM_BLOCKS_MAX;
+                if(fault == 1) card.drop_every = 50;
+                if(fault == 2) card.drop_reply_every = 50;
+                magic_sim_timing.callback_us = callback_us[i];
+                magic_sim_reset_stats();
+
+                MagicTestContext ctx = {
+                    .mode = write ? Gen4PollerModeWrite : Gen4PollerModeWipe,
+                    .protocol = NfcProtocolMfClassic,
+                    .data = dump,
+                };
+                bool passed = magic_test_run_gen4(nfc, &ctx);
+                if(passed && write) passed = magic_test_card_has_dump(&card, dump);
+
+                printf(
+                    "%s %-8s cb %4" PRIu32 " us %-13s: frames %4" PRIu64 " callbacks %4" PRIu64
+                    " %5" PRIu64 " ms\n",
+                    passed ? "ok  " : "FAIL",
+                    write ? "write 4k" : "wipe",
+                    callback_us[i],
+                    fault_names[fault],
+                    magic_sim_stats.frames,
+                    magic_sim_stats.callbacks,
+                    magic_sim_stats.time_us / 1000);
+                if(!passed) failed++;
+            }
+        }
+    }
+    magic_sim_timing.callback_us = callback_us_saved;
+
+    mf_classic_free(dump);
+    return failed;
+}
+
+// Gen4 in Ultralight mode, one page per block
+static size_t magic_test_gen4_ultralight(Nfc* nfc) {
+    static const char* pass_names[] = {"full", "diff (same)", "diff (one page edited)"};
+    static MfUltralightData dump;
+    static Iso14443_3aData iso14443_3a_data = {.uid_len = 7, .atqa = {0x44, 0x00}};
+    static MagicSimCard card;
+    size_t failed = 0;
+
+    dump.iso14443_3a_data = &iso14443_3a_data;
+    dump.type = MfUltralightTypeNTAG215;
+    dump.pages_read = MAGIC_TEST_NTAG215_PAGES;
+    dump.pages_total = MAGIC_TEST_NTAG215_PAGES;
+    for(size_t page = 0; page < 40; page++) {
+        for(size_t i = 0; i < MF_ULTRALIGHT_PAGE_SIZE; i++) {
+            dump.page[page].data[i] = page * 7 + i;
+        }
+    }
+
+    memset(&card, 0, sizeof(card));
+    card.type = MagicSimCardGen4;
+    card.blocks = MAGIC_SIM_BLOCKS_MAX;
+    magic_sim_card = &card;
+    printf("\nGen4 NTAG215 write\n");
+    uint64_t full_writes = 0;
+    for(size_t pass = 0; pass < COUNT_OF(pass_names); pass++) {
+        if(pass == 2) card.mem[50][0] ^= 1;
+        magic_sim_reset_stats();
+
+        MagicTestContext ctx = {
+            .mode = pass ? Gen4PollerModeWriteDiff : Gen4PollerModeWrite,
+            .protocol = NfcProtocolMfUltralight,
+            .data = &dump,
+        };
+        bool passed = magic_test_run_gen4(nfc, &ctx);
+        for(size_t page = 0; passed && (page < MAGIC_TEST_NTAG215_PAGES); page++) {
+            passed = (memcmp(card.mem[page], dump.page[page].data, MF_ULTRALIGHT_PAGE_SIZE) == 0);
+        }
+        if(pass == 0) {
+            full_writes = magic_sim_stats.writes;
+        } else if(magic_sim_stats.writes >= full_writes) {
+            passed = false;
+        }
+
+        printf(
+            "%s %-22s: frames %4" PRIu64 " writes %4" PRIu64 " %5" PRIu64 " ms\n",
+            passed ? "ok  " : "FAIL",
+            pass_names[pass],
+            magic_sim_stats.frames,
+            magic_sim_stats.writes,
+            magic_sim_stats.time_us / 1000);
+        if(!passed) failed++;
+    }
+
+    return failed;
+}
+
+int main(void) {
+    printf(
+        "Timing model: %" PRIu32 " us/frame, %" PRIu32 " us/byte, %" PRIu32
+        " us/block write, %" PRIu32 " us/callback\n",
+        magic_sim_timing.frame_overhead_us,
+        magic_sim_timing.byte_us,
+        magic_sim_timing.write_us,
+        magic_sim_timing.callback_us);
+
+    Nfc* nfc = nfc_alloc();
+    MfClassicData* dump = mf_classic_alloc();
+    magic_test_make_dump(dump);
+
+    size_t failed = 0;
+    failed += magic_test_write_1k(nfc, dump);
+    failed += magic_test_gen4_faults(nfc);
+    failed += magic_test_gen4_ultralight(nfc);
+
+    mf_classic_free(dump);
+    nfc_free(nfc);
+
+    printf("\n%s, %zu failed\n", failed ? "FAIL" : "ok", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+// Runs the magic card scanner against the card model of magic_sim.c and prints the field
+// activations and modelled time it takes to detect each card, on a first scan and when the
+// same card is scanned again. The pollers column is the most pollers allocated at once.
+
+#include <furi.h>
+#include <inttypes.h>
+
+#include "magic/nfc_magic_scanner.c"
+#include "magic_sim.h"
+
+// Field on and guard time before every poller, every probe pays it
+#define SCANNER_TEST_FIELD_ON_US 5000
+#define SCANNER_TEST_EMPTY_ROUNDS 10
+
+typedef struct {
+    const char* name;
+    MagicSimCardType type;
+    uint8_t sak;
+    NfcMagicProtocol protocol;
+    // Fingerprint plus every probe up to the one that detects the card
+    uint32_t first_activations;
+    uint32_t rescan_activations;
+} ScannerTestCase;
+
+typedef struct {
+    NfcMagicScanner* scanner;
+    bool detected;
+    NfcMagicProtocol protocol;
+    size_t max_pollers;
+    // Empty field, the scan is stopped as the round after the last counted one starts
+    uint32_t rounds;
+    uint32_t round_limit;
+    MagicSimStats rounds_stats;
+} ScannerTestContext;
+
+static const ScannerTestCase scanner_test_cases[] = {
+    {"Gen1a", MagicSimCardGen1a, 0x08, NfcMagicProtocolGen1, 2, 2},
+    {"Gen4 Classic SAK", MagicSimCardGen4, 0x08, NfcMagicProtocolGen4, 4, 2},
+    // Gen2 and Classic are left out with an Ultralight SAK
+    {"Gen4 Ultralight SAK", MagicSimCardGen4, 0x00, NfcMagicProtocolGen4, 2, 2},
+    {"Genuine Classic", MagicSimCardClassic, 0x08, NfcMagicProtocolClassic, 5, 2},
+};
+
+// The Gen2 poller needs the whole MfClassic poller stack, so its detect is modelled on the
+// air instead: the card is activated and asked for its ATS like gen2_poller_detect() does.
+// None of the modelled cards answers it.
+static NfcCommand scanner_test_gen2_callback(NfcGenericEvent event, void* context) {
+    Gen2PollerError* error = context;
+    Iso14443_3aPollerEvent* iso3_event = event.event_data;
+
+    *error = Gen2PollerErrorTimeout;
+    if(iso3_event->type == Iso14443_3aPollerEventTypeReady) {
+        BitBuffer* tx_buffer = bit_buffer_alloc(2);
+        BitBuffer* rx_buffer = bit_buffer_alloc(32);
+        bit_buffer_append_byte(tx_buffer, 0xE0);
+        bit_buffer_append_byte(tx_buffer, 0x80);
+        Iso14443_3aError iso3_error =
+            iso14443_3a_poller_send_standard_frame(event.instance, tx_buffer, rx_buffer, 0);
+        *error = (iso3_error == Iso14443_3aErrorNone) ? Gen2PollerErrorNone :
+                                                        Gen2PollerErrorProtocol;
+        bit_buffer_free(rx_buffer);
+        bit_buffer_free(tx_buffer);
+    }
+
+    return NfcCommandStop;
+}
+
+Gen2PollerError gen2_poller_detect(Nfc* nfc) {
+    Gen2PollerError error = Gen2PollerErrorNone;
+    NfcPoller* poller = nfc_poller_alloc(nfc, NfcProtocolIso14443_3a);
+    nfc_poller_start(poller, scanner_test_gen2_callback, &error);
+    nfc_poller_stop(poller);
+    nfc_poller_free(poller);
+
+    return error;
+}
+
+static void scanner_test_callback(NfcMagicScannerEvent event, void* context) {
+    ScannerTestContext* ctx = context;
+    ctx->detected = (event.type == NfcMagicScannerEventTypeDetected);
+    ctx->protocol = event.data.protocol;
+}
+
+static void scanner_test_poller_callback(NfcPoller* poller, void* context) {
+    ScannerTestContext* ctx = context;
+    ctx->max_pollers = MAX(ctx->max_pollers, sdk_stub_get_poller_count());
+
+    if(ctx->round_limit && (poller == ctx->scanner->iso3_poller)) {
+        if(ctx->rounds++ == ctx->round_limit) {
+            ctx->rounds_stats = magic_sim_stats;
+            ctx->scanner->session_state = NfcMagicScannerSessionStateStopRequest;
+        }
+    }
+}
+
+// One scan from start to stop, false if pollers are left behind
+static bool scanner_test_scan(NfcMagicScanner* scanner, ScannerTestContext* ctx) {
+    magic_sim_reset_stats();
+    ctx->scanner = scanner;
+    sdk_stub_set_poller_callback(scanner_test_poller_callback, ctx);
+
+    nfc_magic_scanner_start(scanner, scanner_test_callback, ctx);
+    furi_thread_join(scanner->scan_worker);
+    nfc_magic_scanner_stop(scanner);
+
+    sdk_stub_set_poller_callback(NULL, NULL);
+    return sdk_stub_get_poller_count() == 0;
+}
+
+static void scanner_test_prepare_card(MagicSimCard* card, const ScannerTestCase* test_case) {
+    memset(card, 0, sizeof(MagicSimCard));
+    card->type = test_case->type;
+    card->blocks = 64;
+    card->uid_len = 4;
+    memcpy(card->uid, (uint8_t[]){0xDE, 0xAD, 0xBE, 0xEF}, card->uid_len);
+    card->atqa[0] = (test_case->sak == 0x00) ? 0x44 : 0x04;
+    card->sak = test_case->sak;
+}
+
+static size_t scanner_test_cards(Nfc* nfc) {
+    static const char* scan_names[] = {"first scan", "rescan"};
+    static MagicSimCard card;
+    size_t failed = 0;
+
+    printf("\nDetect                           activations frames     ms pollers\n");
+    for(size_t i = 0; i < COUNT_OF(scanner_test_cases); i++) {
+        const ScannerTestCase* test_case = &scanner_test_cases[i];
+        scanner_test_prepare_card(&card, test_case);
+        magic_sim_card = &card;
+
+        // The pollers only exist while a scan runs
+        NfcMagicScanner* scanner = nfc_magic_scanner_alloc(nfc);
+        for(size_t scan = 0; scan < COUNT_OF(scan_names); scan++) {
+            ScannerTestContext ctx = {};
+            bool passed = (sdk_stub_get_poller_count() == 0);
+            passed &= scanner_test_scan(scanner, &ctx);
+            uint32_t expected = scan ? test_case->rescan_activations :
+                                       test_case->first_activations;
+            passed &= ctx.detected && (ctx.protocol == test_case->protocol) &&
+                      (magic_sim_stats.activations == expected);
+            printf(
+                "%s %-19s %-10s: %11" PRIu64 " %6" PRIu64 " %6.1f %7zu\n",
+                passed ? "ok  " : "FAIL",
+                test_case->name,
+                scan_names[scan],
+                magic_sim_stats.activations,
+                magic_sim_stats.frames,
+                magic_sim_stats.time_us / 1000.0,
+                ctx.max_pollers);
+            if(!passed) failed++;
+        }
+        nfc_magic_scanner_free(scanner);
+    }
+
+    return failed;
+}
+
+// Every round of an empty field activates once for the fingerprint and once for each
+// technology that isn't Iso14443-3a
+static size_t scanner_test_empty_field(Nfc* nfc) {
+    magic_sim_card = NULL;
+    NfcMagicScanner* scanner = nfc_magic_scanner_alloc(nfc);
+    ScannerTestContext ctx = {.round_limit = SCANNER_TEST_EMPTY_ROUNDS};
+    bool passed = scanner_test_scan(scanner, &ctx);
+    nfc_magic_scanner_free(scanner);
+
+    uint64_t activations = ctx.rounds_stats.activations / SCANNER_TEST_EMPTY_ROUNDS;
+    passed &= !ctx.detected && (ctx.rounds == SCANNER_TEST_EMPTY_ROUNDS + 1) &&
+              (activations == 1 + COUNT_OF(nfc_magic_scanner_not_magic_protocols));
+    printf(
+        "%s empty field, per round        : %11" PRIu64 " %6" PRIu64 " %6.1f %7zu\n",
+        passed ? "ok  " : "FAIL",
+        activations,
+        ctx.rounds_stats.frames / SCANNER_TEST_EMPTY_ROUNDS,
+        ctx.rounds_stats.time_us / 1000.0 / SCANNER_TEST_EMPTY_ROUNDS,
+        ctx.max_pollers);
+
+    return passed ? 0 : 1;
+}
+
+int main(void) {
+    magic_sim_timing.field_on_us = SCANNER_TEST_FIELD_ON_US;
+    printf(
+        "Timing model: %" PRIu32 " us/field on, %" PRIu32 " us/frame, %" PRIu32
+        " us/byte, %" PRIu32 " us/callback\n",
+        magic_sim_timing.field_on_us,
+        magic_sim_timing.frame_overhead_us,
+        magic_sim_timing.byte_us,
+        magic_sim_timing.callback_us);
+
+    Nfc* nfc = nfc_alloc();
+    size_t failed = 0;
+    failed += scanner_test_cards(nfc);
+    failed += scanner_test_empty_field(nfc);
+    nfc_free(nfc);
+
+    printf("\n%s, %zu failed\n", failed ? "FAIL" : "ok", failed);
+    return failed ? 1 : 0;
+}
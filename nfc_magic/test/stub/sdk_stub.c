@@ -0,0 +1,781 @@
+#include <sdk_stub.h>
+
+#include "../magic_sim.h"
+
+// A reader frame the card doesn't answer costs the whole frame wait time
+#define SDK_STUB_FWT_US 5000
+// Pollers that never stop are cut off after this many callbacks
+#define SDK_STUB_CALLBACK_LIMIT 100000
+
+// Core, time is the modelled time of the exchanges so far
+
+FuriThreadId furi_thread_get_current_id(void) {
+    return NULL;
+}
+
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    UNUSED(options);
+    UNUSED(timeout);
+    return flags;
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags) {
+    UNUSED(thread_id);
+    return flags;
+}
+
+uint32_t furi_thread_flags_clear(uint32_t flags) {
+    return flags;
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    magic_sim_stats.time_us += milliseconds * 1000ULL;
+}
+
+void furi_delay_us(uint32_t microseconds) {
+    magic_sim_stats.time_us += microseconds;
+}
+
+uint32_t furi_get_tick(void) {
+    return magic_sim_stats.time_us / 1000;
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+struct FuriThread {
+    FuriThreadCallback callback;
+    void* context;
+    bool started;
+};
+
+FuriThread* furi_thread_alloc(void) {
+    return malloc(sizeof(FuriThread));
+}
+
+void furi_thread_free(FuriThread* thread) {
+    free(thread);
+}
+
+void furi_thread_set_name(FuriThread* thread, const char* name) {
+    UNUSED(thread);
+    UNUSED(name);
+}
+
+void furi_thread_set_context(FuriThread* thread, void* context) {
+    thread->context = context;
+}
+
+void furi_thread_set_stack_size(FuriThread* thread, size_t stack_size) {
+    UNUSED(thread);
+    UNUSED(stack_size);
+}
+
+void furi_thread_set_callback(FuriThread* thread, FuriThreadCallback callback) {
+    thread->callback = callback;
+}
+
+void furi_thread_start(FuriThread* thread) {
+    thread->started = true;
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    if(thread->started) {
+        thread->started = false;
+        thread->callback(thread->context);
+    }
+    return true;
+}
+
+// BitBuffer, parity bit of byte i is bit 7 - i % 8 of parity[i / 8] like the firmware
+
+struct BitBuffer {
+    uint8_t* data;
+    uint8_t* parity;
+    size_t capacity;
+    size_t bits;
+};
+
+BitBuffer* bit_buffer_alloc(size_t capacity_bytes) {
+    BitBuffer* buf = malloc(sizeof(BitBuffer));
+    buf->data = malloc(capacity_bytes);
+    buf->parity = malloc((capacity_bytes + 7) / 8 + 1);
+    buf->capacity = capacity_bytes;
+    return buf;
+}
+
+void bit_buffer_free(BitBuffer* buf) {
+    free(buf->data);
+    free(buf->parity);
+    free(buf);
+}
+
+void bit_buffer_reset(BitBuffer* buf) {
+    memset(buf->data, 0, buf->capacity);
+    memset(buf->parity, 0, (buf->capacity + 7) / 8 + 1);
+    buf->bits = 0;
+}
+
+void bit_buffer_copy(BitBuffer* buf, const BitBuffer* other) {
+    furi_check(other->bits <= buf->capacity * 8);
+    memcpy(buf->data, other->data, (other->bits + 7) / 8);
+    memcpy(buf->parity, other->parity, (other->bits / 8 + 7) / 8);
+    buf->bits = other->bits;
+}
+
+void bit_buffer_copy_bytes(BitBuffer* buf, const uint8_t* data, size_t size_bytes) {
+    furi_check(size_bytes <= buf->capacity);
+    memcpy(buf->data, data, size_bytes);
+    buf->bits = size_bytes * 8;
+}
+
+void bit_buffer_copy_bits(BitBuffer* buf, const uint8_t* data, size_t size_bits) {
+    furi_check((size_bits + 7) / 8 <= buf->capacity);
+    memcpy(buf->data, data, (size_bits + 7) / 8);
+    buf->bits = size_bits;
+}
+
+static void bit_buffer_set_parity(BitBuffer* buf, size_t index, bool parity) {
+    if(parity) {
+        buf->parity[index / 8] |= 1 << (7 - index % 8);
+    } else {
+        buf->parity[index / 8] &= ~(1 << (7 - index % 8));
+    }
+}
+
+// Nine bits per byte on air, the parity bit follows the data bits
+void bit_buffer_copy_bytes_with_parity(BitBuffer* buf, const uint8_t* data, size_t size_bits) {
+    size_t size_bytes = size_bits / 9;
+    size_t bit = 0;
+    for(size_t i = 0; i < size_bytes; i++) {
+        uint8_t byte = 0;
+        for(size_t j = 0; j < 8; j++, bit++) {
+            byte |= ((data[bit / 8] >> (bit % 8)) & 1) << j;
+        }
+        bit_buffer_set_parity(buf, i, (data[bit / 8] >> (bit % 8)) & 1);
+        bit++;
+        buf->data[i] = byte;
+    }
+    buf->bits = size_bytes * 8;
+}
+
+void bit_buffer_write_bytes(const BitBuffer* buf, void* dest, size_t size_bytes) {
+    memcpy(dest, buf->data, MIN(size_bytes, (buf->bits + 7) / 8));
+}
+
+void bit_buffer_write_bytes_with_parity(
+    const BitBuffer* buf,
+    void* dest,
+    size_t size_bytes,
+    size_t* bits_written) {
+    uint8_t* out = dest;
+    size_t bit = 0;
+    memset(out, 0, size_bytes);
+    for(size_t i = 0; i < buf->bits / 8; i++) {
+        for(size_t j = 0; j < 8; j++, bit++) {
+            if((buf->data[i] >> j) & 1) out[bit / 8] |= 1 << (bit % 8);
+        }
+        if((buf->parity[i / 8] >> (7 - i % 8)) & 1) out[bit / 8] |= 1 << (bit % 8);
+        bit++;
+    }
+    *bits_written = bit;
+}
+
+size_t bit_buffer_get_size(const BitBuffer* buf) {
+    return buf->bits;
+}
+
+size_t bit_buffer_get_size_bytes(const BitBuffer* buf) {
+    return (buf->bits + 7) / 8;
+}
+
+size_t bit_buffer_get_capacity_bytes(const BitBuffer* buf) {
+    return buf->capacity;
+}
+
+uint8_t bit_buffer_get_byte(const BitBuffer* buf, size_t index) {
+    furi_check(index < buf->capacity);
+    return buf->data[index];
+}
+
+uint8_t bit_buffer_get_byte_from_bit(const BitBuffer* buf, size_t index_bits) {
+    size_t index = index_bits / 8;
+    size_t shift = index_bits % 8;
+    if(shift == 0) return buf->data[index];
+
+    uint8_t low = buf->data[index] >> shift;
+    uint8_t high = (index + 1 < buf->capacity) ? (uint8_t)(buf->data[index + 1] << (8 - shift)) :
+                                                 0;
+    return low | high;
+}
+
+const uint8_t* bit_buffer_get_data(const BitBuffer* buf) {
+    return buf->data;
+}
+
+const uint8_t* bit_buffer_get_parity(const BitBuffer* buf) {
+    return buf->parity;
+}
+
+void bit_buffer_set_byte(BitBuffer* buf, size_t index, uint8_t byte) {
+    furi_check(index < buf->capacity);
+    buf->data[index] = byte;
+}
+
+void bit_buffer_set_byte_with_parity(BitBuffer* buf, size_t index, uint8_t byte, bool parity) {
+    furi_check(index < buf->capacity);
+    buf->data[index] = byte;
+    bit_buffer_set_parity(buf, index, parity);
+}
+
+void bit_buffer_set_size(BitBuffer* buf, size_t new_size) {
+    furi_check(new_size <= buf->capacity * 8);
+    buf->bits = new_size;
+}
+
+void bit_buffer_set_size_bytes(BitBuffer* buf, size_t new_size_bytes) {
+    furi_check(new_size_bytes <= buf->capacity);
+    buf->bits = new_size_bytes * 8;
+}
+
+void bit_buffer_append_byte(BitBuffer* buf, uint8_t byte) {
+    furi_check(buf->bits % 8 == 0);
+    furi_check(buf->bits / 8 < buf->capacity);
+    buf->data[buf->bits / 8] = byte;
+    buf->bits += 8;
+}
+
+void bit_buffer_append_bytes(BitBuffer* buf, const uint8_t* data, size_t size_bytes) {
+    for(size_t i = 0; i < size_bytes; i++) {
+        bit_buffer_append_byte(buf, data[i]);
+    }
+}
+
+void bit_buffer_append(BitBuffer* buf, const BitBuffer* other) {
+    bit_buffer_append_bytes(buf, other->data, bit_buffer_get_size_bytes(other));
+}
+
+void bit_buffer_append_bit(BitBuffer* buf, bool bit) {
+    furi_check(buf->bits < buf->capacity * 8);
+    if(bit) {
+        buf->data[buf->bits / 8] |= 1 << (buf->bits % 8);
+    } else {
+        buf->data[buf->bits / 8] &= ~(1 << (buf->bits % 8));
+    }
+    buf->bits++;
+}
+
+bool bit_buffer_starts_with_byte(const BitBuffer* buf, uint8_t byte) {
+    return (buf->bits >= 8) && (buf->data[0] == byte);
+}
+
+bool bit_buffer_has_partial_byte(const BitBuffer* buf) {
+    return buf->bits % 8 != 0;
+}
+
+// bit_lib
+
+void bit_lib_set_bit(uint8_t* data, size_t position, bool bit) {
+    if(bit) {
+        data[position / 8] |= 1 << (7 - position % 8);
+    } else {
+        data[position / 8] &= ~(1 << (7 - position % 8));
+    }
+}
+
+bool bit_lib_get_bit(const uint8_t* data, size_t position) {
+    return (data[position / 8] >> (7 - position % 8)) & 1;
+}
+
+uint64_t bit_lib_bytes_to_num_be(const uint8_t* src, uint8_t len) {
+    uint64_t value = 0;
+    for(uint8_t i = 0; i < len; i++) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+void bit_lib_num_to_bytes_be(uint64_t src, uint8_t len, uint8_t* dest) {
+    for(int i = len - 1; i >= 0; i--) {
+        dest[i] = src & 0xFF;
+        src >>= 8;
+    }
+}
+
+uint64_t bit_lib_bytes_to_num_le(const uint8_t* src, uint8_t len) {
+    uint64_t value = 0;
+    for(int i = len - 1; i >= 0; i--) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+void bit_lib_num_to_bytes_le(uint64_t src, uint8_t len, uint8_t* dest) {
+    for(uint8_t i = 0; i < len; i++) {
+        dest[i] = src & 0xFF;
+        src >>= 8;
+    }
+}
+
+// nfc_util
+
+uint8_t nfc_util_even_parity32(uint32_t data) {
+    return __builtin_parity(data);
+}
+
+uint8_t nfc_util_odd_parity8(uint8_t data) {
+    return !__builtin_parity(data);
+}
+
+// Iso14443 CRC
+
+static uint16_t iso14443_crc_a(const uint8_t* data, size_t size) {
+    uint32_t crc = 0x6363;
+    for(size_t i = 0; i < size; i++) {
+        uint8_t byte = data[i];
+        byte ^= (uint8_t)(crc & 0xFF);
+        byte ^= byte << 4;
+        crc = (crc >> 8) ^ ((uint32_t)byte << 8) ^ ((uint32_t)byte << 3) ^
+              ((uint32_t)byte >> 4);
+    }
+    return crc & 0xFFFF;
+}
+
+void iso14443_crc_append(Iso14443CrcType type, BitBuffer* buf) {
+    UNUSED(type);
+    uint16_t crc = iso14443_crc_a(buf->data, buf->bits / 8);
+    bit_buffer_append_byte(buf, crc & 0xFF);
+    bit_buffer_append_byte(buf, crc >> 8);
+}
+
+bool iso14443_crc_check(Iso14443CrcType type, const BitBuffer* buf) {
+    UNUSED(type);
+    size_t size = buf->bits / 8;
+    if(size < 3) return false;
+    uint16_t crc = iso14443_crc_a(buf->data, size - 2);
+    return (buf->data[size - 2] == (crc & 0xFF)) && (buf->data[size - 1] == (crc >> 8));
+}
+
+void iso14443_crc_trim(BitBuffer* buf) {
+    buf->bits -= 16;
+}
+
+// Nfc and the pollers, every exchange goes to magic_sim_card
+
+struct Nfc {
+    bool running;
+};
+
+struct Iso14443_3aPoller {
+    Nfc* nfc;
+};
+
+struct NfcPoller {
+    Nfc* nfc;
+    NfcProtocol protocol;
+    Iso14443_3aData data;
+    Iso14443_3aPoller iso3;
+};
+
+Nfc* nfc_alloc(void) {
+    return malloc(sizeof(Nfc));
+}
+
+void nfc_free(Nfc* instance) {
+    free(instance);
+}
+
+void nfc_config(Nfc* instance, NfcMode mode, NfcTech tech) {
+    UNUSED(instance);
+    UNUSED(mode);
+    UNUSED(tech);
+}
+
+void nfc_set_guard_time_us(Nfc* instance, uint32_t guard_time_us) {
+    UNUSED(instance);
+    UNUSED(guard_time_us);
+}
+
+void nfc_set_fdt_poll_fc(Nfc* instance, uint32_t fdt_poll_fc) {
+    UNUSED(instance);
+    UNUSED(fdt_poll_fc);
+}
+
+void nfc_set_fdt_poll_poll_us(Nfc* instance, uint32_t fdt_poll_poll_us) {
+    UNUSED(instance);
+    UNUSED(fdt_poll_poll_us);
+}
+
+static void sdk_stub_field_on(void) {
+    if(magic_sim_timing.field_on_us) {
+        magic_sim_stats.activations++;
+        magic_sim_stats.time_us += magic_sim_timing.field_on_us;
+    }
+    if(magic_sim_card) magic_sim_card_field_on(magic_sim_card);
+}
+
+// REQA, anticollision and select, false when no card answers
+static bool sdk_stub_activate(NfcPoller* instance) {
+    sdk_stub_field_on();
+    if(!magic_sim_card) {
+        magic_sim_stats.frames++;
+        magic_sim_stats.time_us +=
+            magic_sim_timing.frame_overhead_us + magic_sim_timing.byte_us + SDK_STUB_FWT_US;
+        return false;
+    }
+
+    magic_sim_stats.frames += 3;
+    magic_sim_stats.time_us +=
+        3 * magic_sim_timing.frame_overhead_us + 22 * magic_sim_timing.byte_us;
+    memcpy(instance->data.uid, magic_sim_card->uid, magic_sim_card->uid_len);
+    instance->data.uid_len = magic_sim_card->uid_len;
+    memcpy(instance->data.atqa, magic_sim_card->atqa, sizeof(instance->data.atqa));
+    instance->data.sak = magic_sim_card->sak;
+    return true;
+}
+
+void nfc_start(Nfc* instance, NfcEventCallback callback, void* context) {
+    instance->running = true;
+    sdk_stub_field_on();
+    NfcEvent event = {.type = NfcEventTypePollerReady};
+    for(size_t i = 0; instance->running && (i < SDK_STUB_CALLBACK_LIMIT); i++) {
+        magic_sim_stats.callbacks++;
+        magic_sim_stats.time_us += magic_sim_timing.callback_us;
+        if(callback(event, context) == NfcCommandStop) break;
+    }
+    instance->running = false;
+}
+
+void nfc_stop(Nfc* instance) {
+    instance->running = false;
+}
+
+static NfcError sdk_stub_exchange(const BitBuffer* tx_buffer, BitBuffer* rx_buffer) {
+    magic_sim_stats.frames++;
+    if(!magic_sim_card) {
+        magic_sim_stats.time_us += magic_sim_timing.frame_overhead_us + SDK_STUB_FWT_US;
+        return NfcErrorTimeout;
+    }
+
+    uint8_t rx[64] = {};
+    size_t rx_bits = 0;
+    MagicSimResult result =
+        magic_sim_card_trx(magic_sim_card, tx_buffer->data, tx_buffer->bits, rx, &rx_bits);
+    size_t bytes = (tx_buffer->bits + 7) / 8 + (rx_bits + 7) / 8;
+    magic_sim_stats.bytes += bytes;
+    magic_sim_stats.time_us +=
+        magic_sim_timing.frame_overhead_us + magic_sim_timing.byte_us * bytes;
+
+    // A write whose answer was lost still took the programming time
+    if((result == MagicSimResultWrite) || magic_sim_card->lost_write) {
+        magic_sim_stats.writes++;
+        magic_sim_stats.time_us += magic_sim_timing.write_us;
+        magic_sim_card->lost_write = false;
+    }
+    if(result == MagicSimResultTimeout) {
+        magic_sim_stats.time_us += SDK_STUB_FWT_US;
+        return NfcErrorTimeout;
+    }
+
+    bit_buffer_copy_bits(rx_buffer, rx, MIN(rx_bits, rx_buffer->capacity * 8));
+    return NfcErrorNone;
+}
+
+NfcError
+    nfc_poller_trx(Nfc* instance, const BitBuffer* tx_buffer, BitBuffer* rx_buffer, uint32_t fwt) {
+    UNUSED(instance);
+    UNUSED(fwt);
+    return sdk_stub_exchange(tx_buffer, rx_buffer);
+}
+
+static SdkStubPollerCallback sdk_stub_poller_callback;
+static void* sdk_stub_poller_context;
+static size_t sdk_stub_poller_count;
+
+void sdk_stub_set_poller_callback(SdkStubPollerCallback callback, void* context) {
+    sdk_stub_poller_callback = callback;
+    sdk_stub_poller_context = context;
+}
+
+size_t sdk_stub_get_poller_count(void) {
+    return sdk_stub_poller_count;
+}
+
+NfcPoller* nfc_poller_alloc(Nfc* nfc, NfcProtocol protocol) {
+    NfcPoller* instance = malloc(sizeof(NfcPoller));
+    instance->nfc = nfc;
+    instance->protocol = protocol;
+    instance->iso3.nfc = nfc;
+    sdk_stub_poller_count++;
+    return instance;
+}
+
+void nfc_poller_free(NfcPoller* instance) {
+    furi_check(instance);
+    sdk_stub_poller_count--;
+    free(instance);
+}
+
+void nfc_poller_start(NfcPoller* instance, NfcGenericCallback callback, void* context) {
+    if(sdk_stub_poller_callback) sdk_stub_poller_callback(instance, sdk_stub_poller_context);
+    instance->nfc->running = true;
+    bool present = sdk_stub_activate(instance);
+    Iso14443_3aPollerEvent iso3_event = {
+        .type = present ? Iso14443_3aPollerEventTypeReady : Iso14443_3aPollerEventTypeError,
+    };
+    NfcGenericEvent event = {
+        .protocol = NfcProtocolIso14443_3a,
+        .instance = &instance->iso3,
+        .event_data = &iso3_event,
+    };
+    for(size_t i = 0; instance->nfc->running && (i < SDK_STUB_CALLBACK_LIMIT); i++) {
+        magic_sim_stats.callbacks++;
+        magic_sim_stats.time_us += magic_sim_timing.callback_us;
+        if(callback(event, context) == NfcCommandStop) break;
+    }
+    instance->nfc->running = false;
+}
+
+void nfc_poller_stop(NfcPoller* instance) {
+    instance->nfc->running = false;
+}
+
+const NfcDeviceData* nfc_poller_get_data(const NfcPoller* instance) {
+    return &instance->data;
+}
+
+// Only Iso14443-3a cards are modelled
+bool nfc_poller_detect(NfcPoller* instance) {
+    if(sdk_stub_poller_callback) sdk_stub_poller_callback(instance, sdk_stub_poller_context);
+    if((instance->protocol == NfcProtocolIso14443_3a) ||
+       (instance->protocol == NfcProtocolMfClassic)) {
+        if(!sdk_stub_activate(instance)) return false;
+        return (instance->protocol == NfcProtocolIso14443_3a) || (magic_sim_card->sak & 0x08);
+    }
+
+    sdk_stub_field_on();
+    magic_sim_stats.frames++;
+    magic_sim_stats.time_us +=
+        magic_sim_timing.frame_overhead_us + 3 * magic_sim_timing.byte_us + SDK_STUB_FWT_US;
+    return false;
+}
+
+Iso14443_3aData* iso14443_3a_alloc(void) {
+    return malloc(sizeof(Iso14443_3aData));
+}
+
+void iso14443_3a_free(Iso14443_3aData* data) {
+    free(data);
+}
+
+void iso14443_3a_copy(Iso14443_3aData* data, const Iso14443_3aData* other) {
+    *data = *other;
+}
+
+bool iso14443_3a_is_equal(const Iso14443_3aData* data, const Iso14443_3aData* other) {
+    return (data->uid_len == other->uid_len) &&
+           (memcmp(data->uid, other->uid, data->uid_len) == 0) &&
+           (memcmp(data->atqa, other->atqa, sizeof(data->atqa)) == 0) &&
+           (data->sak == other->sak);
+}
+
+Iso14443_3aError iso14443_3a_poller_send_standard_frame(
+    Iso14443_3aPoller* instance,
+    const BitBuffer* tx_buffer,
+    BitBuffer* rx_buffer,
+    uint32_t fwt) {
+    UNUSED(instance);
+    UNUSED(fwt);
+    // The CRC is added and checked by the transport, only its time on air is counted
+    magic_sim_stats.time_us += 4 * magic_sim_timing.byte_us;
+    NfcError error = sdk_stub_exchange(tx_buffer, rx_buffer);
+    return (error == NfcErrorNone) ? Iso14443_3aErrorNone : Iso14443_3aErrorTimeout;
+}
+
+Iso14443_3aError iso14443_3a_poller_txrx(
+    Iso14443_3aPoller* instance,
+    const BitBuffer* tx_buffer,
+    BitBuffer* rx_buffer,
+    uint32_t fwt) {
+    UNUSED(instance);
+    UNUSED(fwt);
+    NfcError error = sdk_stub_exchange(tx_buffer, rx_buffer);
+    return (error == NfcErrorNone) ? Iso14443_3aErrorNone : Iso14443_3aErrorTimeout;
+}
+
+Iso14443_3aError iso14443_3a_poller_halt(Iso14443_3aPoller* instance) {
+    UNUSED(instance);
+    if(magic_sim_card) magic_sim_card_field_on(magic_sim_card);
+    return Iso14443_3aErrorNone;
+}
+
+// MfClassic
+
+uint16_t mf_classic_get_total_block_num(MfClassicType type) {
+    if(type == MfClassicTypeMini) return 20;
+    return (type == MfClassicType1k) ? 64 : 256;
+}
+
+uint8_t mf_classic_get_total_sectors_num(MfClassicType type) {
+    if(type == MfClassicTypeMini) return 5;
+    return (type == MfClassicType1k) ? 16 : 40;
+}
+
+uint8_t mf_classic_get_sector_by_block(uint8_t block) {
+    return (block < 128) ? (block / 4) : (32 + (block - 128) / 16);
+}
+
+uint8_t mf_classic_get_first_block_num_of_sector(uint8_t sector) {
+    return (sector < 32) ? (sector * 4) : (128 + (sector - 32) * 16);
+}
+
+uint8_t mf_classic_get_sector_trailer_num_by_sector(uint8_t sector) {
+    return (sector < 32) ? (sector * 4 + 3) : (128 + (sector - 32) * 16 + 15);
+}
+
+bool mf_classic_is_sector_trailer(uint8_t block) {
+    uint8_t sector = mf_classic_get_sector_by_block(block);
+    return block == mf_classic_get_sector_trailer_num_by_sector(sector);
+}
+
+MfClassicSectorTrailer*
+    mf_classic_get_sector_trailer_by_sector(const MfClassicData* data, uint8_t sector) {
+    uint8_t block = mf_classic_get_sector_trailer_num_by_sector(sector);
+    return (MfClassicSectorTrailer*)&data->block[block];
+}
+
+void mf_classic_set_block_read(MfClassicData* data, uint8_t block_num, MfClassicBlock* block) {
+    data->block[block_num] = *block;
+    data->block_read_mask[block_num / 32] |= 1U << (block_num % 32);
+}
+
+bool mf_classic_is_block_read(const MfClassicData* data, uint8_t block_num) {
+    return data->block_read_mask[block_num / 32] & (1U << (block_num % 32));
+}
+
+// Both keys of the sector count as found, the trailer data is already in the block
+void mf_classic_set_sector_trailer_read(
+    MfClassicData* data,
+    uint8_t block_num,
+    MfClassicSectorTrailer* sec_tr) {
+    UNUSED(sec_tr);
+    uint8_t sector = mf_classic_get_sector_by_block(block_num);
+    data->key_a_mask |= 1ULL << sector;
+    data->key_b_mask |= 1ULL << sector;
+}
+
+bool mf_classic_is_key_found(
+    const MfClassicData* data,
+    uint8_t sector_num,
+    MfClassicKeyType key_type) {
+    uint64_t mask = (key_type == MfClassicKeyTypeA) ? data->key_a_mask : data->key_b_mask;
+    return (mask >> sector_num) & 1;
+}
+
+MfClassicData* mf_classic_alloc(void) {
+    MfClassicData* data = malloc(sizeof(MfClassicData));
+    data->iso14443_3a_data = iso14443_3a_alloc();
+    return data;
+}
+
+void mf_classic_free(MfClassicData* data) {
+    iso14443_3a_free(data->iso14443_3a_data);
+    free(data);
+}
+
+void mf_classic_copy(MfClassicData* data, const MfClassicData* other) {
+    Iso14443_3aData* iso14443_3a_data = data->iso14443_3a_data;
+    *iso14443_3a_data = *other->iso14443_3a_data;
+    *data = *other;
+    data->iso14443_3a_data = iso14443_3a_data;
+}
+
+void mf_classic_reset(MfClassicData* data) {
+    Iso14443_3aData* iso14443_3a_data = data->iso14443_3a_data;
+    memset(iso14443_3a_data, 0, sizeof(Iso14443_3aData));
+    memset(data, 0, sizeof(MfClassicData));
+    data->iso14443_3a_data = iso14443_3a_data;
+}
+
+// MfUltralight
+
+uint32_t mf_ultralight_get_feature_support_set(MfUltralightType type) {
+    switch(type) {
+    case MfUltralightTypeNTAG213:
+    case MfUltralightTypeNTAG215:
+    case MfUltralightTypeNTAG216:
+    case MfUltralightTypeUL11:
+    case MfUltralightTypeUL21:
+        return MfUltralightFeatureSupportReadVersion | MfUltralightFeatureSupportReadSignature |
+               MfUltralightFeatureSupportPasswordAuth;
+    default:
+        return 0;
+    }
+}
+
+bool mf_ultralight_support_feature(uint32_t feature_set, uint32_t features_to_check) {
+    return (feature_set & features_to_check) != 0;
+}
+
+bool mf_ultralight_get_config_page(
+    const MfUltralightData* data,
+    MfUltralightConfigPages** config) {
+    if(data->pages_total < 8) return false;
+    *config = (MfUltralightConfigPages*)&data->page[data->pages_total - 4];
+    return true;
+}
+
+// NfcDevice
+
+struct NfcDevice {
+    NfcProtocol protocol;
+    const NfcDeviceData* data;
+    MfClassicData* generated;
+};
+
+NfcDevice* nfc_device_alloc(void) {
+    return malloc(sizeof(NfcDevice));
+}
+
+void nfc_device_free(NfcDevice* instance) {
+    if(instance->generated) mf_classic_free(instance->generated);
+    free(instance);
+}
+
+const NfcDeviceData* nfc_device_get_data(const NfcDevice* instance, NfcProtocol protocol) {
+    UNUSED(protocol);
+    return instance->data;
+}
+
+NfcProtocol nfc_device_get_protocol(const NfcDevice* instance) {
+    return instance->protocol;
+}
+
+void nfc_device_set_data(NfcDevice* instance, NfcProtocol protocol, const NfcDeviceData* data) {
+    instance->protocol = protocol;
+    instance->data = data;
+}
+
+// Blank 1k card with a 4-byte UID and transport keys
+void nfc_data_generator_fill_data(NfcDataGeneratorType type, NfcDevice* nfc_device) {
+    UNUSED(type);
+    if(!nfc_device->generated) nfc_device->generated = mf_classic_alloc();
+
+    MfClassicData* data = nfc_device->generated;
+    data->type = MfClassicType1k;
+    memset(data->block, 0, sizeof(data->block));
+    static const uint8_t block0[MF_CLASSIC_BLOCK_SIZE] = {
+        0x01, 0x02, 0x03, 0x04, 0x04, 0x08, 0x04};
+    memcpy(data->block[0].data, block0, sizeof(block0));
+    for(size_t sector = 0; sector < 16; sector++) {
+        uint8_t* trailer = data->block[sector * 4 + 3].data;
+        memset(trailer, 0xFF, MF_CLASSIC_BLOCK_SIZE);
+        trailer[6] = 0xFF;
+        trailer[7] = 0x07;
+        trailer[8] = 0x80;
+        trailer[9] = 0x69;
+    }
+    nfc_device->protocol = NfcProtocolMfClassic;
+    nfc_device->data = data;
+}
@@ -0,0 +1,442 @@
+#pragma once
+
+// Host stand-in for the parts of the Flipper SDK the Gen1a and Gen4 pollers use. Every
+// SDK header the pollers include is a one-line forward to this file.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Zeroed like the firmware allocator
+#define malloc(size) calloc(1, (size))
+
+#define furi_assert(x)  assert(x)
+#define furi_check(x)   assert(x)
+#define furi_crash(msg) (fprintf(stderr, "crash: %s\n", msg), abort())
+#define UNUSED(x)       (void)(x)
+#define FURI_PACKED     __attribute__((packed))
+#define COUNT_OF(x)     (sizeof(x) / sizeof((x)[0]))
+#define MAX(a, b)       ((a) > (b) ? (a) : (b))
+#define MIN(a, b)       ((a) < (b) ? (a) : (b))
+#define FURI_BIT(x, n)  (((x) >> (n)) & 1)
+#define FURI_SWAP(x, y)     \
+    do {                    \
+        typeof(x) SWAP = x; \
+        x = y;              \
+        y = SWAP;           \
+    } while(0)
+
+#define FURI_LOG_E(tag, ...) ((void)0)
+#define FURI_LOG_W(tag, ...) ((void)0)
+#define FURI_LOG_I(tag, ...) ((void)0)
+#define FURI_LOG_D(tag, ...) ((void)0)
+#define FURI_LOG_T(tag, ...) ((void)0)
+
+#define FuriWaitForever 0xFFFFFFFFU
+#define FuriFlagWaitAny 0
+
+typedef void* FuriThreadId;
+
+FuriThreadId furi_thread_get_current_id(void);
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout);
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags);
+uint32_t furi_thread_flags_clear(uint32_t flags);
+void furi_delay_ms(uint32_t milliseconds);
+void furi_delay_us(uint32_t microseconds);
+uint32_t furi_get_tick(void);
+uint32_t furi_kernel_get_tick_frequency(void);
+
+// Threads run on the caller when they are joined, so a test starts a worker, runs it to
+// the end with furi_thread_join() and only then stops it
+
+typedef struct FuriThread FuriThread;
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+FuriThread* furi_thread_alloc(void);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_set_name(FuriThread* thread, const char* name);
+void furi_thread_set_context(FuriThread* thread, void* context);
+void furi_thread_set_stack_size(FuriThread* thread, size_t stack_size);
+void furi_thread_set_callback(FuriThread* thread, FuriThreadCallback callback);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+
+// BitBuffer
+
+typedef struct BitBuffer BitBuffer;
+
+BitBuffer* bit_buffer_alloc(size_t capacity_bytes);
+void bit_buffer_free(BitBuffer* buf);
+void bit_buffer_reset(BitBuffer* buf);
+void bit_buffer_copy(BitBuffer* buf, const BitBuffer* other);
+void bit_buffer_copy_bytes(BitBuffer* buf, const uint8_t* data, size_t size_bytes);
+void bit_buffer_copy_bits(BitBuffer* buf, const uint8_t* data, size_t size_bits);
+void bit_buffer_copy_bytes_with_parity(BitBuffer* buf, const uint8_t* data, size_t size_bits);
+void bit_buffer_write_bytes(const BitBuffer* buf, void* dest, size_t size_bytes);
+void bit_buffer_write_bytes_with_parity(
+    const BitBuffer* buf,
+    void* dest,
+    size_t size_bytes,
+    size_t* bits_written);
+size_t bit_buffer_get_size(const BitBuffer* buf);
+size_t bit_buffer_get_size_bytes(const BitBuffer* buf);
+size_t bit_buffer_get_capacity_bytes(const BitBuffer* buf);
+uint8_t bit_buffer_get_byte(const BitBuffer* buf, size_t index);
+uint8_t bit_buffer_get_byte_from_bit(const BitBuffer* buf, size_t index_bits);
+const uint8_t* bit_buffer_get_data(const BitBuffer* buf);
+const uint8_t* bit_buffer_get_parity(const BitBuffer* buf);
+void bit_buffer_set_byte(BitBuffer* buf, size_t index, uint8_t byte);
+void bit_buffer_set_byte_with_parity(BitBuffer* buf, size_t index, uint8_t byte, bool parity);
+void bit_buffer_set_size(BitBuffer* buf, size_t new_size);
+void bit_buffer_set_size_bytes(BitBuffer* buf, size_t new_size_bytes);
+void bit_buffer_append(BitBuffer* buf, const BitBuffer* other);
+void bit_buffer_append_byte(BitBuffer* buf, uint8_t byte);
+void bit_buffer_append_bytes(BitBuffer* buf, const uint8_t* data, size_t size_bytes);
+void bit_buffer_append_bit(BitBuffer* buf, bool bit);
+bool bit_buffer_starts_with_byte(const BitBuffer* buf, uint8_t byte);
+bool bit_buffer_has_partial_byte(const BitBuffer* buf);
+
+// bit_lib, MSB first like the firmware
+
+void bit_lib_set_bit(uint8_t* data, size_t position, bool bit);
+bool bit_lib_get_bit(const uint8_t* data, size_t position);
+uint64_t bit_lib_bytes_to_num_be(const uint8_t* src, uint8_t len);
+void bit_lib_num_to_bytes_be(uint64_t src, uint8_t len, uint8_t* dest);
+uint64_t bit_lib_bytes_to_num_le(const uint8_t* src, uint8_t len);
+void bit_lib_num_to_bytes_le(uint64_t src, uint8_t len, uint8_t* dest);
+
+// nfc_util
+
+uint8_t nfc_util_even_parity32(uint32_t data);
+uint8_t nfc_util_odd_parity8(uint8_t data);
+
+// Nfc
+
+typedef enum {
+    NfcErrorNone,
+    NfcErrorInternal,
+    NfcErrorTimeout,
+    NfcErrorIncompleteFrame,
+    NfcErrorDataFormat,
+} NfcError;
+
+typedef enum {
+    NfcCommandContinue,
+    NfcCommandReset,
+    NfcCommandStop,
+    NfcCommandSleep,
+} NfcCommand;
+
+typedef enum {
+    NfcModePoller,
+    NfcModeListener,
+} NfcMode;
+
+typedef enum {
+    NfcTechIso14443a,
+    NfcTechIso14443b,
+    NfcTechIso15693,
+} NfcTech;
+
+typedef enum {
+    NfcEventTypeUserAbort,
+    NfcEventTypeFieldOn,
+    NfcEventTypeFieldOff,
+    NfcEventTypeTxStart,
+    NfcEventTypeTxEnd,
+    NfcEventTypeRxStart,
+    NfcEventTypeRxEnd,
+    NfcEventTypeListenerActivated,
+    NfcEventTypePollerReady,
+} NfcEventType;
+
+typedef struct {
+    BitBuffer* buffer;
+} NfcEventData;
+
+typedef struct {
+    NfcEventType type;
+    NfcEventData data;
+} NfcEvent;
+
+typedef struct Nfc Nfc;
+typedef NfcCommand (*NfcEventCallback)(NfcEvent event, void* context);
+
+Nfc* nfc_alloc(void);
+void nfc_free(Nfc* instance);
+void nfc_config(Nfc* instance, NfcMode mode, NfcTech tech);
+void nfc_set_guard_time_us(Nfc* instance, uint32_t guard_time_us);
+void nfc_set_fdt_poll_fc(Nfc* instance, uint32_t fdt_poll_fc);
+void nfc_set_fdt_poll_poll_us(Nfc* instance, uint32_t fdt_poll_poll_us);
+void nfc_start(Nfc* instance, NfcEventCallback callback, void* context);
+void nfc_stop(Nfc* instance);
+NfcError
+    nfc_poller_trx(Nfc* instance, const BitBuffer* tx_buffer, BitBuffer* rx_buffer, uint32_t fwt);
+
+typedef enum {
+    NfcProtocolIso14443_3a,
+    NfcProtocolIso14443_3b,
+    NfcProtocolIso15693_3,
+    NfcProtocolFelica,
+    NfcProtocolMfUltralight,
+    NfcProtocolMfClassic,
+    NfcProtocolNum,
+    NfcProtocolInvalid,
+} NfcProtocol;
+
+typedef void NfcDeviceData;
+
+typedef struct {
+    NfcProtocol protocol;
+    void* instance;
+    void* event_data;
+} NfcGenericEvent;
+
+typedef NfcCommand (*NfcGenericCallback)(NfcGenericEvent event, void* context);
+
+typedef struct NfcPoller NfcPoller;
+
+NfcPoller* nfc_poller_alloc(Nfc* nfc, NfcProtocol protocol);
+void nfc_poller_free(NfcPoller* instance);
+void nfc_poller_start(NfcPoller* instance, NfcGenericCallback callback, void* context);
+void nfc_poller_stop(NfcPoller* instance);
+const NfcDeviceData* nfc_poller_get_data(const NfcPoller* instance);
+bool nfc_poller_detect(NfcPoller* instance);
+
+// Test controls, called before every nfc_poller_start() and nfc_poller_detect()
+typedef void (*SdkStubPollerCallback)(NfcPoller* poller, void* context);
+
+void sdk_stub_set_poller_callback(SdkStubPollerCallback callback, void* context);
+// Pollers allocated and not yet freed
+size_t sdk_stub_get_poller_count(void);
+
+// Iso14443-3a
+
+#define ISO14443_3A_GUARD_TIME_US    (5000)
+#define ISO14443_3A_FDT_POLL_FC      (1620)
+#define ISO14443_3A_FDT_LISTEN_FC    (1172)
+#define ISO14443_3A_POLL_POLL_MIN_US (1100)
+#define ISO14443_3A_MAX_UID_SIZE     (10)
+
+typedef enum {
+    Iso14443_3aErrorNone,
+    Iso14443_3aErrorNotPresent,
+    Iso14443_3aErrorColResFailed,
+    Iso14443_3aErrorBufferOverflow,
+    Iso14443_3aErrorCommunication,
+    Iso14443_3aErrorFieldOff,
+    Iso14443_3aErrorWrongCrc,
+    Iso14443_3aErrorTimeout,
+} Iso14443_3aError;
+
+typedef struct {
+    uint8_t uid[ISO14443_3A_MAX_UID_SIZE];
+    uint8_t uid_len;
+    uint8_t atqa[2];
+    uint8_t sak;
+} Iso14443_3aData;
+
+typedef enum {
+    Iso14443_3aPollerEventTypeError,
+    Iso14443_3aPollerEventTypeReady,
+} Iso14443_3aPollerEventType;
+
+typedef struct {
+    Iso14443_3aPollerEventType type;
+    void* data;
+} Iso14443_3aPollerEvent;
+
+typedef struct Iso14443_3aPoller Iso14443_3aPoller;
+
+Iso14443_3aError iso14443_3a_poller_send_standard_frame(
+    Iso14443_3aPoller* instance,
+    const BitBuffer* tx_buffer,
+    BitBuffer* rx_buffer,
+    uint32_t fwt);
+Iso14443_3aError iso14443_3a_poller_txrx(
+    Iso14443_3aPoller* instance,
+    const BitBuffer* tx_buffer,
+    BitBuffer* rx_buffer,
+    uint32_t fwt);
+Iso14443_3aError iso14443_3a_poller_halt(Iso14443_3aPoller* instance);
+Iso14443_3aData* iso14443_3a_alloc(void);
+void iso14443_3a_free(Iso14443_3aData* data);
+void iso14443_3a_copy(Iso14443_3aData* data, const Iso14443_3aData* other);
+bool iso14443_3a_is_equal(const Iso14443_3aData* data, const Iso14443_3aData* other);
+
+typedef enum {
+    Iso14443CrcTypeA,
+} Iso14443CrcType;
+
+void iso14443_crc_append(Iso14443CrcType type, BitBuffer* buf);
+bool iso14443_crc_check(Iso14443CrcType type, const BitBuffer* buf);
+void iso14443_crc_trim(BitBuffer* buf);
+
+// MfClassic
+
+#define MF_CLASSIC_BLOCK_SIZE        (16)
+#define MF_CLASSIC_TOTAL_SECTORS_MAX (40)
+#define MF_CLASSIC_TOTAL_BLOCKS_MAX  (256)
+#define MF_CLASSIC_KEY_SIZE          (6)
+#define MF_CLASSIC_ACCESS_BYTES_SIZE (4)
+
+typedef enum {
+    MfClassicTypeMini,
+    MfClassicType1k,
+    MfClassicType4k,
+    MfClassicTypeNum,
+} MfClassicType;
+
+typedef enum {
+    MfClassicKeyTypeA,
+    MfClassicKeyTypeB,
+} MfClassicKeyType;
+
+typedef struct {
+    uint8_t data[MF_CLASSIC_BLOCK_SIZE];
+} MfClassicBlock;
+
+typedef struct {
+    uint8_t data[MF_CLASSIC_KEY_SIZE];
+} MfClassicKey;
+
+typedef struct {
+    uint8_t data[MF_CLASSIC_ACCESS_BYTES_SIZE];
+} MfClassicAccessBits;
+
+typedef struct {
+    MfClassicKey key_a;
+    MfClassicAccessBits access_bits;
+    MfClassicKey key_b;
+} MfClassicSectorTrailer;
+
+typedef struct {
+    Iso14443_3aData* iso14443_3a_data;
+    MfClassicType type;
+    uint32_t block_read_mask[MF_CLASSIC_TOTAL_BLOCKS_MAX / 32];
+    uint64_t key_a_mask;
+    uint64_t key_b_mask;
+    MfClassicBlock block[MF_CLASSIC_TOTAL_BLOCKS_MAX];
+} MfClassicData;
+
+uint16_t mf_classic_get_total_block_num(MfClassicType type);
+uint8_t mf_classic_get_total_sectors_num(MfClassicType type);
+bool mf_classic_is_sector_trailer(uint8_t block);
+uint8_t mf_classic_get_sector_by_block(uint8_t block);
+uint8_t mf_classic_get_first_block_num_of_sector(uint8_t sector);
+uint8_t mf_classic_get_sector_trailer_num_by_sector(uint8_t sector);
+MfClassicSectorTrailer*
+    mf_classic_get_sector_trailer_by_sector(const MfClassicData* data, uint8_t sector);
+void mf_classic_set_block_read(MfClassicData* data, uint8_t block_num, MfClassicBlock* block);
+bool mf_classic_is_block_read(const MfClassicData* data, uint8_t block_num);
+void mf_classic_set_sector_trailer_read(
+    MfClassicData* data,
+    uint8_t block_num,
+    MfClassicSectorTrailer* sec_tr);
+bool mf_classic_is_key_found(
+    const MfClassicData* data,
+    uint8_t sector_num,
+    MfClassicKeyType key_type);
+MfClassicData* mf_classic_alloc(void);
+void mf_classic_free(MfClassicData* data);
+void mf_classic_copy(MfClassicData* data, const MfClassicData* other);
+void mf_classic_reset(MfClassicData* data);
+
+// MfUltralight
+
+#define MF_ULTRALIGHT_PAGE_SIZE      (4U)
+#define MF_ULTRALIGHT_MAX_PAGE_NUM   (510)
+#define MF_ULTRALIGHT_SIGNATURE_SIZE (32)
+
+typedef enum {
+    MfUltralightTypeOrigin,
+    MfUltralightTypeNTAG203,
+    MfUltralightTypeMfulC,
+    MfUltralightTypeUL11,
+    MfUltralightTypeUL21,
+    MfUltralightTypeNTAG213,
+    MfUltralightTypeNTAG215,
+    MfUltralightTypeNTAG216,
+    MfUltralightTypeNTAGI2C1K,
+    MfUltralightTypeNTAGI2C2K,
+    MfUltralightTypeNTAGI2CPlus1K,
+    MfUltralightTypeNTAGI2CPlus2K,
+    MfUltralightTypeNum,
+} MfUltralightType;
+
+typedef enum {
+    MfUltralightFeatureSupportReadVersion = (1U << 0),
+    MfUltralightFeatureSupportReadSignature = (1U << 1),
+    MfUltralightFeatureSupportPasswordAuth = (1U << 2),
+} MfUltralightFeatureSupport;
+
+typedef struct {
+    uint8_t data[MF_ULTRALIGHT_PAGE_SIZE];
+} MfUltralightPage;
+
+typedef struct {
+    uint8_t data[4];
+} MfUltralightAuthPassword;
+
+typedef struct {
+    uint8_t data[2];
+} MfUltralightAuthPack;
+
+typedef struct {
+    uint8_t header;
+    uint8_t vendor_id;
+    uint8_t prod_type;
+    uint8_t prod_subtype;
+    uint8_t prod_ver_major;
+    uint8_t prod_ver_minor;
+    uint8_t storage_size;
+    uint8_t protocol_type;
+} MfUltralightVersion;
+
+typedef struct {
+    uint8_t data[MF_ULTRALIGHT_SIGNATURE_SIZE];
+} MfUltralightSignature;
+
+typedef struct {
+    uint8_t mirror[4];
+    uint8_t access[4];
+    MfUltralightAuthPassword password;
+    MfUltralightAuthPack pack;
+    uint8_t rfu[2];
+} MfUltralightConfigPages;
+
+typedef struct {
+    Iso14443_3aData* iso14443_3a_data;
+    MfUltralightType type;
+    MfUltralightVersion version;
+    MfUltralightSignature signature;
+    uint16_t pages_read;
+    uint16_t pages_total;
+    MfUltralightPage page[MF_ULTRALIGHT_MAX_PAGE_NUM];
+} MfUltralightData;
+
+uint32_t mf_ultralight_get_feature_support_set(MfUltralightType type);
+bool mf_ultralight_support_feature(uint32_t feature_set, uint32_t features_to_check);
+bool mf_ultralight_get_config_page(
+    const MfUltralightData* data,
+    MfUltralightConfigPages** config);
+
+// NfcDevice, holds the data of one protocol
+
+typedef struct NfcDevice NfcDevice;
+
+NfcDevice* nfc_device_alloc(void);
+void nfc_device_free(NfcDevice* instance);
+const NfcDeviceData* nfc_device_get_data(const NfcDevice* instance, NfcProtocol protocol);
+NfcProtocol nfc_device_get_protocol(const NfcDevice* instance);
+void nfc_device_set_data(NfcDevice* instance, NfcProtocol protocol, const NfcDeviceData* data);
+
+typedef enum {
+    NfcDataGeneratorTypeMfClassic1k_4b,
+} NfcDataGeneratorType;
+
+void nfc_data_generator_fill_data(NfcDataGeneratorType type, NfcDevice* nfc_device);
@@ -28,7 +28,7 @@
  * 
  */
 
-static const SubGhzBlockConst ws_protocol_acurite_592txr_const = {
+const SubGhzBlockConst ws_protocol_acurite_592txr_const = {
     .te_short = 200,
     .te_long = 400,
     .te_delta = 90,
@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderAcurite_592TXR WSProtocolEncoderAcurite_592TXR;
 extern const SubGhzProtocolDecoder ws_protocol_acurite_592txr_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_acurite_592txr_encoder;
 extern const SubGhzProtocol ws_protocol_acurite_592txr;
+extern const SubGhzBlockConst ws_protocol_acurite_592txr_const;
 
 /**
  * Allocate WSProtocolDecoderAcurite_592TXR.
@@ -27,7 +27,7 @@
  * 
  */
 
-static const SubGhzBlockConst ws_protocol_acurite_5n1_const = {
+const SubGhzBlockConst ws_protocol_acurite_5n1_const = {
     .te_short = 200,
     .te_long = 400,
     .te_delta = 90,
@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderAcurite_5n1 WSProtocolEncoderAcurite_5n1;
 extern const SubGhzProtocolDecoder ws_protocol_acurite_5n1_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_acurite_5n1_encoder;
 extern const SubGhzProtocol ws_protocol_acurite_5n1;
+extern const SubGhzBlockConst ws_protocol_acurite_5n1_const;
 
 /**
  * Allocate WSProtocolDecoderAcurite_5n1.
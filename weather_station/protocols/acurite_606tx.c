@@ -16,7 +16,7 @@
  * 
  */
 
-static const SubGhzBlockConst ws_protocol_acurite_606tx_const = {
+const SubGhzBlockConst ws_protocol_acurite_606tx_const = {
     .te_short = 500,
     .te_long = 2000,
     .te_delta = 150,
@@ -17,7 +17,7 @@
  *
  */
 
-static const SubGhzBlockConst ws_protocol_acurite_609txc_const = {
+const SubGhzBlockConst ws_protocol_acurite_609txc_const = {
     .te_short = 500,
     .te_long = 1000,
     .te_delta = 150,
@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderAcurite_609TXC WSProtocolEncoderAcurite_609TXC;
 extern const SubGhzProtocolDecoder ws_protocol_acurite_609txc_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_acurite_609txc_encoder;
 extern const SubGhzProtocol ws_protocol_acurite_609txc;
+extern const SubGhzBlockConst ws_protocol_acurite_609txc_const;
 
 /**
  * Allocate WSProtocolDecoderAcurite_609TXC.
@@ -20,7 +20,7 @@
  *  identification changes on battery switch
  */
 
-static const SubGhzBlockConst ws_protocol_acurite_986_const = {
+const SubGhzBlockConst ws_protocol_acurite_986_const = {
     .te_short = 800,
     .te_long = 1750,
     .te_delta = 50,
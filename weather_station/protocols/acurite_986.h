@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderAcurite_986 WSProtocolEncoderAcurite_986;
 extern const SubGhzProtocolDecoder ws_protocol_acurite_986_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_acurite_986_encoder;
 extern const SubGhzProtocol ws_protocol_acurite_986;
+extern const SubGhzBlockConst ws_protocol_acurite_986_const;
 
 /**
  * Allocate WSProtocolDecoderAcurite_986.
@@ -28,7 +28,7 @@ Exmpl.: 10111100-1-0-00-000011101000-01101100-0100-001011
 
 #define AURIOL_AHFL_CONST_DATA 0b0100
 
-static const SubGhzBlockConst ws_protocol_auriol_ahfl_const = {
+const SubGhzBlockConst ws_protocol_auriol_ahfl_const = {
     .te_short = 500,
     .te_long = 2000,
     .te_delta = 150,
@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderAuriol_AHFL WSProtocolEncoderAuriol_AHFL;
 extern const SubGhzProtocolDecoder ws_protocol_auriol_ahfl_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_auriol_ahfl_encoder;
 extern const SubGhzProtocol ws_protocol_auriol_ahfl;
+extern const SubGhzBlockConst ws_protocol_auriol_ahfl_const;
 
 /**
  * Allocate WSProtocolDecoderAuriol_AHFL.
@@ -27,7 +27,7 @@ Exmpl.:	11110100-10-01-00-0001001100-1111-01011101
 
 #define AURIOL_TH_CONST_DATA 0b1110
 
-static const SubGhzBlockConst ws_protocol_auriol_th_const = {
+const SubGhzBlockConst ws_protocol_auriol_th_const = {
     .te_short = 500,
     .te_long = 2000,
     .te_delta = 150,
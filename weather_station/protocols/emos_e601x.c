@@ -24,7 +24,7 @@
  * - R: (8 bit) repeat counter
  */
 
-static const SubGhzBlockConst ws_protocol_emose601x_const = {
+const SubGhzBlockConst ws_protocol_emose601x_const = {
     .te_short = 260,
     .te_long = 800,
     .te_delta = 100,
@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderEmosE601x WSProtocolEncoderEmosE601x;
 extern const SubGhzProtocolDecoder ws_protocol_emose601x_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_emose601x_encoder;
 extern const SubGhzProtocol ws_protocol_emose601x;
+extern const SubGhzBlockConst ws_protocol_emose601x_const;
 
 /**
  * Allocate WSProtocolDecoderEmosE601x.
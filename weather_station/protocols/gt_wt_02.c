@@ -30,7 +30,7 @@
  * 
 */
 
-static const SubGhzBlockConst ws_protocol_gt_wt_02_const = {
+const SubGhzBlockConst ws_protocol_gt_wt_02_const = {
     .te_short = 500,
     .te_long = 2000,
     .te_delta = 150,
@@ -53,7 +53,7 @@
  * 
  */
 
-static const SubGhzBlockConst ws_protocol_gt_wt_03_const = {
+const SubGhzBlockConst ws_protocol_gt_wt_03_const = {
     .te_short = 285,
     .te_long = 570,
     .te_delta = 120,
@@ -38,7 +38,7 @@
  * 
  */
 
-static const SubGhzBlockConst ws_protocol_infactory_const = {
+const SubGhzBlockConst ws_protocol_infactory_const = {
     .te_short = 500,
     .te_long = 2000,
     .te_delta = 150,
@@ -24,7 +24,7 @@
  * - X: CRC-4 poly 0x3 init 0x0 xor last 4 bits
  */
 
-static const SubGhzBlockConst ws_protocol_kedsum_th_const = {
+const SubGhzBlockConst ws_protocol_kedsum_th_const = {
     .te_short = 500,
     .te_long = 2000,
     .te_delta = 150,
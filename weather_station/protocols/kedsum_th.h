@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderKedsumTH WSProtocolEncoderKedsumTH;
 extern const SubGhzProtocolDecoder ws_protocol_kedsum_th_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_kedsum_th_encoder;
 extern const SubGhzProtocol ws_protocol_kedsum_th;
+extern const SubGhzBlockConst ws_protocol_kedsum_th_const;
 
 /**
  * Allocate WSProtocolDecoderKedsumTH.
@@ -9,6 +9,7 @@
 #include <lib/subghz/blocks/math.h>
 
 #define WS_PROTOCOL_LACROSSE_TX_NAME "LaCrosse_TX"
+#define LACROSSE_TX_GAP 1000
 
 typedef struct WSProtocolDecoderLaCrosse_TX WSProtocolDecoderLaCrosse_TX;
 typedef struct WSProtocolEncoderLaCrosse_TX WSProtocolEncoderLaCrosse_TX;
@@ -16,6 +17,7 @@ typedef struct WSProtocolEncoderLaCrosse_TX WSProtocolEncoderLaCrosse_TX;
 extern const SubGhzProtocolDecoder ws_protocol_lacrosse_tx_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_lacrosse_tx_encoder;
 extern const SubGhzProtocol ws_protocol_lacrosse_tx;
+extern const SubGhzBlockConst ws_protocol_lacrosse_tx_const;
 
 /**
  * Allocate WSProtocolDecoderLaCrosse_TX.
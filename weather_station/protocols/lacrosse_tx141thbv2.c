@@ -20,7 +20,7 @@
  * - n: Channel; Channel number 1 - 3
  */
 
-static const SubGhzBlockConst ws_protocol_lacrosse_tx141thbv2_const = {
+const SubGhzBlockConst ws_protocol_lacrosse_tx141thbv2_const = {
     .te_short = 208,
     .te_long = 417,
     .te_delta = 120,
@@ -29,7 +29,7 @@
 
 #define NEXUS_TH_CONST_DATA 0b1111
 
-static const SubGhzBlockConst ws_protocol_nexus_th_const = {
+const SubGhzBlockConst ws_protocol_nexus_th_const = {
     .te_short = 500,
     .te_long = 2000,
     .te_delta = 150,
@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderNexus_TH WSProtocolEncoderNexus_TH;
 extern const SubGhzProtocolDecoder ws_protocol_nexus_th_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_nexus_th_encoder;
 extern const SubGhzProtocol ws_protocol_nexus_th;
+extern const SubGhzBlockConst ws_protocol_nexus_th_const;
 
 /**
  * Allocate WSProtocolDecoderNexus_TH.
@@ -39,7 +39,7 @@
 
 #define OREGON_V1_HEADER_OK 0xFF
 
-static const SubGhzBlockConst ws_protocol_oregon_v1_const = {
+const SubGhzBlockConst ws_protocol_oregon_v1_const = {
     .te_short = 1465,
     .te_long = 2930,
     .te_delta = 350,
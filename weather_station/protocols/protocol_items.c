@@ -17,3 +17,40 @@ const SubGhzProtocol* weather_station_protocol_registry_items[] = {
 const SubGhzProtocolRegistry weather_station_protocol_registry = {
     .items = weather_station_protocol_registry_items,
     .size = COUNT_OF(weather_station_protocol_registry_items)};
+
+// Pulse that takes each decoder out of its reset step, the reset case of its feed function
+// written as multiples of the decoder's own timing constants:
+// protocol, timing, level, te_short, te_long, gap, te_delta.
+// The Manchester decoders (Oregon v2.1/v3, Ambient Weather) track every pulse and are not
+// listed.
+const WSProtocolStartItem weather_station_protocol_start_items[] = {
+    {&ws_protocol_infactory, &ws_protocol_infactory_const, true, 2, 0, 0, 2},
+    {&ws_protocol_thermopro_tx4, &ws_protocol_thermopro_tx4_const, false, 18, 0, 0, 10},
+    {&ws_protocol_nexus_th, &ws_protocol_nexus_th_const, false, 8, 0, 0, 4},
+    {&ws_protocol_gt_wt_02, &ws_protocol_gt_wt_02_const, false, 18, 0, 0, 8},
+    {&ws_protocol_gt_wt_03, &ws_protocol_gt_wt_03_const, true, 3, 0, 0, 2},
+    {&ws_protocol_acurite_606tx, &ws_protocol_acurite_606tx_const, false, 17, 0, 0, 8},
+    {&ws_protocol_acurite_609txc, &ws_protocol_acurite_609txc_const, false, 17, 0, 0, 8},
+    {&ws_protocol_acurite_986, &ws_protocol_acurite_986_const, false, 0, 1, 0, 15},
+    {&ws_protocol_lacrosse_tx, &ws_protocol_lacrosse_tx_const, false, 0, 0, LACROSSE_TX_GAP, 2},
+    {&ws_protocol_lacrosse_tx141thbv2, &ws_protocol_lacrosse_tx141thbv2_const, true, 4, 0, 0, 2},
+    {&ws_protocol_acurite_592txr, &ws_protocol_acurite_592txr_const, true, 3, 0, 0, 2},
+    {&ws_protocol_auriol_th, &ws_protocol_auriol_th_const, false, 8, 0, 0, 1},
+    {&ws_protocol_oregon_v1, &ws_protocol_oregon_v1_const, true, 1, 0, 0, 1},
+    {&ws_protocol_tx_8300, &ws_protocol_tx_8300_const, true, 2, 0, 0, 1},
+    {&ws_protocol_wendox_w6726, &ws_protocol_wendox_w6726_const, true, 1, 0, 0, 1},
+    {&ws_protocol_auriol_ahfl, &ws_protocol_auriol_ahfl_const, false, 18, 0, 0, 1},
+    {&ws_protocol_kedsum_th, &ws_protocol_kedsum_th_const, true, 1, 0, 0, 1},
+    {&ws_protocol_emose601x, &ws_protocol_emose601x_const, true, 7, 0, 0, 2},
+    {&ws_protocol_acurite_5n1, &ws_protocol_acurite_5n1_const, true, 3, 0, 0, 2},
+};
+
+const WSProtocolStartRegistry weather_station_protocol_start_registry = {
+    .items = weather_station_protocol_start_items,
+    .size = COUNT_OF(weather_station_protocol_start_items)};
+
+void ws_protocol_start_item_get_window(const WSProtocolStartItem* item, WSBlockStart* start) {
+    uint32_t center = item->timing->te_short * item->te_short +
+                      item->timing->te_long * item->te_long + item->gap;
+    ws_block_start_set(start, item->level, center, item->timing->te_delta * item->te_delta);
+}
@@ -1,5 +1,5 @@
 #pragma once
-#include "../weather_station_app_i.h"
+#include "ws_generic.h"
 
 #include "infactory.h"
 #include "thermopro_tx4.h"
@@ -25,3 +25,27 @@
 #include "emos_e601x.h"
 
 extern const SubGhzProtocolRegistry weather_station_protocol_registry;
+
+typedef struct {
+    const SubGhzProtocol* protocol;
+    const SubGhzBlockConst* timing; // Timing constants of the decoder
+    bool level; // Level of the pulse that starts a frame
+    uint8_t te_short; // Expected duration, te_short multiple
+    uint8_t te_long; // plus te_long multiple
+    uint16_t gap; // plus fixed duration, us
+    uint8_t te_delta; // Allowed deviation, te_delta multiple
+} WSProtocolStartItem;
+
+typedef struct {
+    const WSProtocolStartItem* items;
+    const size_t size;
+} WSProtocolStartRegistry;
+
+extern const WSProtocolStartRegistry weather_station_protocol_start_registry;
+
+/**
+ * Get the pulses that start a frame of the item's decoder.
+ * @param item Pointer to a WSProtocolStartItem instance
+ * @param start Pointer to a WSBlockStart instance
+ */
+void ws_protocol_start_item_get_window(const WSProtocolStartItem* item, WSBlockStart* start);
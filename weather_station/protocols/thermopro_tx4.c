@@ -26,7 +26,7 @@
 #define THERMO_PRO_TX4_TYPE_1 0b1001
 #define THERMO_PRO_TX4_TYPE_2 0b0110
 
-static const SubGhzBlockConst ws_protocol_thermopro_tx4_const = {
+const SubGhzBlockConst ws_protocol_thermopro_tx4_const = {
     .te_short = 500,
     .te_long = 2000,
     .te_delta = 150,
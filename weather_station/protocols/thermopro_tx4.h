@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderThermoPRO_TX4 WSProtocolEncoderThermoPRO_TX4;
 extern const SubGhzProtocolDecoder ws_protocol_thermopro_tx4_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_thermopro_tx4_encoder;
 extern const SubGhzProtocol ws_protocol_thermopro_tx4;
+extern const SubGhzBlockConst ws_protocol_thermopro_tx4_const;
 
 /**
  * Allocate WSProtocolDecoderThermoPRO_TX4.
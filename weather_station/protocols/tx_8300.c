@@ -34,7 +34,7 @@
 
 #define TX_8300_PACKAGE_SIZE 32
 
-static const SubGhzBlockConst ws_protocol_tx_8300_const = {
+const SubGhzBlockConst ws_protocol_tx_8300_const = {
     .te_short = 1940,
     .te_long = 3880,
     .te_delta = 250,
@@ -28,7 +28,7 @@
  *  u: unknown; 
  */
 
-static const SubGhzBlockConst ws_protocol_wendox_w6726_const = {
+const SubGhzBlockConst ws_protocol_wendox_w6726_const = {
     .te_short = 1955,
     .te_long = 5865,
     .te_delta = 300,
@@ -16,6 +16,7 @@ typedef struct WSProtocolEncoderWendoxW6726 WSProtocolEncoderWendoxW6726;
 extern const SubGhzProtocolDecoder ws_protocol_wendox_w6726_decoder;
 extern const SubGhzProtocolEncoder ws_protocol_wendox_w6726_encoder;
 extern const SubGhzProtocol ws_protocol_wendox_w6726;
+extern const SubGhzBlockConst ws_protocol_wendox_w6726_const;
 
 /**
  * Allocate WSProtocolDecoderWendoxW6726.
@@ -251,4 +251,12 @@ SubGhzProtocolStatus ws_block_generic_deserialize_check_count_bit(
         }
     } while(false);
     return ret;
-}
\ No newline at end of file
+}
+
+void ws_block_start_set(WSBlockStart* start, bool level, uint32_t center, uint32_t delta) {
+    furi_assert(start);
+    furi_assert(delta > 0);
+    start->level = level;
+    start->min = (center >= delta) ? (center - delta + 1) : 0;
+    start->max = center + delta - 1;
+}
@@ -8,6 +8,8 @@
 #include "furi.h"
 #include <furi_hal.h>
 #include <lib/subghz/types.h>
+#include <lib/subghz/protocols/base.h>
+#include <lib/subghz/blocks/decoder.h>
 #include <locale/locale.h>
 
 #ifdef __cplusplus
@@ -36,6 +38,19 @@ struct WSBlockGeneric {
     float temp;
 };
 
+// Every weather station decoder instance begins with these members
+typedef struct {
+    SubGhzProtocolDecoderBase base;
+    SubGhzBlockDecoder decoder;
+    WSBlockGeneric generic;
+} WSProtocolDecoderHead;
+
+typedef struct {
+    bool level; // Level of the pulse that starts a frame
+    uint32_t min; // Shortest duration that starts a frame, us
+    uint32_t max; // Longest duration that starts a frame, us
+} WSBlockStart;
+
 /**
  * Get name preset.
  * @param preset_name name preset
@@ -76,6 +91,26 @@ SubGhzProtocolStatus ws_block_generic_deserialize_check_count_bit(
     FlipperFormat* flipper_format,
     uint16_t count_bit);
 
+/**
+ * Set the pulses that start a frame, same as DURATION_DIFF(duration, center) < delta.
+ * @param start Pointer to a WSBlockStart instance
+ * @param level Signal level true-high false-low
+ * @param center Expected duration, us
+ * @param delta Allowed deviation, us
+ */
+void ws_block_start_set(WSBlockStart* start, bool level, uint32_t center, uint32_t delta);
+
+/**
+ * Check whether a pulse can start a frame.
+ * @param start Pointer to a WSBlockStart instance
+ * @param level Signal level true-high false-low
+ * @param duration Duration of this level in, us
+ * @return true if the pulse is inside the window
+ */
+static inline bool ws_block_start_match(const WSBlockStart* start, bool level, uint32_t duration) {
+    return (level == start->level) && (duration >= start->min) && (duration <= start->max);
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
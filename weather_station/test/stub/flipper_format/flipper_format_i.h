@@ -0,0 +1,3 @@
+#pragma once
+
+#include <lib/flipper_format/flipper_format_i.h>
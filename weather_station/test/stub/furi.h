@@ -0,0 +1,79 @@
+#pragma once
+
+// Host stand-in for the parts of the Flipper SDK the decoders use
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// Zeroed like the firmware allocator, counted by the harness
+void* ws_test_malloc(size_t size);
+#define malloc(size) ws_test_malloc(size)
+
+#define furi_assert(x) ((void)(x))
+#define furi_crash(...) abort()
+#define FURI_LOG_E(...) ((void)0)
+#define FURI_LOG_W(...) ((void)0)
+#define FURI_LOG_I(...) ((void)0)
+#define FURI_LOG_D(...) ((void)0)
+#define FURI_LOG_T(...) ((void)0)
+#define UNUSED(x) (void)(x)
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+
+#define bit_read(value, bit) (((value) >> (bit)) & 0x01)
+#define bit_set(value, bit) ((value) |= (1UL << (bit)))
+#define bit_clear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bit_write(value, bit, bitvalue) (bitvalue ? bit_set(value, bit) : bit_clear(value, bit))
+
+typedef struct FuriString FuriString;
+
+FuriString* furi_string_alloc(void);
+void furi_string_free(FuriString* string);
+void furi_string_set(FuriString* string, const char* source);
+void furi_string_printf(FuriString* string, const char* format, ...);
+void furi_string_cat_printf(FuriString* string, const char* format, ...);
+const char* furi_string_get_cstr(const FuriString* string);
+FuriString* furi_string_alloc_set(const FuriString* source);
+bool furi_string_equal(const FuriString* string, const FuriString* other);
+
+// Advanced by the harness
+uint32_t furi_get_tick(void);
+
+// M*LIB, only the array calls the history uses
+
+#define M_POD_OPLIST              ()
+#define ARRAY_OPLIST(name, oplist) ()
+
+#define ARRAY_DEF(name, type, oplist)                                            \
+    typedef type name##_t_item;                                                  \
+    typedef struct {                                                             \
+        type* ptr;                                                               \
+        size_t size;                                                             \
+        size_t alloc;                                                            \
+    } name##_s, name##_t[1];                                                     \
+    static inline void name##_init(name##_t array) {                             \
+        memset(array, 0, sizeof(name##_s));                                      \
+    }                                                                            \
+    static inline void name##_reset(name##_t array) {                            \
+        array->size = 0;                                                         \
+    }                                                                            \
+    static inline void name##_clear(name##_t array) {                            \
+        free(array->ptr);                                                        \
+        memset(array, 0, sizeof(name##_s));                                      \
+    }                                                                            \
+    static inline type* name##_get(const name##_t array, size_t i) {             \
+        return &array->ptr[i];                                                   \
+    }                                                                            \
+    static inline type* name##_push_raw(name##_t array) {                        \
+        if(array->size == array->alloc) {                                        \
+            array->alloc = array->alloc ? array->alloc * 2 : 4;                  \
+            array->ptr = realloc(array->ptr, sizeof(type) * array->alloc);       \
+        }                                                                        \
+        return &array->ptr[array->size++];                                       \
+    }
+
+#define M_EACH(item, array, name_t) \
+    (name_t##_item* item = (array)->ptr; item < (array)->ptr + (array)->size; item++)
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <furi.h>
+
+// Saving and loading is not exercised, every call fails
+
+typedef struct FlipperFormat FlipperFormat;
+
+FlipperFormat* flipper_format_string_alloc(void);
+void flipper_format_free(FlipperFormat* flipper_format);
+
+bool flipper_format_rewind(FlipperFormat* flipper_format);
+bool flipper_format_write_header_cstr(
+    FlipperFormat* flipper_format,
+    const char* filetype,
+    const uint32_t version);
+bool flipper_format_read_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint8_t* data,
+    const uint16_t data_size);
+bool flipper_format_write_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint8_t* data,
+    const uint16_t data_size);
+bool flipper_format_read_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    float* data,
+    const uint16_t data_size);
+bool flipper_format_write_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const float* data,
+    const uint16_t data_size);
+bool flipper_format_read_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* data,
+    const uint16_t data_size);
+bool flipper_format_write_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint32_t* data,
+    const uint16_t data_size);
+bool flipper_format_read_string(FlipperFormat* flipper_format, const char* key, FuriString* data);
+bool flipper_format_write_string_cstr(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const char* data);
+bool flipper_format_update_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint32_t* data,
+    const uint16_t data_size);
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "flipper_format.h"
+#include <lib/toolbox/stream/stream.h>
+
+Stream* flipper_format_get_raw_stream(FlipperFormat* flipper_format);
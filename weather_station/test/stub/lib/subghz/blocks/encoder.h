@@ -0,0 +1,11 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct {
+    bool is_running;
+    size_t repeat;
+    size_t front;
+    size_t size_upload;
+    void* upload;
+} SubGhzProtocolBlockEncoder;
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <furi.h>
+
+#define DURATION_DIFF(x, y) (((x) < (y)) ? ((y) - (x)) : ((x) - (y)))
+
+uint64_t subghz_protocol_blocks_reverse_key(uint64_t key, uint8_t bit_count);
+uint8_t subghz_protocol_blocks_crc4(
+    uint8_t const message[],
+    size_t size,
+    uint8_t polynomial,
+    uint8_t init);
+uint8_t subghz_protocol_blocks_crc8(
+    uint8_t const message[],
+    size_t size,
+    uint8_t polynomial,
+    uint8_t init);
+uint8_t subghz_protocol_blocks_lfsr_digest8(
+    uint8_t const message[],
+    size_t size,
+    uint8_t gen,
+    uint8_t key);
+uint8_t subghz_protocol_blocks_lfsr_digest8_reflect(
+    uint8_t const message[],
+    size_t size,
+    uint8_t gen,
+    uint8_t key);
+uint8_t subghz_protocol_blocks_add_bytes(uint8_t const message[], size_t size);
+uint8_t subghz_protocol_blocks_parity_bytes(uint8_t const message[], size_t size);
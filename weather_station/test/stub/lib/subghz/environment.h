@@ -0,0 +1,11 @@
+#pragma once
+
+#include <lib/subghz/types.h>
+
+typedef struct SubGhzEnvironment SubGhzEnvironment;
+
+SubGhzEnvironment* subghz_environment_alloc(void);
+void subghz_environment_free(SubGhzEnvironment* instance);
+void subghz_environment_set_protocol_registry(
+    SubGhzEnvironment* instance,
+    const SubGhzProtocolRegistry* protocol_registry);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <lib/subghz/types.h>
+
+typedef struct SubGhzProtocolDecoderBase SubGhzProtocolDecoderBase;
+
+typedef void (
+    *SubGhzProtocolDecoderBaseRxCallback)(SubGhzProtocolDecoderBase* instance, void* context);
+
+struct SubGhzProtocolDecoderBase {
+    const SubGhzProtocol* protocol;
+    SubGhzProtocolDecoderBaseRxCallback callback;
+    void* context;
+};
+
+uint8_t subghz_protocol_decoder_base_get_hash_data(SubGhzProtocolDecoderBase* decoder_base);
+
+typedef struct {
+    const SubGhzProtocol* protocol;
+} SubGhzProtocolEncoderBase;
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <lib/subghz/protocols/base.h>
+
+// Broadcasts every pulse to all decoders the filter lets through, like the firmware receiver
+
+typedef struct SubGhzReceiver SubGhzReceiver;
+
+SubGhzReceiver* subghz_receiver_alloc_init(SubGhzEnvironment* environment);
+void subghz_receiver_free(SubGhzReceiver* instance);
+void subghz_receiver_decode(SubGhzReceiver* instance, bool level, uint32_t duration);
+void subghz_receiver_reset(SubGhzReceiver* instance);
+void subghz_receiver_set_filter(SubGhzReceiver* instance, SubGhzProtocolFlag filter);
+void subghz_receiver_set_rx_callback(
+    SubGhzReceiver* instance,
+    SubGhzProtocolDecoderBaseRxCallback callback,
+    void* context);
+SubGhzProtocolDecoderBase*
+    subghz_receiver_search_decoder_base_by_name(SubGhzReceiver* instance, const char* decoder_name);
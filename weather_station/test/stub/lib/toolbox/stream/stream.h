@@ -0,0 +1,7 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct Stream Stream;
+
+bool stream_clean(Stream* stream);
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <furi.h>
+
+float locale_fahrenheit_to_celsius(float temp_f);
@@ -0,0 +1,466 @@
+#include <furi.h>
+#include <furi_hal.h>
+#include <locale/locale.h>
+#include <lib/flipper_format/flipper_format_i.h>
+#include <lib/subghz/environment.h>
+#include <lib/subghz/receiver.h>
+#include <lib/subghz/blocks/decoder.h>
+#include <lib/subghz/blocks/math.h>
+#include <lib/toolbox/manchester_decoder.h>
+
+#include <stdarg.h>
+
+#undef malloc
+
+size_t ws_test_malloc_count = 0;
+size_t ws_test_malloc_bytes = 0;
+
+void* ws_test_malloc(size_t size) {
+    ws_test_malloc_count++;
+    ws_test_malloc_bytes += size;
+    void* ptr = calloc(1, size);
+    if(!ptr) abort();
+    return ptr;
+}
+
+// FuriString
+
+#define FURI_STRING_SIZE 256
+
+struct FuriString {
+    char data[FURI_STRING_SIZE];
+};
+
+FuriString* furi_string_alloc(void) {
+    return ws_test_malloc(sizeof(FuriString));
+}
+
+void furi_string_free(FuriString* string) {
+    free(string);
+}
+
+void furi_string_set(FuriString* string, const char* source) {
+    snprintf(string->data, FURI_STRING_SIZE, "%s", source);
+}
+
+void furi_string_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(string->data, FURI_STRING_SIZE, format, args);
+    va_end(args);
+}
+
+void furi_string_cat_printf(FuriString* string, const char* format, ...) {
+    size_t length = strlen(string->data);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(string->data + length, FURI_STRING_SIZE - length, format, args);
+    va_end(args);
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+FuriString* furi_string_alloc_set(const FuriString* source) {
+    FuriString* string = furi_string_alloc();
+    furi_string_set(string, source->data);
+    return string;
+}
+
+bool furi_string_equal(const FuriString* string, const FuriString* other) {
+    return !strcmp(string->data, other->data);
+}
+
+uint32_t ws_test_tick = 0;
+
+uint32_t furi_get_tick(void) {
+    return ws_test_tick;
+}
+
+uint32_t furi_hal_rtc_get_timestamp(void) {
+    return 0;
+}
+
+float locale_fahrenheit_to_celsius(float temp_f) {
+    return (temp_f - 32.0f) / 1.8f;
+}
+
+// FlipperFormat
+
+struct FlipperFormat {
+    uint8_t unused;
+};
+
+FlipperFormat* flipper_format_string_alloc(void) {
+    return ws_test_malloc(sizeof(FlipperFormat));
+}
+
+void flipper_format_free(FlipperFormat* flipper_format) {
+    free(flipper_format);
+}
+
+bool flipper_format_rewind(FlipperFormat* flipper_format) {
+    UNUSED(flipper_format);
+    return false;
+}
+
+bool flipper_format_write_header_cstr(
+    FlipperFormat* flipper_format,
+    const char* filetype,
+    const uint32_t version) {
+    UNUSED(flipper_format);
+    UNUSED(filetype);
+    UNUSED(version);
+    return false;
+}
+
+bool flipper_format_read_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint8_t* data,
+    const uint16_t data_size) {
+    UNUSED(flipper_format);
+    UNUSED(key);
+    UNUSED(data);
+    UNUSED(data_size);
+    return false;
+}
+
+bool flipper_format_write_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint8_t* data,
+    const uint16_t data_size) {
+    UNUSED(flipper_format);
+    UNUSED(key);
+    UNUSED(data);
+    UNUSED(data_size);
+    return false;
+}
+
+bool flipper_format_read_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    float* data,
+    const uint16_t data_size) {
+    UNUSED(flipper_format);
+    UNUSED(key);
+    UNUSED(data);
+    UNUSED(data_size);
+    return false;
+}
+
+bool flipper_format_write_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const float* data,
+    const uint16_t data_size) {
+    UNUSED(flipper_format);
+    UNUSED(key);
+    UNUSED(data);
+    UNUSED(data_size);
+    return false;
+}
+
+bool flipper_format_read_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* data,
+    const uint16_t data_size) {
+    UNUSED(flipper_format);
+    UNUSED(key);
+    UNUSED(data);
+    UNUSED(data_size);
+    return false;
+}
+
+bool flipper_format_write_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint32_t* data,
+    const uint16_t data_size) {
+    UNUSED(flipper_format);
+    UNUSED(key);
+    UNUSED(data);
+    UNUSED(data_size);
+    return false;
+}
+
+bool flipper_format_update_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const uint32_t* data,
+    const uint16_t data_size) {
+    UNUSED(flipper_format);
+    UNUSED(key);
+    UNUSED(data);
+    UNUSED(data_size);
+    return false;
+}
+
+bool flipper_format_read_string(FlipperFormat* flipper_format, const char* key, FuriString* data) {
+    UNUSED(flipper_format);
+    UNUSED(key);
+    UNUSED(data);
+    return false;
+}
+
+bool flipper_format_write_string_cstr(
+    FlipperFormat* flipper_format,
+    const char* key,
+    const char* data) {
+    UNUSED(flipper_format);
+    UNUSED(key);
+    UNUSED(data);
+    return false;
+}
+
+Stream* flipper_format_get_raw_stream(FlipperFormat* flipper_format) {
+    UNUSED(flipper_format);
+    return NULL;
+}
+
+bool stream_clean(Stream* stream) {
+    UNUSED(stream);
+    return false;
+}
+
+// SubGhz environment and receiver
+
+struct SubGhzEnvironment {
+    const SubGhzProtocolRegistry* protocol_registry;
+};
+
+SubGhzEnvironment* subghz_environment_alloc(void) {
+    return ws_test_malloc(sizeof(SubGhzEnvironment));
+}
+
+void subghz_environment_free(SubGhzEnvironment* instance) {
+    free(instance);
+}
+
+void subghz_environment_set_protocol_registry(
+    SubGhzEnvironment* instance,
+    const SubGhzProtocolRegistry* protocol_registry) {
+    instance->protocol_registry = protocol_registry;
+}
+
+struct SubGhzReceiver {
+    SubGhzProtocolDecoderBase** decoders;
+    size_t decoders_count;
+    SubGhzProtocolFlag filter;
+};
+
+SubGhzReceiver* subghz_receiver_alloc_init(SubGhzEnvironment* environment) {
+    const SubGhzProtocolRegistry* registry = environment->protocol_registry;
+    SubGhzReceiver* instance = ws_test_malloc(sizeof(SubGhzReceiver));
+    instance->decoders = ws_test_malloc(sizeof(SubGhzProtocolDecoderBase*) * registry->size);
+    for(size_t i = 0; i < registry->size; i++) {
+        instance->decoders[instance->decoders_count++] =
+            registry->items[i]->decoder->alloc(environment);
+    }
+    return instance;
+}
+
+void subghz_receiver_free(SubGhzReceiver* instance) {
+    for(size_t i = 0; i < instance->decoders_count; i++) {
+        SubGhzProtocolDecoderBase* decoder = instance->decoders[i];
+        decoder->protocol->decoder->free(decoder);
+    }
+    free(instance->decoders);
+    free(instance);
+}
+
+void subghz_receiver_decode(SubGhzReceiver* instance, bool level, uint32_t duration) {
+    for(size_t i = 0; i < instance->decoders_count; i++) {
+        SubGhzProtocolDecoderBase* decoder = instance->decoders[i];
+        if((decoder->protocol->flag & instance->filter) != 0) {
+            decoder->protocol->decoder->feed(decoder, level, duration);
+        }
+    }
+}
+
+void subghz_receiver_reset(SubGhzReceiver* instance) {
+    for(size_t i = 0; i < instance->decoders_count; i++) {
+        SubGhzProtocolDecoderBase* decoder = instance->decoders[i];
+        decoder->protocol->decoder->reset(decoder);
+    }
+}
+
+void subghz_receiver_set_filter(SubGhzReceiver* instance, SubGhzProtocolFlag filter) {
+    instance->filter = filter;
+}
+
+void subghz_receiver_set_rx_callback(
+    SubGhzReceiver* instance,
+    SubGhzProtocolDecoderBaseRxCallback callback,
+    void* context) {
+    for(size_t i = 0; i < instance->decoders_count; i++) {
+        instance->decoders[i]->callback = callback;
+        instance->decoders[i]->context = context;
+    }
+}
+
+SubGhzProtocolDecoderBase*
+    subghz_receiver_search_decoder_base_by_name(SubGhzReceiver* instance, const char* decoder_name) {
+    for(size_t i = 0; i < instance->decoders_count; i++) {
+        if(!strcmp(instance->decoders[i]->protocol->name, decoder_name)) {
+            return instance->decoders[i];
+        }
+    }
+    return NULL;
+}
+
+uint8_t subghz_protocol_decoder_base_get_hash_data(SubGhzProtocolDecoderBase* decoder_base) {
+    return decoder_base->protocol->decoder->get_hash_data(decoder_base);
+}
+
+// SubGhz blocks, same as lib/subghz/blocks in the firmware
+
+void subghz_protocol_blocks_add_bit(SubGhzBlockDecoder* decoder, uint8_t bit) {
+    decoder->decode_data = decoder->decode_data << 1 | bit;
+    decoder->decode_count_bit++;
+}
+
+void subghz_protocol_blocks_add_to_128_bit(
+    SubGhzBlockDecoder* decoder,
+    uint8_t bit,
+    uint64_t* head_64_bit) {
+    if(++decoder->decode_count_bit > 64) {
+        (*head_64_bit) = ((*head_64_bit) << 1) | (decoder->decode_data >> 63);
+    }
+    decoder->decode_data = decoder->decode_data << 1 | bit;
+}
+
+uint8_t subghz_protocol_blocks_get_hash_data(SubGhzBlockDecoder* decoder, size_t len) {
+    uint8_t hash = 0;
+    uint8_t* p = (uint8_t*)&decoder->decode_data;
+    for(size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+    }
+    return hash;
+}
+
+uint64_t subghz_protocol_blocks_reverse_key(uint64_t key, uint8_t bit_count) {
+    uint64_t reverse_key = 0;
+    for(uint8_t i = 0; i < bit_count; i++) {
+        reverse_key = reverse_key << 1 | bit_read(key, i);
+    }
+    return reverse_key;
+}
+
+uint8_t subghz_protocol_blocks_crc4(
+    uint8_t const message[],
+    size_t size,
+    uint8_t polynomial,
+    uint8_t init) {
+    uint8_t remainder = init << 4;
+    uint8_t poly = polynomial << 4;
+    for(size_t byte = 0; byte < size; ++byte) {
+        remainder ^= message[byte];
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            remainder = (remainder & 0x80) ? (remainder << 1) ^ poly : (remainder << 1);
+        }
+    }
+    return remainder >> 4 & 0x0f;
+}
+
+uint8_t subghz_protocol_blocks_crc8(
+    uint8_t const message[],
+    size_t size,
+    uint8_t polynomial,
+    uint8_t init) {
+    uint8_t remainder = init;
+    for(size_t byte = 0; byte < size; ++byte) {
+        remainder ^= message[byte];
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            remainder = (remainder & 0x80) ? (remainder << 1) ^ polynomial : (remainder << 1);
+        }
+    }
+    return remainder;
+}
+
+uint8_t subghz_protocol_blocks_lfsr_digest8(
+    uint8_t const message[],
+    size_t size,
+    uint8_t gen,
+    uint8_t key) {
+    uint8_t sum = 0;
+    for(size_t byte = 0; byte < size; ++byte) {
+        uint8_t data = message[byte];
+        for(int i = 7; i >= 0; --i) {
+            if((data >> i) & 1) sum ^= key;
+            key = (key & 1) ? (key >> 1) ^ gen : (key >> 1);
+        }
+    }
+    return sum;
+}
+
+uint8_t subghz_protocol_blocks_lfsr_digest8_reflect(
+    uint8_t const message[],
+    size_t size,
+    uint8_t gen,
+    uint8_t key) {
+    uint8_t sum = 0;
+    for(int byte = size - 1; byte >= 0; --byte) {
+        uint8_t data = message[byte];
+        for(uint8_t i = 0; i < 8; ++i) {
+            if((data >> i) & 1) sum ^= key;
+            key = (key & 0x80) ? (key << 1) ^ gen : (key << 1);
+        }
+    }
+    return sum;
+}
+
+uint8_t subghz_protocol_blocks_add_bytes(uint8_t const message[], size_t size) {
+    uint32_t result = 0;
+    for(size_t i = 0; i < size; ++i) {
+        result += message[i];
+    }
+    return (uint8_t)result;
+}
+
+uint8_t subghz_protocol_blocks_parity_bytes(uint8_t const message[], size_t size) {
+    uint8_t result = 0;
+    for(size_t i = 0; i < size; ++i) {
+        result ^= message[i];
+    }
+    result ^= result >> 4;
+    result ^= result >> 2;
+    result ^= result >> 1;
+    return result & 1;
+}
+
+// Manchester decoder, same as lib/toolbox/manchester_decoder.c in the firmware
+
+static const uint8_t manchester_transitions[] = {0b00000001, 0b10010001, 0b10011011, 0b11111011};
+
+bool manchester_advance(
+    ManchesterState state,
+    ManchesterEvent event,
+    ManchesterState* next_state,
+    bool* data) {
+    bool result = false;
+    ManchesterState new_state;
+
+    if(event == ManchesterEventReset) {
+        new_state = ManchesterStateMid1;
+    } else {
+        new_state = (manchester_transitions[state] >> event) & 0x3;
+        if(new_state == state) {
+            new_state = ManchesterStateMid1;
+        } else {
+            if(new_state == ManchesterStateMid0) {
+                if(data) *data = false;
+                result = true;
+            } else if(new_state == ManchesterStateMid1) {
+                if(data) *data = true;
+                result = true;
+            }
+        }
+    }
+
+    *next_state = new_state;
+    return result;
+}
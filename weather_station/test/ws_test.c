@@ -0,0 +1,507 @@
+// Host replay of synthetic pulse streams through the weather station decoders
+//
+// - Start windows: every gated decoder leaves its reset step on exactly the pulses of its
+//   window in weather_station_protocol_start_items, and on no other pulse
+// - Nexus-TH frames: clean frames are decoded with the transmitted data
+// - Replay: a noisy stream with frames decodes the same through WSDispatch as through the
+//   broadcasting receiver, decoder state included, and is timed both ways
+// - Filter: decoders the receiver filter turns off are not fed through WSDispatch either
+// - History: records are found by id and protocol, the heap it takes and the time of an
+//   insert and an update are measured
+
+#include <furi.h>
+#include <lib/subghz/environment.h>
+#include <lib/subghz/receiver.h>
+#include <time.h>
+
+#include "../protocols/protocol_items.h"
+#include "../weather_station_dispatch.h"
+#include "../weather_station_history.h"
+
+#define WS_TEST_START_DURATION_MAX 40000
+#define WS_TEST_REPLAY_PULSES 2000000
+#define WS_TEST_REPLAY_ROUNDS 5
+#define WS_TEST_FILTER_PULSES 200000
+#define WS_TEST_NEXUS_FRAMES 100
+#define WS_TEST_HISTORY_RECORDS 40
+#define WS_TEST_HISTORY_ROUNDS 20000
+
+extern size_t ws_test_malloc_count;
+extern size_t ws_test_malloc_bytes;
+extern uint32_t ws_test_tick;
+
+typedef struct {
+    size_t decodes[32];
+    uint64_t hash;
+    uint64_t last_data;
+} WSTestRx;
+
+typedef struct {
+    bool* level;
+    uint32_t* duration;
+    size_t size;
+    size_t count;
+} WSTestStream;
+
+static uint64_t ws_test_rng_state = 88172645463325252ULL;
+
+static uint32_t ws_test_random(void) {
+    ws_test_rng_state ^= ws_test_rng_state << 13;
+    ws_test_rng_state ^= ws_test_rng_state >> 7;
+    ws_test_rng_state ^= ws_test_rng_state << 17;
+    return (uint32_t)ws_test_rng_state;
+}
+
+static double ws_test_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static size_t ws_test_protocol_index(const SubGhzProtocol* protocol) {
+    for(size_t i = 0; i < weather_station_protocol_registry.size; i++) {
+        if(weather_station_protocol_registry.items[i] == protocol) return i;
+    }
+    abort();
+}
+
+static void ws_test_rx_callback(SubGhzProtocolDecoderBase* decoder_base, void* context) {
+    WSTestRx* rx = context;
+    WSProtocolDecoderHead* decoder = (WSProtocolDecoderHead*)decoder_base;
+    size_t index = ws_test_protocol_index(decoder_base->protocol);
+
+    rx->decodes[index]++;
+    rx->hash = rx->hash * 31 + decoder->generic.data + index;
+    rx->last_data = decoder->generic.data;
+}
+
+static void ws_test_stream_push(WSTestStream* stream, bool level, uint32_t duration) {
+    if(stream->count == stream->size) {
+        stream->size = stream->size ? stream->size * 2 : 1024;
+        stream->level = realloc(stream->level, stream->size * sizeof(bool));
+        stream->duration = realloc(stream->duration, stream->size * sizeof(uint32_t));
+    }
+    stream->level[stream->count] = level;
+    stream->duration[stream->count] = duration;
+    stream->count++;
+}
+
+static void ws_test_stream_free(WSTestStream* stream) {
+    free(stream->level);
+    free(stream->duration);
+}
+
+// Sync, 36 bits of 500us high and 1000us/2000us low, sync. Type nibble is 0xF.
+static uint64_t ws_test_nexus_frame(WSTestStream* stream, bool glitches) {
+    uint64_t data = (((uint64_t)ws_test_random() << 4) | 0xF00) & 0xFFFFFF0FFULL;
+    data |= 0xF00;
+
+    ws_test_stream_push(stream, true, 500);
+    ws_test_stream_push(stream, false, 4000);
+    for(int bit = 35; bit >= 0; bit--) {
+        ws_test_stream_push(stream, true, 480 + ws_test_random() % 40);
+        uint32_t low = ((data >> bit) & 1) ? 2000 : 1000;
+        if(glitches && (ws_test_random() % 300 == 0)) low = 30;
+        ws_test_stream_push(stream, false, low);
+    }
+    ws_test_stream_push(stream, true, 500);
+    ws_test_stream_push(stream, false, 4000);
+
+    return data;
+}
+
+static const uint32_t ws_test_te[] = {
+    200, 208, 260, 285, 400, 417, 500, 550, 570, 800, 1000,
+    1100, 1300, 1465, 1750, 1940, 1955, 2000, 2930, 3880, 5865,
+};
+
+// Mix of short noise, wide noise, pulses around the protocol timings and Nexus-TH frames
+static void ws_test_replay_stream(WSTestStream* stream, size_t count) {
+    int mode = 0;
+    bool level = true;
+    while(stream->count < count) {
+        if(ws_test_random() % 5000 == 0) mode = ws_test_random() % 4;
+        if(mode == 3) {
+            if(!level) ws_test_stream_push(stream, false, 300);
+            ws_test_nexus_frame(stream, true);
+            level = true;
+            continue;
+        }
+
+        uint32_t duration;
+        if(mode == 0) {
+            duration = 20 + ws_test_random() % 200;
+        } else if(mode == 1) {
+            duration = 20 + ws_test_random() % 12000;
+        } else {
+            uint32_t te = ws_test_te[ws_test_random() % COUNT_OF(ws_test_te)];
+            uint32_t multiple = (ws_test_random() % 4 == 0) ? 1 + ws_test_random() % 40 :
+                                                              1 + ws_test_random() % 4;
+            duration = te * multiple + ws_test_random() % 200 - 100;
+        }
+        ws_test_stream_push(stream, level, duration);
+        level = !level;
+    }
+}
+
+static bool ws_test_start_windows(SubGhzEnvironment* environment) {
+    const WSProtocolStartRegistry* registry = &weather_station_protocol_start_registry;
+    bool result = true;
+
+    for(size_t i = 0; i < registry->size; i++) {
+        const WSProtocolStartItem* item = &registry->items[i];
+        const SubGhzProtocolDecoder* decoder = item->protocol->decoder;
+        WSProtocolDecoderHead* instance = decoder->alloc(environment);
+        WSBlockStart start;
+        ws_protocol_start_item_get_window(item, &start);
+
+        size_t outside = 0;
+        size_t ignored = 0;
+        for(uint32_t level = 0; level < 2; level++) {
+            for(uint32_t duration = 1; duration <= WS_TEST_START_DURATION_MAX; duration++) {
+                decoder->reset(instance);
+                SubGhzBlockDecoder idle = instance->decoder;
+                decoder->feed(instance, level, duration);
+
+                bool left = instance->decoder.parser_step != 0;
+                if(ws_block_start_match(&start, level, duration)) {
+                    if(!left) ignored++;
+                } else if(memcmp(&idle, &instance->decoder, sizeof(SubGhzBlockDecoder))) {
+                    outside++;
+                }
+            }
+        }
+
+        printf(
+            "start %-20s %s %5lu..%-5lu %s",
+            item->protocol->name,
+            item->level ? "high" : "low ",
+            (unsigned long)start.min,
+            (unsigned long)start.max,
+            (outside || ignored) ? "FAIL" : "ok");
+        if(outside) printf(", %zu pulses outside the window change the state", outside);
+        if(ignored) printf(", %zu pulses inside the window are ignored", ignored);
+        printf("\n");
+
+        result &= !outside && !ignored;
+        decoder->free(instance);
+    }
+
+    return result;
+}
+
+static bool ws_test_nexus(SubGhzEnvironment* environment) {
+    SubGhzReceiver* receiver = subghz_receiver_alloc_init(environment);
+    WSDispatch* dispatch = ws_dispatch_alloc(receiver);
+    ws_dispatch_set_filter(dispatch, SubGhzProtocolFlag_Decodable);
+    WSTestRx rx = {};
+    subghz_receiver_set_rx_callback(receiver, ws_test_rx_callback, &rx);
+    size_t index = ws_test_protocol_index(&ws_protocol_nexus_th);
+
+    size_t matched = 0;
+    for(size_t i = 0; i < WS_TEST_NEXUS_FRAMES; i++) {
+        WSTestStream stream = {};
+        ws_test_stream_push(&stream, true, 10000);
+        ws_test_stream_push(&stream, false, 20000);
+        uint64_t data = ws_test_nexus_frame(&stream, false);
+
+        size_t decodes = rx.decodes[index];
+        for(size_t j = 0; j < stream.count; j++) {
+            ws_dispatch_decode(dispatch, stream.level[j], stream.duration[j]);
+        }
+        if((rx.decodes[index] == decodes + 1) && (rx.last_data == data)) matched++;
+        ws_test_stream_free(&stream);
+    }
+
+    bool result = (matched == WS_TEST_NEXUS_FRAMES);
+    printf(
+        "nexus   %zu of %d frames decoded with their data %s\n",
+        matched,
+        WS_TEST_NEXUS_FRAMES,
+        result ? "ok" : "FAIL");
+
+    ws_dispatch_free(dispatch);
+    subghz_receiver_free(receiver);
+    return result;
+}
+
+static bool ws_test_replay(SubGhzEnvironment* environment) {
+    WSTestStream stream = {};
+    ws_test_replay_stream(&stream, WS_TEST_REPLAY_PULSES);
+
+    size_t allocs = ws_test_malloc_count;
+    SubGhzReceiver* broadcast = subghz_receiver_alloc_init(environment);
+    SubGhzReceiver* gated = subghz_receiver_alloc_init(environment);
+    WSDispatch* dispatch = ws_dispatch_alloc(gated);
+    subghz_receiver_set_filter(broadcast, SubGhzProtocolFlag_Decodable);
+    ws_dispatch_set_filter(dispatch, SubGhzProtocolFlag_Decodable);
+    WSTestRx broadcast_rx = {};
+    WSTestRx gated_rx = {};
+    subghz_receiver_set_rx_callback(broadcast, ws_test_rx_callback, &broadcast_rx);
+    subghz_receiver_set_rx_callback(gated, ws_test_rx_callback, &gated_rx);
+    size_t setup_allocs = ws_test_malloc_count - allocs;
+
+    // Decoders are allocated in registry order by both receivers
+    size_t decoders_count = weather_station_protocol_registry.size;
+    WSProtocolDecoderHead* broadcast_decoders[decoders_count];
+    WSProtocolDecoderHead* gated_decoders[decoders_count];
+    for(size_t i = 0; i < decoders_count; i++) {
+        const char* name = weather_station_protocol_registry.items[i]->name;
+        broadcast_decoders[i] =
+            (WSProtocolDecoderHead*)subghz_receiver_search_decoder_base_by_name(broadcast, name);
+        gated_decoders[i] =
+            (WSProtocolDecoderHead*)subghz_receiver_search_decoder_base_by_name(gated, name);
+    }
+
+    allocs = ws_test_malloc_count;
+    size_t mismatches = 0;
+    for(size_t i = 0; i < stream.count; i++) {
+        subghz_receiver_decode(broadcast, stream.level[i], stream.duration[i]);
+        ws_dispatch_decode(dispatch, stream.level[i], stream.duration[i]);
+        for(size_t j = 0; j < decoders_count; j++) {
+            if(memcmp(
+                   &broadcast_decoders[j]->decoder,
+                   &gated_decoders[j]->decoder,
+                   sizeof(SubGhzBlockDecoder))) {
+                if(mismatches++ < 5) {
+                    printf(
+                        "replay  %s state differs at pulse %zu\n",
+                        weather_station_protocol_registry.items[j]->name,
+                        i);
+                }
+            }
+        }
+    }
+    size_t feed_allocs = ws_test_malloc_count - allocs;
+
+    size_t decodes = 0;
+    bool decodes_equal = (broadcast_rx.hash == gated_rx.hash);
+    for(size_t i = 0; i < decoders_count; i++) {
+        decodes += broadcast_rx.decodes[i];
+        decodes_equal &= (broadcast_rx.decodes[i] == gated_rx.decodes[i]);
+        if(broadcast_rx.decodes[i] || gated_rx.decodes[i]) {
+            printf(
+                "replay  %-20s decoded %zu frames, dispatch %zu\n",
+                weather_station_protocol_registry.items[i]->name,
+                broadcast_rx.decodes[i],
+                gated_rx.decodes[i]);
+        }
+    }
+
+    double rate[2];
+    for(size_t way = 0; way < 2; way++) {
+        subghz_receiver_reset(broadcast);
+        ws_dispatch_reset(dispatch);
+        double begin = ws_test_now();
+        for(size_t round = 0; round < WS_TEST_REPLAY_ROUNDS; round++) {
+            for(size_t i = 0; i < stream.count; i++) {
+                if(way == 0) {
+                    subghz_receiver_decode(broadcast, stream.level[i], stream.duration[i]);
+                } else {
+                    ws_dispatch_decode(dispatch, stream.level[i], stream.duration[i]);
+                }
+            }
+        }
+        rate[way] = WS_TEST_REPLAY_ROUNDS * stream.count / (ws_test_now() - begin);
+    }
+
+    bool result = !mismatches && decodes_equal && !feed_allocs;
+    printf(
+        "replay  %zu pulses, %zu frames, %zu state mismatches, decodes %s %s\n",
+        stream.count,
+        decodes,
+        mismatches,
+        decodes_equal ? "equal" : "DIFFERENT",
+        result ? "ok" : "FAIL");
+    printf(
+        "replay  %.2f Mpulses/s broadcast, %.2f Mpulses/s dispatch\n",
+        rate[0] / 1e6,
+        rate[1] / 1e6);
+    printf(
+        "replay  %zu allocations to set up both receivers, %zu while decoding\n",
+        setup_allocs,
+        feed_allocs);
+
+    ws_dispatch_free(dispatch);
+    subghz_receiver_free(gated);
+    subghz_receiver_free(broadcast);
+    ws_test_stream_free(&stream);
+    return result;
+}
+
+// Only the Oregon v2.1/v3 decoders lack the 315 MHz flag, the filter has to keep them idle
+static bool ws_test_filter(SubGhzEnvironment* environment) {
+    WSTestStream stream = {};
+    ws_test_replay_stream(&stream, WS_TEST_FILTER_PULSES);
+
+    SubGhzReceiver* broadcast = subghz_receiver_alloc_init(environment);
+    SubGhzReceiver* gated = subghz_receiver_alloc_init(environment);
+    WSDispatch* dispatch = ws_dispatch_alloc(gated);
+    subghz_receiver_set_filter(broadcast, SubGhzProtocolFlag_315);
+    ws_dispatch_set_filter(dispatch, SubGhzProtocolFlag_315);
+
+    size_t decoders_count = weather_station_protocol_registry.size;
+    WSProtocolDecoderHead* broadcast_decoders[decoders_count];
+    WSProtocolDecoderHead* gated_decoders[decoders_count];
+    SubGhzBlockDecoder idle[decoders_count];
+    for(size_t i = 0; i < decoders_count; i++) {
+        const char* name = weather_station_protocol_registry.items[i]->name;
+        broadcast_decoders[i] =
+            (WSProtocolDecoderHead*)subghz_receiver_search_decoder_base_by_name(broadcast, name);
+        gated_decoders[i] =
+            (WSProtocolDecoderHead*)subghz_receiver_search_decoder_base_by_name(gated, name);
+        idle[i] = gated_decoders[i]->decoder;
+    }
+
+    size_t filtered = 0;
+    for(size_t i = 0; i < decoders_count; i++) {
+        if(!(weather_station_protocol_registry.items[i]->flag & SubGhzProtocolFlag_315)) {
+            filtered++;
+        }
+    }
+
+    // The Manchester decoders fall back to their reset state on noise, so the state is
+    // compared after every pulse
+    size_t mismatches = 0;
+    for(size_t i = 0; i < stream.count; i++) {
+        subghz_receiver_decode(broadcast, stream.level[i], stream.duration[i]);
+        ws_dispatch_decode(dispatch, stream.level[i], stream.duration[i]);
+        for(size_t j = 0; j < decoders_count; j++) {
+            const SubGhzProtocol* protocol = weather_station_protocol_registry.items[j];
+            SubGhzBlockDecoder* state = &gated_decoders[j]->decoder;
+            bool differs =
+                memcmp(&broadcast_decoders[j]->decoder, state, sizeof(SubGhzBlockDecoder));
+            if(!(protocol->flag & SubGhzProtocolFlag_315)) {
+                differs |= memcmp(&idle[j], state, sizeof(SubGhzBlockDecoder));
+            }
+            if(differs && (mismatches++ < 5)) {
+                printf("filter  %s state differs at pulse %zu\n", protocol->name, i);
+            }
+        }
+    }
+
+    bool result = filtered && !mismatches;
+    printf(
+        "filter  %zu decoders filtered out, %zu state mismatches %s\n",
+        filtered,
+        mismatches,
+        result ? "ok" : "FAIL");
+
+    ws_dispatch_free(dispatch);
+    subghz_receiver_free(gated);
+    subghz_receiver_free(broadcast);
+    ws_test_stream_free(&stream);
+    return result;
+}
+
+// Hands the history one received sensor, later than its duplicate filter looks back
+static WSHistoryStateAddKey ws_test_history_add(
+    WSHistory* history,
+    WSProtocolDecoderHead* decoder,
+    uint32_t id,
+    SubGhzRadioPreset* preset) {
+    decoder->decoder.decode_data = id;
+    decoder->generic.id = id;
+    decoder->generic.data = (uint64_t)id << 8 | 0x5A;
+    decoder->generic.channel = WS_NO_CHANNEL;
+    ws_test_tick += 1000;
+    return ws_history_add_to_history(history, decoder, preset);
+}
+
+static bool ws_test_history(SubGhzEnvironment* environment) {
+    size_t decoders_count = weather_station_protocol_registry.size;
+    WSProtocolDecoderHead* decoders[decoders_count];
+    for(size_t i = 0; i < decoders_count; i++) {
+        decoders[i] = weather_station_protocol_registry.items[i]->decoder->alloc(environment);
+    }
+    SubGhzRadioPreset preset = {.name = furi_string_alloc(), .frequency = 433920000};
+    furi_string_set(preset.name, "AM650");
+
+    size_t bytes = ws_test_malloc_bytes;
+    WSHistory* history = ws_history_alloc();
+    size_t alloc_bytes = ws_test_malloc_bytes - bytes;
+
+    // One id on two protocols is two sensors, the second sighting of either updates it
+    bool result = true;
+    result &= ws_test_history_add(history, decoders[0], 7, &preset) == WSHistoryStateAddKeyNewDada;
+    result &= ws_test_history_add(history, decoders[1], 7, &preset) == WSHistoryStateAddKeyNewDada;
+    result &=
+        ws_test_history_add(history, decoders[0], 7, &preset) == WSHistoryStateAddKeyUpdateData;
+    result &= (ws_history_get_item(history) == 2) &&
+              (ws_history_get_type_protocol(history, 1) ==
+               weather_station_protocol_registry.items[1]->type);
+    // The same frame again right away is a repeat of the transmission
+    ws_test_tick -= 1000;
+    result &= ws_test_history_add(history, decoders[0], 7, &preset) == WSHistoryStateAddKeyTimeOut;
+    // Every FlipperFormat write fails in the stub, the view gets NULL to show an error
+    result &= (ws_history_get_raw_data(history, 0) == NULL);
+
+    ws_history_reset(history);
+    bytes = ws_test_malloc_bytes;
+    bool filled = true;
+    for(uint32_t i = 0; i < 50; i++) {
+        filled &= ws_test_history_add(history, decoders[i % decoders_count], i, &preset) ==
+                  WSHistoryStateAddKeyNewDada;
+    }
+    result &= filled && (ws_test_history_add(history, decoders[0], 50, &preset) ==
+                         WSHistoryStateAddKeyOverflow);
+    size_t fill_bytes = ws_test_malloc_bytes - bytes;
+
+    // Time of an insert into an empty to 40 record history, and of an update at 40 records
+    double begin = ws_test_now();
+    for(size_t round = 0; round < WS_TEST_HISTORY_ROUNDS; round++) {
+        ws_history_reset(history);
+        for(uint32_t i = 0; i < WS_TEST_HISTORY_RECORDS; i++) {
+            ws_test_history_add(history, decoders[i % decoders_count], i, &preset);
+        }
+    }
+    double insert_ns =
+        (ws_test_now() - begin) * 1e9 / WS_TEST_HISTORY_ROUNDS / WS_TEST_HISTORY_RECORDS;
+    begin = ws_test_now();
+    size_t updates = 0;
+    for(size_t round = 0; round < WS_TEST_HISTORY_ROUNDS; round++) {
+        for(uint32_t i = 0; i < WS_TEST_HISTORY_RECORDS; i++) {
+            uint32_t id = ws_test_random() % WS_TEST_HISTORY_RECORDS;
+            updates += ws_test_history_add(history, decoders[id % decoders_count], id, &preset) ==
+                       WSHistoryStateAddKeyUpdateData;
+        }
+    }
+    double update_ns =
+        (ws_test_now() - begin) * 1e9 / WS_TEST_HISTORY_ROUNDS / WS_TEST_HISTORY_RECORDS;
+    result &= (updates == WS_TEST_HISTORY_ROUNDS * WS_TEST_HISTORY_RECORDS) &&
+              (ws_history_get_item(history) == WS_TEST_HISTORY_RECORDS);
+
+    printf(
+        "history %zu bytes allocated, %zu more for 50 records on one preset, lookups %s\n",
+        alloc_bytes,
+        fill_bytes,
+        result ? "ok" : "FAIL");
+    printf(
+        "history %.1f ns per insert, %.1f ns per update at %d records\n",
+        insert_ns,
+        update_ns,
+        WS_TEST_HISTORY_RECORDS);
+
+    ws_history_free(history);
+    furi_string_free(preset.name);
+    for(size_t i = 0; i < decoders_count; i++) {
+        weather_station_protocol_registry.items[i]->decoder->free(decoders[i]);
+    }
+    return result;
+}
+
+int main(void) {
+    SubGhzEnvironment* environment = subghz_environment_alloc();
+    subghz_environment_set_protocol_registry(environment, &weather_station_protocol_registry);
+
+    bool result = true;
+    result &= ws_test_start_windows(environment);
+    result &= ws_test_nexus(environment);
+    result &= ws_test_replay(environment);
+    result &= ws_test_filter(environment);
+    result &= ws_test_history(environment);
+
+    subghz_environment_free(environment);
+    printf("%s\n", result ? "PASS" : "FAIL");
+    return result ? 0 : 1;
+}
@@ -15,20 +15,23 @@ typedef struct {
     uint32_t curr_ts;
     FuriString* protocol_name;
     WSBlockGeneric* generic;
+    bool unavailable; // The record couldn't be serialized
 } WSReceiverInfoModel;
 
 void ws_view_receiver_info_update(WSReceiverInfo* ws_receiver_info, FlipperFormat* fff) {
     furi_assert(ws_receiver_info);
-    furi_assert(fff);
 
     with_view_model(
         ws_receiver_info->view,
         WSReceiverInfoModel * model,
         {
-            flipper_format_rewind(fff);
-            flipper_format_read_string(fff, "Protocol", model->protocol_name);
+            model->unavailable = (fff == NULL);
+            if(fff) {
+                flipper_format_rewind(fff);
+                flipper_format_read_string(fff, "Protocol", model->protocol_name);
 
-            ws_block_generic_deserialize(model->generic, fff);
+                ws_block_generic_deserialize(model->generic, fff);
+            }
 
             model->curr_ts = furi_hal_rtc_get_timestamp();
         },
@@ -41,6 +44,11 @@ void ws_view_receiver_info_draw(Canvas* canvas, WSReceiverInfoModel* model) {
     canvas_set_color(canvas, ColorBlack);
     canvas_set_font(canvas, FontSecondary);
 
+    if(model->unavailable) {
+        canvas_draw_str_aligned(canvas, 64, 32, AlignCenter, AlignCenter, "Unable to show record");
+        return;
+    }
+
     snprintf(
         buffer,
         sizeof(buffer),
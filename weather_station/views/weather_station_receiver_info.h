@@ -7,6 +7,7 @@
 
 typedef struct WSReceiverInfo WSReceiverInfo;
 
+// NULL shows an error in place of the record
 void ws_view_receiver_info_update(WSReceiverInfo* ws_receiver_info, FlipperFormat* fff);
 
 WSReceiverInfo* ws_view_receiver_info_alloc();
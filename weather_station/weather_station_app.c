@@ -105,12 +105,13 @@ WeatherStationApp* weather_station_app_alloc() {
     subghz_devices_reset(app->txrx->radio_device);
     subghz_devices_idle(app->txrx->radio_device);
 
-    subghz_receiver_set_filter(app->txrx->receiver, SubGhzProtocolFlag_Decodable);
+    app->txrx->dispatch = ws_dispatch_alloc(app->txrx->receiver);
+    ws_dispatch_set_filter(app->txrx->dispatch, SubGhzProtocolFlag_Decodable);
     subghz_worker_set_overrun_callback(
-        app->txrx->worker, (SubGhzWorkerOverrunCallback)subghz_receiver_reset);
+        app->txrx->worker, (SubGhzWorkerOverrunCallback)ws_dispatch_reset);
     subghz_worker_set_pair_callback(
-        app->txrx->worker, (SubGhzWorkerPairCallback)subghz_receiver_decode);
-    subghz_worker_set_context(app->txrx->worker, app->txrx->receiver);
+        app->txrx->worker, (SubGhzWorkerPairCallback)ws_dispatch_decode);
+    subghz_worker_set_context(app->txrx->worker, app->txrx->dispatch);
 
     furi_hal_power_suppress_charge_enter();
 
@@ -151,6 +152,7 @@ void weather_station_app_free(WeatherStationApp* app) {
     subghz_setting_free(app->setting);
 
     //Worker & Protocol & History
+    ws_dispatch_free(app->txrx->dispatch);
     subghz_receiver_free(app->txrx->receiver);
     subghz_environment_free(app->txrx->environment);
     ws_history_free(app->txrx->history);
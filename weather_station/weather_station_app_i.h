@@ -13,6 +13,7 @@
 #include "views/weather_station_receiver.h"
 #include "views/weather_station_receiver_info.h"
 #include "weather_station_history.h"
+#include "weather_station_dispatch.h"
 
 #include <lib/subghz/subghz_setting.h>
 #include <lib/subghz/subghz_worker.h>
@@ -30,6 +31,7 @@ struct WeatherStationTxRx {
     const SubGhzDevice* radio_device;
     SubGhzEnvironment* environment;
     SubGhzReceiver* receiver;
+    WSDispatch* dispatch;
     SubGhzRadioPreset* preset;
     WSHistory* history;
     uint16_t idx_menu_chosen;
@@ -0,0 +1,93 @@
+#include "weather_station_dispatch.h"
+#include "protocols/protocol_items.h"
+
+#define TAG "WSDispatch"
+
+typedef struct {
+    WSProtocolDecoderHead* decoder;
+    SubGhzDecoderFeed feed;
+    WSBlockStart start;
+    bool gated;
+    bool enabled;
+} WSDispatchSlot;
+
+struct WSDispatch {
+    SubGhzReceiver* receiver;
+    WSDispatchSlot* slots;
+    size_t slots_count;
+    uint32_t fed;
+    uint32_t skipped;
+};
+
+static const WSProtocolStartItem* ws_dispatch_find_start(const SubGhzProtocol* protocol) {
+    const WSProtocolStartRegistry* registry = &weather_station_protocol_start_registry;
+    for(size_t i = 0; i < registry->size; i++) {
+        if(registry->items[i].protocol == protocol) {
+            return &registry->items[i];
+        }
+    }
+    return NULL;
+}
+
+WSDispatch* ws_dispatch_alloc(SubGhzReceiver* receiver) {
+    furi_assert(receiver);
+    WSDispatch* instance = malloc(sizeof(WSDispatch));
+    instance->receiver = receiver;
+    instance->slots = malloc(sizeof(WSDispatchSlot) * weather_station_protocol_registry.size);
+
+    for(size_t i = 0; i < weather_station_protocol_registry.size; i++) {
+        const SubGhzProtocol* protocol = weather_station_protocol_registry.items[i];
+        SubGhzProtocolDecoderBase* decoder =
+            subghz_receiver_search_decoder_base_by_name(receiver, protocol->name);
+        if(!decoder) continue;
+
+        WSDispatchSlot* slot = &instance->slots[instance->slots_count++];
+        slot->decoder = (WSProtocolDecoderHead*)decoder;
+        slot->feed = protocol->decoder->feed;
+        const WSProtocolStartItem* start = ws_dispatch_find_start(protocol);
+        if(start) {
+            ws_protocol_start_item_get_window(start, &slot->start);
+            slot->gated = true;
+        }
+    }
+
+    return instance;
+}
+
+void ws_dispatch_free(WSDispatch* instance) {
+    furi_assert(instance);
+    FURI_LOG_D(TAG, "Pulses fed %lu, skipped %lu", instance->fed, instance->skipped);
+    free(instance->slots);
+    free(instance);
+}
+
+void ws_dispatch_reset(WSDispatch* instance) {
+    furi_assert(instance);
+    subghz_receiver_reset(instance->receiver);
+}
+
+void ws_dispatch_set_filter(WSDispatch* instance, SubGhzProtocolFlag filter) {
+    furi_assert(instance);
+    subghz_receiver_set_filter(instance->receiver, filter);
+    for(size_t i = 0; i < instance->slots_count; i++) {
+        WSDispatchSlot* slot = &instance->slots[i];
+        slot->enabled = (slot->decoder->base.protocol->flag & filter) != 0;
+    }
+}
+
+void ws_dispatch_decode(WSDispatch* instance, bool level, uint32_t duration) {
+    furi_assert(instance);
+    for(size_t i = 0; i < instance->slots_count; i++) {
+        WSDispatchSlot* slot = &instance->slots[i];
+        if(!slot->enabled) continue;
+        // parser_step 0 is the reset step of every decoder, a pulse outside the start
+        // window leaves an idle decoder idle, no need to call it
+        if(slot->gated && (slot->decoder->decoder.parser_step == 0) &&
+           !ws_block_start_match(&slot->start, level, duration)) {
+            instance->skipped++;
+            continue;
+        }
+        slot->feed(slot->decoder, level, duration);
+        instance->fed++;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <furi.h>
+#include <lib/subghz/receiver.h>
+
+typedef struct WSDispatch WSDispatch;
+
+/** Allocate WSDispatch
+ *
+ * Feeds pulses straight to the receiver's decoders. A decoder sitting in its
+ * reset step only gets the pulses that can start its frame, decoders without
+ * a start window get every pulse. Like the receiver, no decoder is fed until
+ * a filter is set with ws_dispatch_set_filter().
+ *
+ * @param receiver - SubGhzReceiver instance on weather_station_protocol_registry
+ * @return WSDispatch*
+ */
+WSDispatch* ws_dispatch_alloc(SubGhzReceiver* receiver);
+
+/** Free WSDispatch
+ *
+ * @param instance - WSDispatch instance
+ */
+void ws_dispatch_free(WSDispatch* instance);
+
+/** Reset all decoders, every decoder is back to waiting for a frame start
+ *
+ * @param instance - WSDispatch instance
+ */
+void ws_dispatch_reset(WSDispatch* instance);
+
+/** Set the filter on the receiver and feed only the decoders it lets through,
+ * use in place of subghz_receiver_set_filter()
+ *
+ * @param instance - WSDispatch instance
+ * @param filter   - SubGhzProtocolFlag set a decoder's protocol has to share
+ */
+void ws_dispatch_set_filter(WSDispatch* instance, SubGhzProtocolFlag filter);
+
+/** Feed one pulse, drop-in for subghz_receiver_decode()
+ *
+ * @param instance - WSDispatch instance
+ * @param level    - Signal level true-high false-low
+ * @param duration - Duration of this level in, us
+ */
+void ws_dispatch_decode(WSDispatch* instance, bool level, uint32_t duration);
@@ -3,90 +3,109 @@
 #include <lib/toolbox/stream/stream.h>
 #include <lib/subghz/receiver.h>
 #include "protocols/ws_generic.h"
+#include "protocols/protocol_items.h"
 
 #include <furi.h>
 
 #define WS_HISTORY_MAX 50
+// Power of two, at least twice WS_HISTORY_MAX to keep the probe chains short
+#define WS_HISTORY_INDEX_SIZE 128
+#define WS_HISTORY_INDEX_EMPTY 0xFF
 #define TAG "WSHistory"
 
+// One received sensor, FlipperFormat is only built from it when the record is viewed
 typedef struct {
-    FuriString* item_str;
-    FlipperFormat* flipper_string;
-    uint8_t type;
+    uint64_t data;
     uint32_t id;
-    SubGhzRadioPreset* preset;
-} WSHistoryItem;
+    uint32_t frequency;
+    uint32_t timestamp;
+    float temp;
+    uint8_t protocol; // Index in weather_station_protocol_registry
+    uint8_t preset; // Index in WSHistory.presets
+    uint8_t data_count_bit;
+    uint8_t battery_low;
+    uint8_t humidity;
+    uint8_t channel;
+    uint8_t btn;
+} WSHistoryRecord;
 
-ARRAY_DEF(WSHistoryItemArray, WSHistoryItem, M_POD_OPLIST)
+typedef struct {
+    FuriString* name;
+    uint8_t* data;
+    size_t data_size;
+} WSHistoryPreset;
 
-#define M_OPL_WSHistoryItemArray_t() ARRAY_OPLIST(WSHistoryItemArray, M_POD_OPLIST)
+ARRAY_DEF(WSHistoryPresetArray, WSHistoryPreset, M_POD_OPLIST)
 
-typedef struct {
-    WSHistoryItemArray_t data;
-} WSHistoryStruct;
+#define M_OPL_WSHistoryPresetArray_t() ARRAY_OPLIST(WSHistoryPresetArray, M_POD_OPLIST)
 
 struct WSHistory {
     uint32_t last_update_timestamp;
     uint16_t last_index_write;
     uint8_t code_last_hash_data;
-    FuriString* tmp_string;
-    WSHistoryStruct* history;
+    WSHistoryRecord records[WS_HISTORY_MAX];
+    uint8_t index[WS_HISTORY_INDEX_SIZE]; // Record index by id and protocol, open addressing
+    WSHistoryPresetArray_t presets;
+    SubGhzRadioPreset radio_preset;
+    FlipperFormat* flipper_string;
 };
 
 WSHistory* ws_history_alloc(void) {
     WSHistory* instance = malloc(sizeof(WSHistory));
-    instance->tmp_string = furi_string_alloc();
-    instance->history = malloc(sizeof(WSHistoryStruct));
-    WSHistoryItemArray_init(instance->history->data);
+    memset(instance->index, WS_HISTORY_INDEX_EMPTY, sizeof(instance->index));
+    WSHistoryPresetArray_init(instance->presets);
+    instance->flipper_string = flipper_format_string_alloc();
     return instance;
 }
 
-void ws_history_free(WSHistory* instance) {
-    furi_assert(instance);
-    furi_string_free(instance->tmp_string);
+static void ws_history_presets_reset(WSHistory* instance) {
     for
-        M_EACH(item, instance->history->data, WSHistoryItemArray_t) {
-            furi_string_free(item->item_str);
-            furi_string_free(item->preset->name);
-            free(item->preset);
-            flipper_format_free(item->flipper_string);
-            item->type = 0;
+        M_EACH(preset, instance->presets, WSHistoryPresetArray_t) {
+            furi_string_free(preset->name);
         }
-    WSHistoryItemArray_clear(instance->history->data);
-    free(instance->history);
+    WSHistoryPresetArray_reset(instance->presets);
+}
+
+void ws_history_free(WSHistory* instance) {
+    furi_assert(instance);
+    ws_history_presets_reset(instance);
+    WSHistoryPresetArray_clear(instance->presets);
+    flipper_format_free(instance->flipper_string);
     free(instance);
 }
 
+static WSHistoryPreset* ws_history_get_preset_item(WSHistory* instance, uint16_t idx) {
+    return WSHistoryPresetArray_get(instance->presets, instance->records[idx].preset);
+}
+
 uint32_t ws_history_get_frequency(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    return item->preset->frequency;
+    furi_assert(idx < instance->last_index_write);
+    return instance->records[idx].frequency;
 }
 
 SubGhzRadioPreset* ws_history_get_radio_preset(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    return item->preset;
+    furi_assert(idx < instance->last_index_write);
+    WSHistoryPreset* preset = ws_history_get_preset_item(instance, idx);
+    instance->radio_preset.name = preset->name;
+    instance->radio_preset.frequency = instance->records[idx].frequency;
+    instance->radio_preset.data = preset->data;
+    instance->radio_preset.data_size = preset->data_size;
+    return &instance->radio_preset;
 }
 
 const char* ws_history_get_preset(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    return furi_string_get_cstr(item->preset->name);
+    furi_assert(idx < instance->last_index_write);
+    return furi_string_get_cstr(ws_history_get_preset_item(instance, idx)->name);
 }
 
 void ws_history_reset(WSHistory* instance) {
     furi_assert(instance);
-    furi_string_reset(instance->tmp_string);
-    for
-        M_EACH(item, instance->history->data, WSHistoryItemArray_t) {
-            furi_string_free(item->item_str);
-            furi_string_free(item->preset->name);
-            free(item->preset);
-            flipper_format_free(item->flipper_string);
-            item->type = 0;
-        }
-    WSHistoryItemArray_reset(instance->history->data);
+    memset(instance->index, WS_HISTORY_INDEX_EMPTY, sizeof(instance->index));
+    ws_history_presets_reset(instance);
+    stream_clean(flipper_format_get_raw_stream(instance->flipper_string));
     instance->last_index_write = 0;
     instance->code_last_hash_data = 0;
 }
@@ -98,30 +117,47 @@ uint16_t ws_history_get_item(WSHistory* instance) {
 
 uint8_t ws_history_get_type_protocol(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    return item->type;
+    furi_assert(idx < instance->last_index_write);
+    return weather_station_protocol_registry.items[instance->records[idx].protocol]->type;
 }
 
 const char* ws_history_get_protocol_name(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    flipper_format_rewind(item->flipper_string);
-    if(!flipper_format_read_string(item->flipper_string, "Protocol", instance->tmp_string)) {
-        FURI_LOG_E(TAG, "Missing Protocol");
-        furi_string_reset(instance->tmp_string);
-    }
-    return furi_string_get_cstr(instance->tmp_string);
+    furi_assert(idx < instance->last_index_write);
+    return weather_station_protocol_registry.items[instance->records[idx].protocol]->name;
 }
 
 FlipperFormat* ws_history_get_raw_data(WSHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    if(item->flipper_string) {
-        return item->flipper_string;
-    } else {
+    furi_assert(idx < instance->last_index_write);
+    WSHistoryRecord* record = &instance->records[idx];
+    WSBlockGeneric generic = {
+        .protocol_name = ws_history_get_protocol_name(instance, idx),
+        .data = record->data,
+        .id = record->id,
+        .data_count_bit = record->data_count_bit,
+        .battery_low = record->battery_low,
+        .humidity = record->humidity,
+        .timestamp = record->timestamp,
+        .channel = record->channel,
+        .btn = record->btn,
+        .temp = record->temp,
+    };
+
+    FlipperFormat* flipper_string = instance->flipper_string;
+    if(ws_block_generic_serialize(
+           &generic, flipper_string, ws_history_get_radio_preset(instance, idx)) !=
+       SubGhzProtocolStatusOk) {
         return NULL;
     }
+    // Serialize stamps the current time, put back the time the record was received
+    if(!flipper_format_rewind(flipper_string) ||
+       !flipper_format_update_uint32(flipper_string, "Ts", &record->timestamp, 1)) {
+        FURI_LOG_E(TAG, "Unable to update timestamp");
+    }
+    return flipper_string;
 }
+
 bool ws_history_get_text_space_left(WSHistory* instance, FuriString* output) {
     furi_assert(instance);
     if(instance->last_index_write == WS_HISTORY_MAX) {
@@ -134,8 +170,43 @@ bool ws_history_get_text_space_left(WSHistory* instance, FuriString* output) {
 }
 
 void ws_history_get_text_item_menu(WSHistory* instance, FuriString* output, uint16_t idx) {
-    WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, idx);
-    furi_string_set(output, item->item_str);
+    furi_assert(instance);
+    furi_assert(idx < instance->last_index_write);
+    WSHistoryRecord* record = &instance->records[idx];
+    furi_string_set(output, ws_history_get_protocol_name(instance, idx));
+    if(record->channel != WS_NO_CHANNEL) {
+        furi_string_cat_printf(output, " Ch:%X", record->channel);
+    }
+    furi_string_cat_printf(output, " %llX", record->data);
+}
+
+static uint8_t ws_history_hash(uint32_t id, uint8_t protocol) {
+    uint32_t hash = (id ^ ((uint32_t)protocol << 24)) * 2654435761UL;
+    return hash >> 25;
+}
+
+static int16_t ws_history_find_protocol(const SubGhzProtocol* protocol) {
+    for(size_t i = 0; i < weather_station_protocol_registry.size; i++) {
+        if(weather_station_protocol_registry.items[i] == protocol) return i;
+    }
+    return -1;
+}
+
+static uint8_t ws_history_find_preset(WSHistory* instance, SubGhzRadioPreset* preset) {
+    uint8_t i = 0;
+    for
+        M_EACH(item, instance->presets, WSHistoryPresetArray_t) {
+            if(furi_string_equal(item->name, preset->name) && item->data == preset->data) {
+                return i;
+            }
+            i++;
+        }
+
+    WSHistoryPreset* item = WSHistoryPresetArray_push_raw(instance->presets);
+    item->name = furi_string_alloc_set(preset->name);
+    item->data = preset->data;
+    item->data_size = preset->data_size;
+    return i;
 }
 
 WSHistoryStateAddKey
@@ -156,90 +227,40 @@ WSHistoryStateAddKey
     instance->code_last_hash_data = subghz_protocol_decoder_base_get_hash_data(decoder_base);
     instance->last_update_timestamp = furi_get_tick();
 
-    FlipperFormat* fff = flipper_format_string_alloc();
-    uint32_t id = 0;
-    subghz_protocol_decoder_base_serialize(decoder_base, fff, preset);
+    int16_t protocol = ws_history_find_protocol(decoder_base->protocol);
+    if(protocol < 0) {
+        FURI_LOG_E(TAG, "Unknown protocol");
+        return WSHistoryStateAddKeyUnknown;
+    }
+    WSBlockGeneric* generic = &((WSProtocolDecoderHead*)decoder_base)->generic;
 
-    do {
-        if(!flipper_format_rewind(fff)) {
-            FURI_LOG_E(TAG, "Rewind error");
-            break;
-        }
-        if(!flipper_format_read_uint32(fff, "Id", (uint32_t*)&id, 1)) {
-            FURI_LOG_E(TAG, "Missing Id");
+    // Update record if found, or add new record
+    WSHistoryStateAddKey state = WSHistoryStateAddKeyNewDada;
+    uint8_t slot = ws_history_hash(generic->id, protocol);
+    while(instance->index[slot] != WS_HISTORY_INDEX_EMPTY) {
+        WSHistoryRecord* record = &instance->records[instance->index[slot]];
+        if(record->id == generic->id && record->protocol == protocol) {
+            state = WSHistoryStateAddKeyUpdateData;
             break;
         }
-    } while(false);
-    flipper_format_free(fff);
-
-    //Update record if found
-    bool sensor_found = false;
-    for(size_t i = 0; i < WSHistoryItemArray_size(instance->history->data); i++) {
-        WSHistoryItem* item = WSHistoryItemArray_get(instance->history->data, i);
-        if(item->id == id) {
-            sensor_found = true;
-            Stream* flipper_string_stream = flipper_format_get_raw_stream(item->flipper_string);
-            stream_clean(flipper_string_stream);
-            subghz_protocol_decoder_base_serialize(decoder_base, item->flipper_string, preset);
-            return WSHistoryStateAddKeyUpdateData;
-        }
+        slot = (slot + 1) & (WS_HISTORY_INDEX_SIZE - 1);
     }
-
-    // or add new record
-    if(!sensor_found) { //-V547
-        WSHistoryItem* item = WSHistoryItemArray_push_raw(instance->history->data);
-        item->preset = malloc(sizeof(SubGhzRadioPreset));
-        item->type = decoder_base->protocol->type;
-        item->preset->frequency = preset->frequency;
-        item->preset->name = furi_string_alloc();
-        furi_string_set(item->preset->name, preset->name);
-        item->preset->data = preset->data;
-        item->preset->data_size = preset->data_size;
-        item->id = id;
-
-        item->item_str = furi_string_alloc();
-        item->flipper_string = flipper_format_string_alloc();
-        subghz_protocol_decoder_base_serialize(decoder_base, item->flipper_string, preset);
-
-        do {
-            if(!flipper_format_rewind(item->flipper_string)) {
-                FURI_LOG_E(TAG, "Rewind error");
-                break;
-            }
-            if(!flipper_format_read_string(
-                   item->flipper_string, "Protocol", instance->tmp_string)) {
-                FURI_LOG_E(TAG, "Missing Protocol");
-                break;
-            }
-
-            if(!flipper_format_rewind(item->flipper_string)) {
-                FURI_LOG_E(TAG, "Rewind error");
-                break;
-            }
-            uint8_t key_data[sizeof(uint64_t)] = {0};
-            if(!flipper_format_read_hex(item->flipper_string, "Data", key_data, sizeof(uint64_t))) {
-                FURI_LOG_E(TAG, "Missing Data");
-                break;
-            }
-            uint64_t data = 0;
-            for(uint8_t i = 0; i < sizeof(uint64_t); i++) {
-                data = (data << 8) | key_data[i];
-            }
-            uint32_t temp_data = 0;
-            if(!flipper_format_read_uint32(item->flipper_string, "Ch", (uint32_t*)&temp_data, 1)) {
-                FURI_LOG_E(TAG, "Missing Channel");
-                break;
-            }
-            if(temp_data != WS_NO_CHANNEL) {
-                furi_string_cat_printf(instance->tmp_string, " Ch:%X", (uint8_t)temp_data);
-            }
-
-            furi_string_printf(
-                item->item_str, "%s %llX", furi_string_get_cstr(instance->tmp_string), data);
-
-        } while(false);
-        instance->last_index_write++;
-        return WSHistoryStateAddKeyNewDada;
+    if(state == WSHistoryStateAddKeyNewDada) {
+        instance->index[slot] = instance->last_index_write++;
     }
-    return WSHistoryStateAddKeyUnknown;
+
+    WSHistoryRecord* record = &instance->records[instance->index[slot]];
+    record->data = generic->data;
+    record->id = generic->id;
+    record->frequency = preset->frequency;
+    record->timestamp = furi_hal_rtc_get_timestamp();
+    record->temp = generic->temp;
+    record->protocol = protocol;
+    record->preset = ws_history_find_preset(instance, preset);
+    record->data_count_bit = generic->data_count_bit;
+    record->battery_low = generic->battery_low;
+    record->humidity = generic->humidity;
+    record->channel = generic->channel;
+    record->btn = generic->btn;
+    return state;
 }
@@ -104,9 +104,12 @@ WSHistoryStateAddKey
     ws_history_add_to_history(WSHistory* instance, void* context, SubGhzRadioPreset* preset);
 
 /** Get SubGhzProtocolCommonLoad to load into the protocol decoder bin data
+ * 
+ * The record is serialized on every call into a FlipperFormat owned by the history,
+ * it stays valid until the next call or ws_history_reset
  * 
  * @param instance  - WSHistory instance
  * @param idx       - record index
- * @return SubGhzProtocolCommonLoad*
+ * @return SubGhzProtocolCommonLoad*, NULL if the record can't be serialized
  */
 FlipperFormat* ws_history_get_raw_data(WSHistory* instance, uint16_t idx);